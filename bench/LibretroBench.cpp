@@ -0,0 +1,305 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*!
+ * \brief Headless benchmark for the libretro wrapper
+ *
+ * Loads a libretro core through CLibretroDLL, wires it to the same
+ * CLibretroEnvironment and CFrontendBridge used by the add-on, and runs a
+ * number of frames as fast as possible. The Kodi helpers are replaced by the
+ * stubs in bench/stub, so the measured time is the core plus the add-on's own
+ * overhead.
+ */
+
+#include "input/ButtonMapper.h"
+#include "input/InputManager.h"
+#include "libretro/ClientBridge.h"
+#include "libretro/libretro.h"
+#include "libretro/LibretroDLL.h"
+#include "libretro/LibretroEnvironment.h"
+#include "log/Log.h"
+#include "GameInfoLoader.h"
+
+#include "libXBMC_addon.h"
+#include "libKODI_game.h"
+
+#include <algorithm>
+#include <chrono>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+using namespace ADDON;
+using namespace LIBRETRO;
+
+#define DEFAULT_FRAME_COUNT    10000
+#define DEFAULT_WARMUP_COUNT   60
+#define DEFAULT_PROFILE_DIR    "bench-profile"
+#define DEFAULT_CONTROLLER_ID  "game.controller.default"
+
+namespace
+{
+  struct BenchOptions
+  {
+    BenchOptions() : frameCount(DEFAULT_FRAME_COUNT), warmupCount(DEFAULT_WARMUP_COUNT), bVerbose(false) { }
+
+    std::string                                      corePath;
+    std::string                                      contentPath;
+    std::string                                      systemDir;
+    std::string                                      profileDir;
+    unsigned int                                     frameCount;
+    unsigned int                                     warmupCount;
+    bool                                             bVerbose;
+    std::vector<std::pair<std::string, std::string>> settings;
+  };
+
+  void PrintUsage(const char* program)
+  {
+    fprintf(stderr, "Usage: %s [options] <core> [<content>]\n", program);
+    fprintf(stderr, "\n");
+    fprintf(stderr, "Options:\n");
+    fprintf(stderr, "  -n, --frames <count>     Number of measured frames (default: %d)\n", DEFAULT_FRAME_COUNT);
+    fprintf(stderr, "  -w, --warmup <count>     Number of frames run before measuring (default: %d)\n", DEFAULT_WARMUP_COUNT);
+    fprintf(stderr, "  -s, --set <key>=<value>  Set a core option\n");
+    fprintf(stderr, "      --system <dir>       Resource directory containing system/ (default: profile dir)\n");
+    fprintf(stderr, "      --profile <dir>      Profile directory (default: %s)\n", DEFAULT_PROFILE_DIR);
+    fprintf(stderr, "  -v, --verbose            Show debug logging\n");
+  }
+
+  bool ParseOptions(int argc, char** argv, BenchOptions& options)
+  {
+    std::vector<std::string> positional;
+
+    for (int i = 1; i < argc; i++)
+    {
+      const std::string arg = argv[i];
+      const bool bHasValue = (i + 1 < argc);
+
+      if ((arg == "-n" || arg == "--frames") && bHasValue)
+        options.frameCount = strtoul(argv[++i], nullptr, 10);
+      else if ((arg == "-w" || arg == "--warmup") && bHasValue)
+        options.warmupCount = strtoul(argv[++i], nullptr, 10);
+      else if ((arg == "-s" || arg == "--set") && bHasValue)
+      {
+        const std::string setting = argv[++i];
+        const size_t pos = setting.find('=');
+        if (pos == std::string::npos)
+        {
+          fprintf(stderr, "Invalid setting: %s\n", setting.c_str());
+          return false;
+        }
+        options.settings.push_back(std::make_pair(setting.substr(0, pos), setting.substr(pos + 1)));
+      }
+      else if (arg == "--system" && bHasValue)
+        options.systemDir = argv[++i];
+      else if (arg == "--profile" && bHasValue)
+        options.profileDir = argv[++i];
+      else if (arg == "-v" || arg == "--verbose")
+        options.bVerbose = true;
+      else if (!arg.empty() && arg[0] == '-')
+        return false;
+      else
+        positional.push_back(arg);
+    }
+
+    if (positional.empty() || positional.size() > 2 || options.frameCount == 0)
+      return false;
+
+    options.corePath = positional[0];
+    if (positional.size() > 1)
+      options.contentPath = positional[1];
+
+    if (options.profileDir.empty())
+      options.profileDir = DEFAULT_PROFILE_DIR;
+
+    if (options.systemDir.empty())
+      options.systemDir = options.profileDir;
+
+    return true;
+  }
+
+  double Percentile(const std::vector<uint64_t>& sortedNs, double percentile)
+  {
+    if (sortedNs.empty())
+      return 0.0;
+
+    size_t index = static_cast<size_t>(percentile / 100.0 * (sortedNs.size() - 1) + 0.5);
+    return sortedNs[std::min(index, sortedNs.size() - 1)] / 1000.0;
+  }
+}
+
+int main(int argc, char** argv)
+{
+  BenchOptions options;
+  if (!ParseOptions(argc, argv, options))
+  {
+    PrintUsage(argv[0]);
+    return 1;
+  }
+
+  CLog::Get().SetLevel(options.bVerbose ? SYS_LOG_DEBUG : SYS_LOG_ERROR);
+
+  CHelper_libXBMC_addon xbmc;
+  CHelper_libKODI_game frontend;
+
+  xbmc.SetVerbose(options.bVerbose);
+  for (const auto& setting : options.settings)
+    xbmc.Settings()[setting.first] = setting.second;
+
+  xbmc.CreateDirectory(options.profileDir.c_str());
+
+  const char* resourceDirectories[] = { options.systemDir.c_str() };
+
+  AddonProps_Game props = { };
+  props.game_client_dll_path     = options.corePath.c_str();
+  props.resource_directories     = resourceDirectories;
+  props.resource_directory_count = 1;
+  props.profile_directory        = options.profileDir.c_str();
+
+  CLibretroDLL client;
+  if (!client.Load(&props))
+  {
+    fprintf(stderr, "Failed to load %s\n", options.corePath.c_str());
+    return 1;
+  }
+
+  unsigned int version = client.retro_api_version();
+  if (version != 1)
+  {
+    fprintf(stderr, "Expected libretro api v1, found version %u\n", version);
+    return 1;
+  }
+
+  // Environment must be initialized before calling retro_init()
+  CClientBridge clientBridge;
+  CLibretroEnvironment::Get().Initialize(&xbmc, &frontend, &client, &clientBridge, &props);
+
+  CButtonMapper::Get().LoadButtonMap();
+
+  client.retro_init();
+
+  retro_system_info systemInfo = { };
+  client.retro_get_system_info(&systemInfo);
+
+  bool bLoaded = false;
+
+  if (options.contentPath.empty())
+  {
+    bLoaded = client.retro_load_game(nullptr);
+  }
+  else
+  {
+    CGameInfoLoader loader(options.contentPath.c_str(), &xbmc, !systemInfo.need_fullpath, !systemInfo.block_extract);
+
+    retro_game_info gameInfo;
+    if (loader.Load())
+    {
+      loader.GetMemoryStruct(gameInfo);
+      bLoaded = client.retro_load_game(&gameInfo);
+    }
+
+    if (!bLoaded)
+    {
+      loader.GetPathStruct(gameInfo);
+      bLoaded = client.retro_load_game(&gameInfo);
+    }
+  }
+
+  if (!bLoaded)
+  {
+    fprintf(stderr, "Core failed to load %s\n", options.contentPath.empty() ? "without content" : options.contentPath.c_str());
+    client.retro_deinit();
+    CLibretroEnvironment::Get().Deinitialize();
+    return 1;
+  }
+
+  retro_system_av_info avInfo = { };
+  client.retro_get_system_av_info(&avInfo);
+
+  game_system_av_info info = { };
+  info.geometry.base_width   = avInfo.geometry.base_width;
+  info.geometry.base_height  = avInfo.geometry.base_height;
+  info.geometry.max_width    = avInfo.geometry.max_width;
+  info.geometry.max_height   = avInfo.geometry.max_height;
+  info.geometry.aspect_ratio = avInfo.geometry.aspect_ratio;
+  info.timing.fps            = avInfo.timing.fps;
+  info.timing.sample_rate    = avInfo.timing.sample_rate;
+  CLibretroEnvironment::Get().UpdateSystemInfo(info);
+
+  // Connect the default controller so that input polling goes through the
+  // same lookups as in Kodi
+  game_controller controller = { };
+  controller.controller_id = DEFAULT_CONTROLLER_ID;
+  CInputManager::Get().OpenPort(0);
+  CInputManager::Get().DeviceConnected(0, true, &controller);
+  client.retro_set_controller_port_device(0, CInputManager::Get().GetDevice(0));
+
+  for (unsigned int i = 0; i < options.warmupCount; i++)
+    client.retro_run();
+
+  frontend.ResetStats();
+
+  std::vector<uint64_t> frameTimesNs;
+  frameTimesNs.reserve(options.frameCount);
+
+  const auto benchStart = std::chrono::steady_clock::now();
+
+  for (unsigned int i = 0; i < options.frameCount; i++)
+  {
+    const auto frameStart = std::chrono::steady_clock::now();
+
+    client.retro_run();
+
+    const auto frameEnd = std::chrono::steady_clock::now();
+    frameTimesNs.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(frameEnd - frameStart).count());
+  }
+
+  const auto benchEnd = std::chrono::steady_clock::now();
+  const double totalSeconds = std::chrono::duration<double>(benchEnd - benchStart).count();
+
+  std::sort(frameTimesNs.begin(), frameTimesNs.end());
+
+  const CHelper_libKODI_game::Stats& stats = frontend.GetStats();
+
+  printf("Core:         %s %s\n", systemInfo.library_name ? systemInfo.library_name : "",
+                                  systemInfo.library_version ? systemInfo.library_version : "");
+  printf("Content:      %s\n", options.contentPath.empty() ? "(none)" : options.contentPath.c_str());
+  printf("Frames:       %u (+%u warmup)\n", options.frameCount, options.warmupCount);
+  printf("Total time:   %.3f s\n", totalSeconds);
+  printf("Frames/sec:   %.1f (core reports %.2f fps)\n", options.frameCount / totalSeconds, avInfo.timing.fps);
+  printf("retro_run():  p50 %.1f us, p99 %.1f us, max %.1f us\n",
+         Percentile(frameTimesNs, 50.0), Percentile(frameTimesNs, 99.0), frameTimesNs.back() / 1000.0);
+  printf("Video:        %llu frames, %llu bytes, %llu hw frames\n",
+         (unsigned long long)stats.videoFrames, (unsigned long long)stats.videoBytes, (unsigned long long)stats.hwFrames);
+  printf("Audio:        %llu packets, %llu bytes\n",
+         (unsigned long long)stats.audioPackets, (unsigned long long)stats.audioBytes);
+  printf("Stream opens: %llu\n", (unsigned long long)stats.streamOpens);
+
+  client.retro_unload_game();
+  CInputManager::Get().ClosePorts();
+  client.retro_deinit();
+
+  CLibretroEnvironment::Get().Deinitialize();
+
+  return 0;
+}
@@ -0,0 +1,211 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*!
+ * \brief Stress benchmark for relative pointer accumulation
+ *
+ * A writer thread adds motion as fast as it can (or at a given rate), like a
+ * high polling rate mouse, while a reader thread takes the accumulated motion
+ * like the emulation thread polling for input. This is run for the packed
+ * atomic used by CLibretroDeviceInput and for the mutex-protected X and Y
+ * counters it replaced.
+ *
+ * Every event moves X and Y by the same amount, so a take where X and Y
+ * differ has split an event between two polls. The totals taken are checked
+ * against the totals added, so lost motion fails the benchmark.
+ */
+
+#include "utils/AtomicDelta.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <thread>
+
+using namespace LIBRETRO;
+
+#define DEFAULT_DURATION_MS  2000
+
+namespace
+{
+  /*!
+   * \brief The previous accumulator: X and Y behind a mutex, read and reset
+   *        one at a time
+   */
+  class CLockedDelta
+  {
+  public:
+    CLockedDelta(void) : m_x(0), m_y(0) { }
+
+    void Add(int32_t x, int32_t y)
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_x += x;
+      m_y += y;
+    }
+
+    void Take(int32_t& x, int32_t& y)
+    {
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        x = m_x;
+        m_x = 0;
+      }
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        y = m_y;
+        m_y = 0;
+      }
+    }
+
+  private:
+    std::mutex m_mutex;
+    int32_t    m_x;
+    int32_t    m_y;
+  };
+
+  struct Result
+  {
+    uint64_t events;
+    uint64_t takes;
+    uint64_t tornTakes;
+    uint64_t maxTakeNs;
+    int64_t  addedX;
+    int64_t  takenX;
+    int64_t  takenY;
+  };
+
+  template<typename T>
+  Result Run(unsigned int durationMs, unsigned int rate)
+  {
+    T delta;
+    std::atomic<bool> bStop(false);
+
+    Result result = { };
+
+    std::thread writer([&]()
+    {
+      const auto start = std::chrono::steady_clock::now();
+      uint64_t events = 0;
+      int64_t added = 0;
+
+      while (!bStop)
+      {
+        if (rate > 0)
+        {
+          const auto due = start + std::chrono::microseconds(events * 1000000 / rate);
+          while (std::chrono::steady_clock::now() < due && !bStop) { }
+        }
+
+        // Alternate directions to keep the counters small
+        const int32_t step = (events & 1) ? -3 : 5;
+        delta.Add(step, step);
+        added += step;
+        events++;
+      }
+
+      result.events = events;
+      result.addedX = added;
+    });
+
+    const auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(durationMs);
+    while (std::chrono::steady_clock::now() < end)
+    {
+      const auto before = std::chrono::steady_clock::now();
+
+      int32_t x;
+      int32_t y;
+      delta.Take(x, y);
+
+      const uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - before).count();
+      if (ns > result.maxTakeNs)
+        result.maxTakeNs = ns;
+
+      if (x != y)
+        result.tornTakes++;
+
+      result.takenX += x;
+      result.takenY += y;
+      result.takes++;
+    }
+
+    bStop = true;
+    writer.join();
+
+    // Motion added after the last take
+    int32_t x;
+    int32_t y;
+    delta.Take(x, y);
+    result.takenX += x;
+    result.takenY += y;
+
+    return result;
+  }
+
+  bool Report(const char* label, const Result& result, unsigned int durationMs)
+  {
+    const double seconds = durationMs / 1000.0;
+
+    printf("%-8s events %7.2f M/s   takes %7.2f M/s   torn %9llu   max take %8.1f us\n", label,
+           result.events / seconds / 1e6, result.takes / seconds / 1e6,
+           static_cast<unsigned long long>(result.tornTakes), result.maxTakeNs / 1000.0);
+
+    if (result.takenX != result.addedX || result.takenY != result.addedX)
+    {
+      fprintf(stderr, "%s: Motion lost, added %lld, taken %lld/%lld\n", label,
+              static_cast<long long>(result.addedX), static_cast<long long>(result.takenX), static_cast<long long>(result.takenY));
+      return false;
+    }
+
+    return true;
+  }
+}
+
+int main(int argc, char** argv)
+{
+  unsigned int durationMs = DEFAULT_DURATION_MS;
+  unsigned int rate = 0;
+
+  if (argc > 1)
+    durationMs = strtoul(argv[1], nullptr, 10);
+  if (argc > 2)
+    rate = strtoul(argv[2], nullptr, 10);
+
+  if (durationMs == 0)
+  {
+    fprintf(stderr, "Usage: %s [<duration ms> [<events per second, 0 for unthrottled>]]\n", argv[0]);
+    return 1;
+  }
+
+  if (rate > 0)
+    printf("Duration:    %u ms at %u events/s\n", durationMs, rate);
+  else
+    printf("Duration:    %u ms, unthrottled\n", durationMs);
+
+  bool bSuccess = true;
+  bSuccess &= Report("Mutex", Run<CLockedDelta>(durationMs, rate), durationMs);
+  bSuccess &= Report("Atomic", Run<CAtomicDelta>(durationMs, rate), durationMs);
+
+  // Torn takes of the mutex are expected, that's what is being replaced
+  return bSuccess ? 0 : 1;
+}
@@ -0,0 +1,198 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*!
+ * \brief Microbenchmark for the string lookups of the input translators
+ *
+ * Runs every name of the translator tables, plus names that aren't mapped,
+ * through the table lookups and through the chains of string compares they
+ * replaced, and reports lookups per second for both. The results of both are
+ * compared, so the benchmark also fails if the tables drift from the chains.
+ */
+
+#include "input/DefaultControllerDefines.h"
+#include "input/DefaultControllerTranslator.h"
+#include "libretro/LibretroTranslator.h"
+#include "libretro/libretro.h"
+
+#include <chrono>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+using namespace LIBRETRO;
+
+#define DEFAULT_ITERATIONS  2000000
+
+namespace
+{
+  // --- Chains of compares replaced by the tables ----------------------------
+
+  int LegacyDefaultIndex(const std::string &strFeatureName)
+  {
+    if (strFeatureName == DEFAULT_CONTROLLER_FEATURE_A)             return RETRO_DEVICE_ID_JOYPAD_A;
+    if (strFeatureName == DEFAULT_CONTROLLER_FEATURE_B)             return RETRO_DEVICE_ID_JOYPAD_B;
+    if (strFeatureName == DEFAULT_CONTROLLER_FEATURE_X)             return RETRO_DEVICE_ID_JOYPAD_X;
+    if (strFeatureName == DEFAULT_CONTROLLER_FEATURE_Y)             return RETRO_DEVICE_ID_JOYPAD_Y;
+    if (strFeatureName == DEFAULT_CONTROLLER_FEATURE_START)         return RETRO_DEVICE_ID_JOYPAD_START;
+    if (strFeatureName == DEFAULT_CONTROLLER_FEATURE_BACK)          return RETRO_DEVICE_ID_JOYPAD_SELECT;
+    if (strFeatureName == DEFAULT_CONTROLLER_FEATURE_LEFT_BUMPER)   return RETRO_DEVICE_ID_JOYPAD_L;
+    if (strFeatureName == DEFAULT_CONTROLLER_FEATURE_RIGHT_BUMPER)  return RETRO_DEVICE_ID_JOYPAD_R;
+    if (strFeatureName == DEFAULT_CONTROLLER_FEATURE_LEFT_THUMB)    return RETRO_DEVICE_ID_JOYPAD_L3;
+    if (strFeatureName == DEFAULT_CONTROLLER_FEATURE_RIGHT_THUMB)   return RETRO_DEVICE_ID_JOYPAD_R3;
+    if (strFeatureName == DEFAULT_CONTROLLER_FEATURE_UP)            return RETRO_DEVICE_ID_JOYPAD_UP;
+    if (strFeatureName == DEFAULT_CONTROLLER_FEATURE_DOWN)          return RETRO_DEVICE_ID_JOYPAD_DOWN;
+    if (strFeatureName == DEFAULT_CONTROLLER_FEATURE_RIGHT)         return RETRO_DEVICE_ID_JOYPAD_RIGHT;
+    if (strFeatureName == DEFAULT_CONTROLLER_FEATURE_LEFT)          return RETRO_DEVICE_ID_JOYPAD_LEFT;
+    if (strFeatureName == DEFAULT_CONTROLLER_FEATURE_LEFT_TRIGGER)  return RETRO_DEVICE_ID_JOYPAD_L2;
+    if (strFeatureName == DEFAULT_CONTROLLER_FEATURE_RIGHT_TRIGGER) return RETRO_DEVICE_ID_JOYPAD_R2;
+    if (strFeatureName == DEFAULT_CONTROLLER_FEATURE_LEFT_STICK)    return RETRO_DEVICE_INDEX_ANALOG_LEFT;
+    if (strFeatureName == DEFAULT_CONTROLLER_FEATURE_RIGHT_STICK)   return RETRO_DEVICE_INDEX_ANALOG_RIGHT;
+    if (strFeatureName == DEFAULT_CONTROLLER_FEATURE_LEFT_MOTOR)    return RETRO_RUMBLE_STRONG;
+    if (strFeatureName == DEFAULT_CONTROLLER_FEATURE_RIGHT_MOTOR)   return RETRO_RUMBLE_WEAK;
+
+    return -1;
+  }
+
+  int LegacyFeatureIndex(const std::string& strLibretroFeature)
+  {
+    if (strLibretroFeature == "RETRO_DEVICE_ID_JOYPAD_A")              return RETRO_DEVICE_ID_JOYPAD_A;
+    if (strLibretroFeature == "RETRO_DEVICE_ID_JOYPAD_B")              return RETRO_DEVICE_ID_JOYPAD_B;
+    if (strLibretroFeature == "RETRO_DEVICE_ID_JOYPAD_X")              return RETRO_DEVICE_ID_JOYPAD_X;
+    if (strLibretroFeature == "RETRO_DEVICE_ID_JOYPAD_Y")              return RETRO_DEVICE_ID_JOYPAD_Y;
+    if (strLibretroFeature == "RETRO_DEVICE_ID_JOYPAD_START")          return RETRO_DEVICE_ID_JOYPAD_START;
+    if (strLibretroFeature == "RETRO_DEVICE_ID_JOYPAD_SELECT")         return RETRO_DEVICE_ID_JOYPAD_SELECT;
+    if (strLibretroFeature == "RETRO_DEVICE_ID_JOYPAD_UP")             return RETRO_DEVICE_ID_JOYPAD_UP;
+    if (strLibretroFeature == "RETRO_DEVICE_ID_JOYPAD_DOWN")           return RETRO_DEVICE_ID_JOYPAD_DOWN;
+    if (strLibretroFeature == "RETRO_DEVICE_ID_JOYPAD_RIGHT")          return RETRO_DEVICE_ID_JOYPAD_RIGHT;
+    if (strLibretroFeature == "RETRO_DEVICE_ID_JOYPAD_LEFT")           return RETRO_DEVICE_ID_JOYPAD_LEFT;
+    if (strLibretroFeature == "RETRO_DEVICE_ID_JOYPAD_L")              return RETRO_DEVICE_ID_JOYPAD_L;
+    if (strLibretroFeature == "RETRO_DEVICE_ID_JOYPAD_R")              return RETRO_DEVICE_ID_JOYPAD_R;
+    if (strLibretroFeature == "RETRO_DEVICE_ID_JOYPAD_L2")             return RETRO_DEVICE_ID_JOYPAD_L2;
+    if (strLibretroFeature == "RETRO_DEVICE_ID_JOYPAD_R2")             return RETRO_DEVICE_ID_JOYPAD_R2;
+    if (strLibretroFeature == "RETRO_DEVICE_ID_JOYPAD_L3")             return RETRO_DEVICE_ID_JOYPAD_L3;
+    if (strLibretroFeature == "RETRO_DEVICE_ID_JOYPAD_R3")             return RETRO_DEVICE_ID_JOYPAD_R3;
+    if (strLibretroFeature == "RETRO_DEVICE_INDEX_ANALOG_LEFT")        return RETRO_DEVICE_INDEX_ANALOG_LEFT;
+    if (strLibretroFeature == "RETRO_DEVICE_INDEX_ANALOG_RIGHT")       return RETRO_DEVICE_INDEX_ANALOG_RIGHT;
+    if (strLibretroFeature == "RETRO_DEVICE_MOUSE")                    return 0;
+    if (strLibretroFeature == "RETRO_DEVICE_ID_MOUSE_LEFT")            return RETRO_DEVICE_ID_MOUSE_LEFT;
+    if (strLibretroFeature == "RETRO_DEVICE_ID_MOUSE_RIGHT")           return RETRO_DEVICE_ID_MOUSE_RIGHT;
+    if (strLibretroFeature == "RETRO_DEVICE_ID_MOUSE_WHEELUP")         return RETRO_DEVICE_ID_MOUSE_WHEELUP;
+    if (strLibretroFeature == "RETRO_DEVICE_ID_MOUSE_WHEELDOWN")       return RETRO_DEVICE_ID_MOUSE_WHEELDOWN;
+    if (strLibretroFeature == "RETRO_DEVICE_ID_MOUSE_MIDDLE")          return RETRO_DEVICE_ID_MOUSE_MIDDLE;
+    if (strLibretroFeature == "RETRO_DEVICE_ID_MOUSE_HORIZ_WHEELUP")   return RETRO_DEVICE_ID_MOUSE_HORIZ_WHEELUP;
+    if (strLibretroFeature == "RETRO_DEVICE_ID_MOUSE_HORIZ_WHEELDOWN") return RETRO_DEVICE_ID_MOUSE_HORIZ_WHEELDOWN;
+    if (strLibretroFeature == "RETRO_DEVICE_LIGHTGUN")                 return 0;
+    if (strLibretroFeature == "RETRO_DEVICE_ID_LIGHTGUN_TRIGGER")      return RETRO_DEVICE_ID_LIGHTGUN_TRIGGER;
+    if (strLibretroFeature == "RETRO_DEVICE_ID_LIGHTGUN_CURSOR")       return RETRO_DEVICE_ID_LIGHTGUN_CURSOR;
+    if (strLibretroFeature == "RETRO_DEVICE_ID_LIGHTGUN_TURBO")        return RETRO_DEVICE_ID_LIGHTGUN_TURBO;
+    if (strLibretroFeature == "RETRO_DEVICE_ID_LIGHTGUN_PAUSE")        return RETRO_DEVICE_ID_LIGHTGUN_PAUSE;
+    if (strLibretroFeature == "RETRO_DEVICE_ID_LIGHTGUN_START")         return RETRO_DEVICE_ID_LIGHTGUN_START;
+    if (strLibretroFeature == "RETRO_RUMBLE_STRONG")                   return RETRO_RUMBLE_STRONG;
+    if (strLibretroFeature == "RETRO_RUMBLE_WEAK")                     return RETRO_RUMBLE_WEAK;
+
+    return -1;
+  }
+
+  typedef int (*LookupFunc)(const std::string&);
+
+  /*!
+   * \brief Run every name through a lookup and return lookups per second
+   */
+  double Measure(LookupFunc lookup, const std::vector<std::string>& names, unsigned int iterations, int64_t& checksum)
+  {
+    const auto start = std::chrono::steady_clock::now();
+
+    int64_t sum = 0;
+    for (unsigned int i = 0; i < iterations; i++)
+    {
+      for (const std::string& name : names)
+        sum += lookup(name);
+    }
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    checksum = sum;
+    return static_cast<double>(iterations) * names.size() / seconds;
+  }
+
+  bool Compare(const char* label, LookupFunc legacy, LookupFunc lookup, const std::vector<std::string>& names, unsigned int iterations)
+  {
+    for (const std::string& name : names)
+    {
+      if (legacy(name) != lookup(name))
+      {
+        fprintf(stderr, "%s: \"%s\" translated to %d, expected %d\n", label, name.c_str(), lookup(name), legacy(name));
+        return false;
+      }
+    }
+
+    int64_t legacySum;
+    int64_t lookupSum;
+    const double legacyRate = Measure(legacy, names, iterations, legacySum);
+    const double lookupRate = Measure(lookup, names, iterations, lookupSum);
+
+    printf("%-28s compares %7.1f M/s   table %7.1f M/s   %5.2fx\n", label,
+           legacyRate / 1e6, lookupRate / 1e6, lookupRate / legacyRate);
+
+    return legacySum == lookupSum;
+  }
+}
+
+int main(int argc, char** argv)
+{
+  unsigned int iterations = DEFAULT_ITERATIONS;
+  if (argc > 1)
+    iterations = strtoul(argv[1], nullptr, 10);
+
+  if (iterations == 0)
+  {
+    fprintf(stderr, "Usage: %s [<iterations>]\n", argv[0]);
+    return 1;
+  }
+
+  // Every mapped name once, plus names that fall through every compare
+  std::vector<std::string> defaultFeatures = CDefaultControllerTranslator::GetFeatureNames();
+  defaultFeatures.push_back("guide");
+  defaultFeatures.push_back("leftstickx");
+
+  std::vector<std::string> libretroFeatures;
+  for (unsigned int id = RETRO_DEVICE_ID_JOYPAD_B; id <= RETRO_DEVICE_ID_JOYPAD_R3; id++)
+    libretroFeatures.push_back(LibretroTranslator::GetFeatureName(RETRO_DEVICE_JOYPAD, 0, id));
+  for (const char* feature : { "RETRO_DEVICE_INDEX_ANALOG_LEFT", "RETRO_DEVICE_INDEX_ANALOG_RIGHT",
+                               "RETRO_DEVICE_MOUSE", "RETRO_DEVICE_ID_MOUSE_LEFT", "RETRO_DEVICE_ID_MOUSE_HORIZ_WHEELDOWN",
+                               "RETRO_DEVICE_LIGHTGUN", "RETRO_DEVICE_ID_LIGHTGUN_START",
+                               "RETRO_RUMBLE_STRONG", "RETRO_RUMBLE_WEAK",
+                               "RETRO_DEVICE_ID_POINTER_X", "RETRO_DEVICE_ID_JOYPAD_MASK" })
+  {
+    libretroFeatures.push_back(feature);
+  }
+
+  printf("Iterations:  %u over %u default controller and %u libretro feature names\n",
+         iterations, static_cast<unsigned int>(defaultFeatures.size()), static_cast<unsigned int>(libretroFeatures.size()));
+
+  bool bSuccess = true;
+  bSuccess &= Compare("Default controller features", LegacyDefaultIndex, CDefaultControllerTranslator::GetLibretroIndex, defaultFeatures, iterations);
+  bSuccess &= Compare("Libretro feature indices", LegacyFeatureIndex, LibretroTranslator::GetFeatureIndexV2, libretroFeatures, iterations);
+
+  return bSuccess ? 0 : 1;
+}
@@ -0,0 +1,103 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+/*!
+ * \brief Stand-in for Kodi's game helper used by the headless benchmark
+ *
+ * This header shadows Kodi's libKODI_game.h when building the benchmark
+ * target. Streams are accepted and discarded, and the amount of data pushed
+ * through them is counted so it can be reported alongside the timings.
+ */
+
+#include "kodi_game_types.h"
+
+#include <stdint.h>
+
+class CHelper_libKODI_game
+{
+public:
+  struct Stats
+  {
+    uint64_t videoFrames;
+    uint64_t videoBytes;
+    uint64_t audioPackets;
+    uint64_t audioBytes;
+    uint64_t hwFrames;
+    uint64_t streamOpens;
+  };
+
+  CHelper_libKODI_game() : m_stats() { }
+
+  bool RegisterMe(void* handle) { return true; }
+
+  const Stats& GetStats() const { return m_stats; }
+  void ResetStats() { m_stats = Stats(); }
+
+  void CloseGame(void) { }
+
+  bool OpenPixelStream(GAME_PIXEL_FORMAT format, unsigned int width, unsigned int height, GAME_VIDEO_ROTATION rotation)
+  {
+    m_stats.streamOpens++;
+    return format != GAME_PIXEL_FORMAT_UNKNOWN;
+  }
+
+  bool OpenPCMStream(GAME_PCM_FORMAT format, const GAME_AUDIO_CHANNEL* channel_map)
+  {
+    m_stats.streamOpens++;
+    return true;
+  }
+
+  void AddStreamData(GAME_STREAM_TYPE stream, const uint8_t* data, unsigned int size)
+  {
+    switch (stream)
+    {
+    case GAME_STREAM_VIDEO:
+      m_stats.videoFrames++;
+      m_stats.videoBytes += size;
+      break;
+    case GAME_STREAM_AUDIO:
+      m_stats.audioPackets++;
+      m_stats.audioBytes += size;
+      break;
+    default:
+      break;
+    }
+  }
+
+  void CloseStream(GAME_STREAM_TYPE stream) { }
+
+  void EnableHardwareRendering(const game_hw_info* params) { }
+
+  uintptr_t HwGetCurrentFramebuffer(void) { return 0; }
+
+  game_proc_address_t HwGetProcAddress(const char* sym) { return nullptr; }
+
+  void RenderFrame() { m_stats.hwFrames++; }
+
+  bool OpenPort(unsigned int port) { return true; }
+
+  void ClosePort(unsigned int port) { }
+
+  bool InputEvent(const game_input_event& event) { return true; }
+
+private:
+  Stats m_stats;
+};
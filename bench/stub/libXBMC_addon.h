@@ -0,0 +1,202 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+/*!
+ * \brief Stand-in for Kodi's add-on helper used by the headless benchmark
+ *
+ * This header shadows Kodi's libXBMC_addon.h when building the benchmark
+ * target. Instead of forwarding to Kodi, file access goes to the local
+ * filesystem, settings are served from a table filled on the command line and
+ * logging goes to stderr.
+ */
+
+#include <map>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#ifdef _WIN32
+  #include <direct.h>
+#else
+  #include <unistd.h>
+  #define __stat64 stat64
+#endif
+
+namespace ADDON
+{
+  typedef enum addon_log
+  {
+    LOG_DEBUG,
+    LOG_INFO,
+    LOG_NOTICE,
+    LOG_ERROR
+  } addon_log_t;
+
+  typedef enum queue_msg
+  {
+    QUEUE_INFO,
+    QUEUE_WARNING,
+    QUEUE_ERROR
+  } queue_msg_t;
+
+  class CHelper_libXBMC_addon
+  {
+  public:
+    CHelper_libXBMC_addon() : m_bVerbose(false) { }
+
+    bool RegisterMe(void* handle) { return true; }
+
+    void SetVerbose(bool bVerbose) { m_bVerbose = bVerbose; }
+
+    /*!
+     * \brief Values returned by GetSetting(), keyed by setting ID
+     */
+    std::map<std::string, std::string>& Settings() { return m_settings; }
+
+    void Log(const addon_log_t loglevel, const char* format, ...)
+    {
+      if (!m_bVerbose && loglevel != LOG_ERROR)
+        return;
+
+      va_list args;
+      va_start(args, format);
+      vfprintf(stderr, format, args);
+      va_end(args);
+      fputc('\n', stderr);
+    }
+
+    bool GetSetting(const char* settingName, void* settingValue)
+    {
+      auto it = m_settings.find(settingName);
+      if (it == m_settings.end())
+        return false;
+
+      // Libretro settings are strings, the caller provides a 1024 byte buffer
+      strncpy(static_cast<char*>(settingValue), it->second.c_str(), 1023);
+      return true;
+    }
+
+    void QueueNotification(const queue_msg_t type, const char* format, ...)
+    {
+      va_list args;
+      va_start(args, format);
+      vfprintf(stderr, format, args);
+      va_end(args);
+      fputc('\n', stderr);
+    }
+
+    void* OpenFile(const char* strFileName, unsigned int flags)
+    {
+      return fopen(strFileName, "rb");
+    }
+
+    void* OpenFileForWrite(const char* strFileName, bool bOverWrite)
+    {
+      return fopen(strFileName, bOverWrite ? "wb" : "ab");
+    }
+
+    ssize_t ReadFile(void* file, void* lpBuf, size_t uiBufSize)
+    {
+      return fread(lpBuf, 1, uiBufSize, static_cast<FILE*>(file));
+    }
+
+    ssize_t WriteFile(void* file, const void* lpBuf, size_t uiBufSize)
+    {
+      return fwrite(lpBuf, 1, uiBufSize, static_cast<FILE*>(file));
+    }
+
+    void FlushFile(void* file)
+    {
+      fflush(static_cast<FILE*>(file));
+    }
+
+    int64_t SeekFile(void* file, int64_t iFilePosition, int iWhence)
+    {
+      if (fseeko(static_cast<FILE*>(file), iFilePosition, iWhence) != 0)
+        return -1;
+      return ftello(static_cast<FILE*>(file));
+    }
+
+    int64_t GetFilePosition(void* file)
+    {
+      return ftello(static_cast<FILE*>(file));
+    }
+
+    int64_t GetFileLength(void* file)
+    {
+      struct stat statStruct = { };
+      if (fstat(fileno(static_cast<FILE*>(file)), &statStruct) != 0)
+        return -1;
+      return statStruct.st_size;
+    }
+
+    void CloseFile(void* file)
+    {
+      fclose(static_cast<FILE*>(file));
+    }
+
+    int GetFileChunkSize(void* file) { return 0; }
+
+    bool FileExists(const char* strFileName, bool bUseCache)
+    {
+      struct stat statStruct = { };
+      return stat(strFileName, &statStruct) == 0;
+    }
+
+    int StatFile(const char* strFileName, struct __stat64* buffer)
+    {
+      return stat64(strFileName, buffer);
+    }
+
+    bool DeleteFile(const char* strFileName)
+    {
+      return remove(strFileName) == 0;
+    }
+
+    bool CreateDirectory(const char* strPath)
+    {
+#ifdef _WIN32
+      return _mkdir(strPath) == 0;
+#else
+      return mkdir(strPath, 0755) == 0;
+#endif
+    }
+
+    bool DirectoryExists(const char* strPath)
+    {
+      struct stat statStruct = { };
+      return stat(strPath, &statStruct) == 0 && S_ISDIR(statStruct.st_mode);
+    }
+
+    bool RemoveDirectory(const char* strPath)
+    {
+      return rmdir(strPath) == 0;
+    }
+
+  private:
+    bool                               m_bVerbose;
+    std::map<std::string, std::string> m_settings;
+  };
+}
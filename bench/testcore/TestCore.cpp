@@ -0,0 +1,349 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*!
+ * \brief Synthetic libretro core for reproducible benchmarks
+ *
+ * The core doesn't emulate anything. Each frame it draws a moving pattern at
+ * the configured size and pixel format, emits one frame's worth of audio
+ * through the configured audio callback and polls input a configurable number
+ * of times. This gives a known, content-free load on the add-on's video,
+ * audio and input paths.
+ *
+ * Everything is configured through core options, which the benchmark can set
+ * with --set, e.g. --set testcore_resolution=1920x1080.
+ */
+
+#include "libretro/libretro.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#define TESTCORE_NAME          "Test Core"
+#define TESTCORE_VERSION       "1.0.0"
+#define TESTCORE_FPS           60.0
+#define TESTCORE_SAMPLE_RATE   48000.0
+#define TESTCORE_PORT_COUNT    4
+#define TESTCORE_BUTTON_COUNT  16
+
+namespace
+{
+  enum AUDIO_MODE
+  {
+    AUDIO_MODE_BATCH,  // retro_audio_sample_batch_t
+    AUDIO_MODE_SINGLE, // retro_audio_sample_t
+    AUDIO_MODE_NONE,
+  };
+
+  retro_environment_t        environ_cb;
+  retro_video_refresh_t      video_cb;
+  retro_audio_sample_t       audio_cb;
+  retro_audio_sample_batch_t audio_batch_cb;
+  retro_input_poll_t         input_poll_cb;
+  retro_input_state_t        input_state_cb;
+
+  const retro_variable variables[] =
+  {
+    { "testcore_resolution",   "Frame size; 320x240|256x224|640x480|1280x720|1920x1080" },
+    { "testcore_pixel_format", "Pixel format; XRGB8888|RGB565|0RGB1555" },
+    { "testcore_audio",        "Audio callback; batch|single|none" },
+    { "testcore_input_polls",  "Input polls per frame; 16|0|1|64|256|1024" },
+    { "testcore_state_size",   "Save state size (KB); 64|0|16|256|1024|4096" },
+    { nullptr, nullptr },
+  };
+
+  unsigned int         width = 320;
+  unsigned int         height = 240;
+  retro_pixel_format   pixelFormat = RETRO_PIXEL_FORMAT_XRGB8888;
+  unsigned int         bytesPerPixel = 4;
+  AUDIO_MODE           audioMode = AUDIO_MODE_BATCH;
+  unsigned int         inputPolls = 16;
+  std::vector<uint8_t> frame;
+  std::vector<int16_t> audio;
+  std::vector<uint8_t> state; // Bytes 0-7 hold the frame counter
+  uint64_t             frameCount = 0;
+  int64_t              inputAccumulator = 0;
+
+  const char* GetVariable(const char* key)
+  {
+    retro_variable variable = { key, nullptr };
+    if (environ_cb && environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &variable))
+      return variable.value;
+    return nullptr;
+  }
+
+  void ReadVariables()
+  {
+    const char* value;
+
+    if ((value = GetVariable("testcore_resolution")) != nullptr)
+    {
+      unsigned int w, h;
+      if (sscanf(value, "%ux%u", &w, &h) == 2 && w > 0 && h > 0)
+      {
+        width = w;
+        height = h;
+      }
+    }
+
+    if ((value = GetVariable("testcore_pixel_format")) != nullptr)
+    {
+      const std::string strFormat = value;
+      if (strFormat == "RGB565")
+        pixelFormat = RETRO_PIXEL_FORMAT_RGB565;
+      else if (strFormat == "0RGB1555")
+        pixelFormat = RETRO_PIXEL_FORMAT_0RGB1555;
+      else
+        pixelFormat = RETRO_PIXEL_FORMAT_XRGB8888;
+    }
+    bytesPerPixel = (pixelFormat == RETRO_PIXEL_FORMAT_XRGB8888 ? 4 : 2);
+
+    if ((value = GetVariable("testcore_audio")) != nullptr)
+    {
+      const std::string strMode = value;
+      if (strMode == "single")
+        audioMode = AUDIO_MODE_SINGLE;
+      else if (strMode == "none")
+        audioMode = AUDIO_MODE_NONE;
+      else
+        audioMode = AUDIO_MODE_BATCH;
+    }
+
+    if ((value = GetVariable("testcore_input_polls")) != nullptr)
+      inputPolls = strtoul(value, nullptr, 10);
+
+    if ((value = GetVariable("testcore_state_size")) != nullptr)
+      state.assign(strtoul(value, nullptr, 10) * 1024, 0);
+  }
+
+  void RenderFrame()
+  {
+    const size_t pitch = width * bytesPerPixel;
+
+    // Scroll a gradient so every frame differs from the last
+    for (unsigned int y = 0; y < height; y++)
+    {
+      uint8_t* row = frame.data() + y * pitch;
+      const uint8_t value = static_cast<uint8_t>(y + frameCount);
+      memset(row, value, pitch);
+    }
+
+    video_cb(frame.data(), width, height, pitch);
+  }
+
+  void RenderAudio()
+  {
+    const size_t frames = audio.size() / 2;
+
+    // Square wave, not meant to be listened to
+    for (size_t i = 0; i < frames; i++)
+    {
+      const int16_t sample = ((frameCount * frames + i) / 64) % 2 ? 4096 : -4096;
+      audio[2 * i] = sample;
+      audio[2 * i + 1] = sample;
+    }
+
+    switch (audioMode)
+    {
+    case AUDIO_MODE_BATCH:
+      audio_batch_cb(audio.data(), frames);
+      break;
+    case AUDIO_MODE_SINGLE:
+      for (size_t i = 0; i < frames; i++)
+        audio_cb(audio[2 * i], audio[2 * i + 1]);
+      break;
+    case AUDIO_MODE_NONE:
+    default:
+      break;
+    }
+  }
+
+  void PollInput()
+  {
+    input_poll_cb();
+
+    for (unsigned int i = 0; i < inputPolls; i++)
+    {
+      const unsigned int port = (i / TESTCORE_BUTTON_COUNT) % TESTCORE_PORT_COUNT;
+      const unsigned int id = i % TESTCORE_BUTTON_COUNT;
+      inputAccumulator += input_state_cb(port, RETRO_DEVICE_JOYPAD, 0, id);
+    }
+  }
+}
+
+void retro_set_environment(retro_environment_t cb)
+{
+  environ_cb = cb;
+
+  bool bNoGame = true;
+  environ_cb(RETRO_ENVIRONMENT_SET_SUPPORT_NO_GAME, &bNoGame);
+  environ_cb(RETRO_ENVIRONMENT_SET_VARIABLES, const_cast<retro_variable*>(variables));
+}
+
+void retro_set_video_refresh(retro_video_refresh_t cb) { video_cb = cb; }
+void retro_set_audio_sample(retro_audio_sample_t cb) { audio_cb = cb; }
+void retro_set_audio_sample_batch(retro_audio_sample_batch_t cb) { audio_batch_cb = cb; }
+void retro_set_input_poll(retro_input_poll_t cb) { input_poll_cb = cb; }
+void retro_set_input_state(retro_input_state_t cb) { input_state_cb = cb; }
+
+void retro_init(void)
+{
+  frameCount = 0;
+  inputAccumulator = 0;
+}
+
+void retro_deinit(void)
+{
+  frame.clear();
+  audio.clear();
+  state.clear();
+}
+
+unsigned retro_api_version(void)
+{
+  return RETRO_API_VERSION;
+}
+
+void retro_get_system_info(retro_system_info* info)
+{
+  memset(info, 0, sizeof(*info));
+  info->library_name     = TESTCORE_NAME;
+  info->library_version  = TESTCORE_VERSION;
+  info->valid_extensions = "";
+  info->need_fullpath    = false;
+  info->block_extract    = false;
+}
+
+void retro_get_system_av_info(retro_system_av_info* info)
+{
+  info->geometry.base_width   = width;
+  info->geometry.base_height  = height;
+  info->geometry.max_width    = width;
+  info->geometry.max_height   = height;
+  info->geometry.aspect_ratio = static_cast<float>(width) / height;
+  info->timing.fps            = TESTCORE_FPS;
+  info->timing.sample_rate    = TESTCORE_SAMPLE_RATE;
+}
+
+void retro_set_controller_port_device(unsigned /* port */, unsigned /* device */)
+{
+}
+
+void retro_reset(void)
+{
+  frameCount = 0;
+}
+
+void retro_run(void)
+{
+  bool bUpdated = false;
+  if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE_UPDATE, &bUpdated) && bUpdated)
+  {
+    // Only the input load can change at run-time, the rest needs a reload
+    const char* value = GetVariable("testcore_input_polls");
+    if (value != nullptr)
+      inputPolls = strtoul(value, nullptr, 10);
+  }
+
+  PollInput();
+  RenderFrame();
+  RenderAudio();
+
+  frameCount++;
+
+  if (state.size() >= sizeof(frameCount))
+    memcpy(state.data(), &frameCount, sizeof(frameCount));
+}
+
+size_t retro_serialize_size(void)
+{
+  return state.size();
+}
+
+bool retro_serialize(void* data, size_t size)
+{
+  if (size < state.size())
+    return false;
+
+  memcpy(data, state.data(), state.size());
+  return true;
+}
+
+bool retro_unserialize(const void* data, size_t size)
+{
+  if (size < state.size())
+    return false;
+
+  memcpy(state.data(), data, state.size());
+
+  if (state.size() >= sizeof(frameCount))
+    memcpy(&frameCount, state.data(), sizeof(frameCount));
+
+  return true;
+}
+
+void retro_cheat_reset(void)
+{
+}
+
+void retro_cheat_set(unsigned /* index */, bool /* enabled */, const char* /* code */)
+{
+}
+
+bool retro_load_game(const retro_game_info* /* game */)
+{
+  ReadVariables();
+
+  if (!environ_cb(RETRO_ENVIRONMENT_SET_PIXEL_FORMAT, &pixelFormat))
+    return false;
+
+  frame.assign(static_cast<size_t>(width) * height * bytesPerPixel, 0);
+  audio.assign(static_cast<size_t>(TESTCORE_SAMPLE_RATE / TESTCORE_FPS) * 2, 0);
+
+  return true;
+}
+
+bool retro_load_game_special(unsigned /* game_type */, const retro_game_info* /* info */, size_t /* num_info */)
+{
+  return false;
+}
+
+void retro_unload_game(void)
+{
+}
+
+unsigned retro_get_region(void)
+{
+  return RETRO_REGION_NTSC;
+}
+
+void* retro_get_memory_data(unsigned /* id */)
+{
+  return nullptr;
+}
+
+size_t retro_get_memory_size(unsigned /* id */)
+{
+  return 0;
+}
@@ -20,29 +20,113 @@
 
 #include "GameInfoLoader.h"
 #include "log/Log.h"
+#include "profiling/TraceRecorder.h"
+#include "settings/Settings.h"
+#include "utils/CRC32.h"
+#include "utils/MemoryUtils.h"
+#include "utils/PathUtils.h"
+#include "utils/TimeUtils.h"
+#include "vfs/ArchiveUtils.h"
+#include "vfs/ContentCache.h"
+#include "vfs/PatchUtils.h"
+#include "vfs/VFSReader.h"
 
 #include "libXBMC_addon.h"
 
+#include <algorithm>
+#include <limits>
 #include <stdint.h>
+#include <stdio.h>
 
 using namespace ADDON;
 using namespace LIBRETRO;
 
-#define READ_SIZE      (100 * 1024)         // Read from VFS 100KB at a time (if file size is unknown)
-#define MAX_READ_SIZE  (100 * 1024 * 1024)  // Read at most 100MB from VFS
+#define MIN_MEMORY_BUDGET  (100 * 1024 * 1024)  // Budget if the available memory is unknown or low
+#define PROGRESS_INTERVAL  (10 * 1024 * 1024)   // Log progress every 10MB if the file size is unknown
+#define HASH_CHUNK_SIZE    (256 * 1024)         // Run both hashes over a chunk while it's in cache
+#define BUDGET_FRACTION    4                    // Budget at most a quarter of the address space
 
-CGameInfoLoader::CGameInfoLoader(const char* path, CHelper_libXBMC_addon* XBMC, bool bSupportsVFS)
+CGameInfoLoader::CGameInfoLoader(const char* path, CHelper_libXBMC_addon* XBMC, bool bSupportsVFS, bool bAllowExtract)
  : m_path(path),
    m_xbmc(XBMC),
-   m_bSupportsVfs(bSupportsVFS)
+   m_bSupportsVfs(bSupportsVFS),
+   m_bAllowExtract(bAllowExtract),
+   m_memoryBudget(MIN_MEMORY_BUDGET),
+   m_crc32(0),
+   m_hashedSize(0),
+   m_bHashed(false)
 {
 }
 
+CGameInfoLoader::~CGameInfoLoader(void)
+{
+  // The core may read the cached files until the loader is destroyed
+  if (!m_cachedKey.empty())
+    CContentCache::Get().Release(m_cachedKey);
+  if (!m_stagedKey.empty())
+    CContentCache::GetStaging().Release(m_stagedKey);
+
+  // Files can't be deleted while they're mapped on Windows
+  if (!m_tempPath.empty())
+  {
+    m_mappedFile.Close();
+    remove(m_tempPath.c_str());
+  }
+}
+
 bool CGameInfoLoader::Load(void)
 {
-  if (!m_bSupportsVfs)
+  CTraceScope trace("CGameInfoLoader::Load");
+
+  const int64_t startUs = TimeUtils::GetTimeUsec();
+
+  m_memoryBudget = GetMemoryBudget();
+
+  bool bLoaded = false;
+  if (m_bSupportsVfs)
+    bLoaded = LoadContent();
+  else if (!PathUtils::IsLocalPath(m_path))
+    Stage();
+
+  const char* strategy;
+  if (m_mappedFile.IsOpen())
+    strategy = m_stagedPath.empty() ? "memory-mapped" : "copied to local storage and memory-mapped";
+  else if (bLoaded)
+    strategy = "read into memory";
+  else
+    strategy = m_stagedPath.empty() ? "by path" : "copied to local storage, by path";
+
+  isyslog("Content loading strategy: %s (%u ms, memory budget %u MB): %s", strategy,
+          static_cast<unsigned int>((TimeUtils::GetTimeUsec() - startUs) / 1000),
+          static_cast<unsigned int>(m_memoryBudget / (1024 * 1024)), m_path.c_str());
+
+  if (!bLoaded)
     return false;
 
+  if (m_bAllowExtract)
+    Extract();
+
+  // Mapped content is hashed from its file when the digests are requested, so
+  // that loading doesn't fault in pages the core never reads
+  if (!m_mappedFile.IsOpen())
+    HashContent(m_dataBuffer.data(), m_dataBuffer.size());
+
+  Patch();
+
+  return true;
+}
+
+bool CGameInfoLoader::LoadContent(void)
+{
+  // Local files are mapped instead of copied
+  if (PathUtils::IsLocalPath(m_path) && m_mappedFile.Open(m_path))
+  {
+    m_mappedPath = m_path;
+    dsyslog("Mapped file into memory (%llu bytes): %s",
+            static_cast<unsigned long long>(m_mappedFile.Size()), m_path.c_str());
+    return true;
+  }
+
   struct __stat64 statStruct = { };
 
   bool bExists = (m_xbmc->StatFile(m_path.c_str(), &statStruct) == 0);
@@ -69,44 +153,319 @@ bool CGameInfoLoader::Load(void)
     return false;
   }
 
+  // Not all VFS protocols support StatFile(), but the open file may know its length
   int64_t size = statStruct.st_size;
-  if (size > 0)
+  if (size <= 0)
+    size = m_xbmc->GetFileLength(file);
+
+  // Content that doesn't fit the budget is streamed to disk and mapped, so
+  // that only the pages the core touches are resident
+  if (size > 0 && static_cast<uint64_t>(size) > m_memoryBudget)
   {
-    // Size is known, read entire file at once (unless it is too big)
-    if (size <= MAX_READ_SIZE)
+    m_xbmc->CloseFile(file);
+
+    dsyslog("File size (%u MB) is greater than memory budget (%u MB), mapping a local copy",
+            static_cast<unsigned int>(size / (1024 * 1024)), static_cast<unsigned int>(m_memoryBudget / (1024 * 1024)));
+
+    if (!Stage())
+      return false;
+
+    if (!m_mappedFile.Open(m_stagedPath))
     {
-      m_dataBuffer.resize((size_t)size);
-      m_xbmc->ReadFile(file, m_dataBuffer.data(), size);
+      esyslog("Failed to map local copy: %s", m_stagedPath.c_str());
+      return false;
     }
-    else
+
+    m_mappedPath = m_stagedPath;
+
+    return true;
+  }
+
+  const bool bLoaded = Read(file, size);
+
+  m_xbmc->CloseFile(file);
+
+  if (!bLoaded)
+  {
+    m_dataBuffer.clear();
+    return false;
+  }
+
+  dsyslog("Loaded file into memory (%d bytes): %s", m_dataBuffer.size(), m_path.c_str());
+
+  return true;
+}
+
+void CGameInfoLoader::Extract(void)
+{
+  const uint8_t* data = m_mappedFile.IsOpen() ? m_mappedFile.Data() : m_dataBuffer.data();
+  const size_t size = m_mappedFile.IsOpen() ? m_mappedFile.Size() : m_dataBuffer.size();
+
+  if (ArchiveUtils::GetFormat(data, size) == ARCHIVE_FORMAT_NONE)
+    return;
+
+  CTraceScope trace("CGameInfoLoader::Extract");
+
+  CContentCache& cache = CContentCache::Get();
+
+  std::string key;
+  struct __stat64 statStruct = { };
+  if (cache.IsEnabled() && m_xbmc->StatFile(m_path.c_str(), &statStruct) == 0)
+    key = CContentCache::GetKey(m_path, statStruct.st_mtime, statStruct.st_size);
+
+  if (!key.empty())
+  {
+    const std::string cachedPath = cache.Lookup(key);
+    if (!cachedPath.empty())
     {
-      dsyslog("File size (%d MB) is greater than memory limit (%d MB), loading by path",
-              size / (1024 * 1024), MAX_READ_SIZE / (1024 * 1024));
-      return false;
+      CMemoryMappedFile cachedFile;
+      if (cachedFile.Open(cachedPath))
+      {
+        dsyslog("Loaded extracted content from cache (%llu bytes): %s",
+                static_cast<unsigned long long>(cachedFile.Size()), cachedPath.c_str());
+        m_mappedFile.Swap(cachedFile);
+        m_mappedPath = cachedPath;
+        m_cachedKey = key;
+        std::vector<uint8_t>().swap(m_dataBuffer);
+        ResetHashes();
+        return;
+      }
+
+      cache.Release(key);
+      cache.Remove(key);
     }
   }
-  else
+
+  std::vector<uint8_t> content;
+  if (!ArchiveUtils::Extract(data, size, m_memoryBudget, content))
+  {
+    dsyslog("Failed to extract archive, passing it to the core as is: %s", m_path.c_str());
+    return;
+  }
+
+  dsyslog("Extracted archive (%llu bytes): %s", static_cast<unsigned long long>(content.size()), m_path.c_str());
+
+  m_mappedFile.Close();
+  m_mappedPath.clear();
+  m_dataBuffer.swap(content);
+  ResetHashes();
+
+  if (!key.empty())
+    cache.Insert(key, m_dataBuffer);
+}
+
+void CGameInfoLoader::Patch(void)
+{
+  static const char* const extensions[] = { ".bps", ".ups", ".ips" };
+
+  const std::string stem = PathUtils::RemoveExtension(m_path);
+
+  for (const char* extension : extensions)
   {
-    // Read file in chunks
-    unsigned int bytesRead;
-    uint8_t buffer[READ_SIZE];
-    while ((bytesRead = m_xbmc->ReadFile(file, buffer, sizeof(buffer))) > 0)
+    const std::string patchPath = stem + extension;
+    if (!m_xbmc->FileExists(patchPath.c_str(), true))
+      continue;
+
+    CTraceScope trace("CGameInfoLoader::Patch");
+
+    std::vector<uint8_t> patch;
+    if (!ReadFile(patchPath, patch) || PatchUtils::GetFormat(patch.data(), patch.size()) == PATCH_FORMAT_NONE)
     {
-      m_dataBuffer.insert(m_dataBuffer.end(), buffer, buffer + bytesRead);
+      esyslog("Invalid patch: %s", patchPath.c_str());
+      continue;
+    }
 
-      // If we read less than READ_SIZE, assume we hit the end of the file
-      if (bytesRead < READ_SIZE)
+    const size_t size = m_mappedFile.IsOpen() ? m_mappedFile.Size() : m_dataBuffer.size();
+    const size_t requiredSize = PatchUtils::GetRequiredSize(patch.data(), patch.size(), size);
+
+    bool bApplied;
+    size_t patchedSize;
+
+    if (m_mappedFile.IsOpen() && requiredSize != 0 && requiredSize <= size)
+    {
+      // The mapping is copy-on-write, so only the pages the patch writes to
+      // are copied, and the file is left untouched
+      patchedSize = size;
+      bApplied = PatchUtils::Apply(patch.data(), patch.size(), m_mappedFile.Data(), patchedSize);
+      if (bApplied)
+        m_mappedFile.Truncate(patchedSize);
+    }
+    else
+    {
+      // Content that grows needs a buffer
+      if (size > m_memoryBudget)
+      {
+        esyslog("Content is greater than memory budget, not applying patch: %s", patchPath.c_str());
         break;
+      }
 
-      // If we have exceeded the VFS file size limit, don't try to load by
-      // VFS and fall back to loading by path
-      if (m_dataBuffer.size() > MAX_READ_SIZE)
+      if (m_mappedFile.IsOpen())
       {
-        dsyslog("File exceeds memory limit (%d MB), loading by path",
-                MAX_READ_SIZE / (1024 * 1024));
-        return false;
+        m_dataBuffer.assign(m_mappedFile.Data(), m_mappedFile.Data() + m_mappedFile.Size());
+        m_mappedFile.Close();
       }
+
+      bApplied = PatchUtils::Apply(patch.data(), patch.size(), m_memoryBudget, m_dataBuffer);
+      patchedSize = m_dataBuffer.size();
     }
+
+    if (bApplied)
+      isyslog("Applied patch (%llu bytes after patching): %s", static_cast<unsigned long long>(patchedSize), patchPath.c_str());
+    else
+      esyslog("Failed to apply patch: %s", patchPath.c_str());
+
+    break;
+  }
+}
+
+bool CGameInfoLoader::Stage(void)
+{
+  CContentCache& cache = CContentCache::GetStaging();
+
+  CTraceScope trace("CGameInfoLoader::Stage");
+
+  // Without a size, content can't be budgeted or checked for changes
+  struct __stat64 statStruct = { };
+  if (m_xbmc->StatFile(m_path.c_str(), &statStruct) != 0 || statStruct.st_size <= 0)
+  {
+    esyslog("Failed to stat, can't copy content to local storage: %s", m_path.c_str());
+    return false;
+  }
+
+  const uint64_t size = static_cast<uint64_t>(statStruct.st_size);
+  const std::string key = CContentCache::GetKey(m_path, statStruct.st_mtime, statStruct.st_size);
+
+  if (cache.IsEnabled())
+  {
+    m_stagedPath = cache.Lookup(key);
+    if (!m_stagedPath.empty())
+    {
+      m_stagedKey = key;
+      dsyslog("Using local copy: %s", m_stagedPath.c_str());
+      return true;
+    }
+  }
+
+  const int64_t startUs = TimeUtils::GetTimeUsec();
+
+  // Write each block while the next one is being read
+  void* file = nullptr;
+  auto copy = [this, &file, size](std::ostream& stream)
+    {
+      CVFSReader reader(m_xbmc, file);
+      return reader.ReadBlocks(size, [&stream](const uint8_t* data, size_t blockSize)
+        {
+          stream.write(reinterpret_cast<const char*>(data), blockSize);
+          return stream.good();
+        });
+    };
+
+  const std::string name = PathUtils::GetBasename(m_path);
+
+  if (cache.IsEnabled())
+  {
+    file = m_xbmc->OpenFile(m_path.c_str(), 0);
+    if (!file)
+    {
+      esyslog("Failed to open file: %s", m_path.c_str());
+      return false;
+    }
+
+    m_stagedPath = cache.Insert(key, name, size, copy);
+
+    m_xbmc->CloseFile(file);
+
+    if (!m_stagedPath.empty())
+      m_stagedKey = key;
+  }
+
+  // The staging cache is disabled, smaller than the content or full of
+  // content in use. Copy to a file of this loader instead.
+  if (m_stagedPath.empty())
+  {
+    isyslog("Staging cache is disabled or can't hold content (%llu MB), copying to a temporary file: %s",
+            static_cast<unsigned long long>(size / (1024 * 1024)), m_path.c_str());
+
+    file = m_xbmc->OpenFile(m_path.c_str(), 0);
+    if (!file)
+    {
+      esyslog("Failed to open file: %s", m_path.c_str());
+      return false;
+    }
+
+    m_stagedPath = cache.WriteTemporary(name, size, copy);
+    m_tempPath = m_stagedPath;
+
+    m_xbmc->CloseFile(file);
+  }
+
+  if (m_stagedPath.empty())
+  {
+    esyslog("Failed to copy content to local storage, loading by path: %s", m_path.c_str());
+    return false;
+  }
+
+  const int64_t elapsedMs = std::max<int64_t>((TimeUtils::GetTimeUsec() - startUs) / 1000, 1);
+  dsyslog("Copied content to local storage (%llu MB in %u ms, %u MB/s): %s",
+          static_cast<unsigned long long>(size / (1024 * 1024)), static_cast<unsigned int>(elapsedMs),
+          static_cast<unsigned int>(size * 1000 / (1024 * 1024) / elapsedMs), m_stagedPath.c_str());
+
+  return true;
+}
+
+bool CGameInfoLoader::ReadFile(const std::string& path, std::vector<uint8_t>& buffer)
+{
+  void* file = m_xbmc->OpenFile(path.c_str(), 0);
+  if (!file)
+    return false;
+
+  const int64_t size = m_xbmc->GetFileLength(file);
+
+  CVFSReader reader(m_xbmc, file);
+  const bool bSuccess = reader.ReadAll(buffer, size > 0 ? static_cast<uint64_t>(size) : 0, m_memoryBudget);
+
+  m_xbmc->CloseFile(file);
+
+  return bSuccess;
+}
+
+bool CGameInfoLoader::Read(void* file, int64_t size)
+{
+  const uint64_t expectedSize = size > 0 ? static_cast<uint64_t>(size) : 0;
+
+  // Log every 10%, or every 10 MB if the size is unknown
+  uint64_t nextReport = 0;
+
+  // Archives are hashed after extraction instead
+  bool bHash = true;
+
+  auto progress = [this, &nextReport, &bHash](uint64_t bytesRead, uint64_t totalBytes)
+    {
+      // Hash the new block while the reader fetches the next one
+      if (bHash && m_hashedSize == 0 && m_bAllowExtract &&
+          ArchiveUtils::GetFormat(m_dataBuffer.data(), m_dataBuffer.size()) != ARCHIVE_FORMAT_NONE)
+      {
+        bHash = false;
+      }
+      if (bHash)
+        UpdateHashes(m_dataBuffer.data() + m_hashedSize, m_dataBuffer.size() - m_hashedSize);
+
+      const uint64_t step = totalBytes > 0 ? totalBytes / 10 : PROGRESS_INTERVAL;
+      if (bytesRead >= nextReport)
+      {
+        if (totalBytes > 0)
+          dsyslog("Reading %s: %u%%", m_path.c_str(), static_cast<unsigned int>(bytesRead * 100 / totalBytes));
+        else
+          dsyslog("Reading %s: %u MB", m_path.c_str(), static_cast<unsigned int>(bytesRead / (1024 * 1024)));
+        nextReport = bytesRead + step;
+      }
+    };
+
+  CVFSReader reader(m_xbmc, file);
+  if (!reader.ReadAll(m_dataBuffer, expectedSize, m_memoryBudget, progress))
+  {
+    dsyslog("Failed to read file, loading by path");
+    return false;
   }
 
   if (m_dataBuffer.empty())
@@ -115,14 +474,110 @@ bool CGameInfoLoader::Load(void)
     return false;
   }
 
-  dsyslog("Loaded file into memory (%d bytes): %s", m_dataBuffer.size(), m_path.c_str());
-
   return true;
 }
 
+bool CGameInfoLoader::HasHashes(void)
+{
+  if (!m_bHashed && !m_mappedPath.empty())
+  {
+    // A separate mapping of the file has the unpatched content, as patches
+    // are applied to a private copy
+    CMemoryMappedFile file;
+    if (file.Open(m_mappedPath))
+      HashContent(file.Data(), file.Size());
+    else
+      esyslog("Failed to map content for hashing: %s", m_mappedPath.c_str());
+
+    // Don't retry on every call
+    m_mappedPath.clear();
+  }
+
+  return m_bHashed;
+}
+
+uint32_t CGameInfoLoader::GetCRC32(void)
+{
+  return HasHashes() ? m_crc32 : 0;
+}
+
+const std::string& CGameInfoLoader::GetSHA1(void)
+{
+  HasHashes();
+  return m_sha1Digest;
+}
+
+void CGameInfoLoader::HashContent(const uint8_t* data, size_t size)
+{
+  CTraceScope trace("CGameInfoLoader::HashContent");
+
+  const int64_t startUs = TimeUtils::GetTimeUsec();
+
+  // Whatever wasn't hashed while reading
+  if (m_hashedSize < size)
+    UpdateHashes(data + m_hashedSize, size - m_hashedSize);
+
+  m_sha1Digest = m_sha1.Finalize();
+  m_bHashed = true;
+
+  dsyslog("Content CRC32 %08x SHA-1 %s (hashed in %u ms)", m_crc32, m_sha1Digest.c_str(),
+          static_cast<unsigned int>((TimeUtils::GetTimeUsec() - startUs) / 1000));
+}
+
+uint64_t CGameInfoLoader::GetMemoryBudget(void)
+{
+  uint64_t budget;
+
+  const unsigned int budgetMB = CSettings::Get().MemoryBudgetMB();
+  if (budgetMB > 0)
+  {
+    budget = static_cast<uint64_t>(budgetMB) * 1024 * 1024;
+  }
+  else
+  {
+    // Leave half of the available memory to the core and the rest of the system
+    budget = std::max<uint64_t>(MemoryUtils::GetAvailableMemory() / 2, MIN_MEMORY_BUDGET);
+  }
+
+  // The budget sizes buffers, so it must fit in a size_t. A 32-bit process
+  // can't allocate a contiguous buffer near the size of its address space,
+  // however much memory the system has.
+  return std::min<uint64_t>(budget, std::numeric_limits<size_t>::max() / BUDGET_FRACTION);
+}
+
+void CGameInfoLoader::ResetHashes(void)
+{
+  m_crc32 = 0;
+  m_sha1.Reset();
+  m_hashedSize = 0;
+}
+
+void CGameInfoLoader::UpdateHashes(const uint8_t* data, size_t size)
+{
+  while (size > 0)
+  {
+    const size_t chunk = std::min<size_t>(size, HASH_CHUNK_SIZE);
+
+    m_crc32 = CRC32::Update(m_crc32, data, chunk);
+    m_sha1.Update(data, chunk);
+
+    m_hashedSize += chunk;
+    data += chunk;
+    size -= chunk;
+  }
+}
+
 bool CGameInfoLoader::GetMemoryStruct(retro_game_info& info) const
 {
-  if (!m_dataBuffer.empty())
+  if (m_mappedFile.IsOpen())
+  {
+    info.path = nullptr;
+    info.data = m_mappedFile.Data();
+    info.size = m_mappedFile.Size();
+    info.meta = nullptr;
+    return true;
+  }
+  else if (!m_dataBuffer.empty())
   {
     info.path = nullptr;
     info.data = m_dataBuffer.data();
@@ -135,7 +590,7 @@ bool CGameInfoLoader::GetMemoryStruct(retro_game_info& info) const
 
 bool CGameInfoLoader::GetPathStruct(retro_game_info& info) const
 {
-  info.path = m_path.c_str();
+  info.path = m_stagedPath.empty() ? m_path.c_str() : m_stagedPath.c_str();
   info.data = nullptr;
   info.size = 0;
   info.meta = nullptr;
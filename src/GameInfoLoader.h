@@ -20,6 +20,8 @@
 #pragma once
 
 #include "libretro/libretro.h"
+#include "utils/MemoryMappedFile.h"
+#include "utils/SHA1.h"
 
 #include <stdint.h>
 #include <string>
@@ -35,11 +37,41 @@ namespace LIBRETRO
    * the libretro core can be instructed to load via memory or via path. This
    * class abstracts this logic by accepting a path and generating the
    * appropriate retro_game_info structs.
+   *
+   * Files on the local filesystem are memory-mapped and passed to the core
+   * without a copy. The mapping lives as long as the loader, so it remains
+   * valid until the game is unloaded. Other files are read through Kodi's VFS
+   * if they fit the memory budget, or else copied to the staging cache and
+   * mapped from there. Zip and gzip archives are extracted in memory.
+   *
+   * The CRC-32 and SHA-1 of the content are computed as it's loaded. When
+   * reading through the VFS, each block is hashed as soon as it arrives while
+   * the next one is being read. Mapped content is only hashed when the
+   * digests are first requested, so loading doesn't read pages the core never
+   * touches. The digests describe the unpatched content,
+   * after extraction: that's what game databases and patches are keyed by.
+   * When a patch is applied, the core receives different bytes.
+   *
+   * If a .bps, .ups or .ips file with the same name is found next to the
+   * content, the first one in that order is applied to the content in memory.
+   * Mapped content is patched in place unless the patch grows it, in which
+   * case it's copied first. Patches have no effect when the core loads by
+   * path.
+   *
+   * Cores that need a path can't open VFS URLs, so content that isn't on the
+   * local filesystem is copied to the staging cache and the core is given the
+   * path of the copy.
    */
   class CGameInfoLoader
   {
   public:
-    CGameInfoLoader(const char* path, ADDON::CHelper_libXBMC_addon* XBMC, bool bSupportsVFS);
+    /*!
+     * \param bAllowExtract  False if the core must receive archives as they
+     *                       are, see retro_system_info::block_extract
+     */
+    CGameInfoLoader(const char* path, ADDON::CHelper_libXBMC_addon* XBMC, bool bSupportsVFS, bool bAllowExtract);
+
+    ~CGameInfoLoader(void);
 
     bool Load(void);
 
@@ -52,14 +84,96 @@ namespace LIBRETRO
 
     /*!
      * As a fallback, this gets a struct that instructs libretro to load via
-     * path. This always returns true.
+     * path. The path is the local copy if the content was staged. This always
+     * returns true.
      */
     bool GetPathStruct(retro_game_info& info) const;
 
+    /*!
+     * True if the content was loaded into memory and hashed. Mapped content
+     * is hashed by the first call.
+     */
+    bool HasHashes(void);
+
+    /*!
+     * The CRC-32 of the unpatched content, or 0 if HasHashes() is false
+     */
+    uint32_t GetCRC32(void);
+
+    /*!
+     * The SHA-1 of the unpatched content as 40 lowercase hex digits, or empty
+     * if HasHashes() is false
+     */
+    const std::string& GetSHA1(void);
+
   private:
+    /*!
+     * Map or read the file into memory
+     */
+    bool LoadContent(void);
+
+    /*!
+     * Replace zip and gzip archives by their content, using the content cache
+     * if enabled. The archive is kept if it can't be extracted.
+     */
+    void Extract(void);
+
+    /*!
+     * Apply a soft patch found next to the content
+     */
+    void Patch(void);
+
+    /*!
+     * Copy content outside the local filesystem to the staging cache, for
+     * cores that need a path or content greater than the memory budget. If
+     * the cache can't hold it, the content is copied to a temporary file that
+     * is deleted with the loader.
+     */
+    bool Stage(void);
+
+    /*!
+     * Read an open VFS file into the data buffer with read-ahead. Returns
+     * false if the file is empty or exceeds the memory budget.
+     */
+    bool Read(void* file, int64_t size);
+
+    /*!
+     * Read a small file, such as a patch, through the VFS
+     */
+    bool ReadFile(const std::string& path, std::vector<uint8_t>& buffer);
+
+    /*!
+     * Hash the content that hasn't been hashed yet and finalize the digests
+     */
+    void HashContent(const uint8_t* data, size_t size);
+
+    /*!
+     * The largest content held in memory, from the settings or else derived
+     * from the available memory, capped at a quarter of the address space
+     */
+    static uint64_t GetMemoryBudget(void);
+
+    void ResetHashes(void);
+    void UpdateHashes(const uint8_t* data, size_t size);
+
     const std::string                   m_path;
     ADDON::CHelper_libXBMC_addon* const m_xbmc;
     const bool                          m_bSupportsVfs;
+    const bool                          m_bAllowExtract;
+    uint64_t                            m_memoryBudget;
     std::vector<uint8_t>                m_dataBuffer;
+    CMemoryMappedFile                   m_mappedFile;
+    std::string                         m_mappedPath; // File to hash, until hashed
+    std::string                         m_stagedPath;
+    std::string                         m_stagedKey; // Pinned in the staging cache
+    std::string                         m_cachedKey; // Pinned in the extraction cache
+    std::string                         m_tempPath;  // Staged outside the cache, deleted with the loader
+
+    // Content identity
+    uint32_t                            m_crc32;
+    CSHA1                               m_sha1;
+    size_t                              m_hashedSize;
+    bool                                m_bHashed;
+    std::string                         m_sha1Digest;
   };
 } // namespace LIBRETRO
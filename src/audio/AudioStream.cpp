@@ -25,9 +25,14 @@
 
 using namespace LIBRETRO;
 
+#define AUDIO_QUEUE_SIZE  8 // Packets, one per frame
+
 CAudioStream::CAudioStream() :
   m_frontend(nullptr),
   m_singleFrameAudio(this),
+  m_bMuted(false),
+  m_bQueued(false),
+  m_queue(AUDIO_QUEUE_SIZE),
   m_bAudioOpen(false)
 {
 }
@@ -35,6 +40,7 @@ CAudioStream::CAudioStream() :
 void CAudioStream::Initialize(CHelper_libKODI_game* frontend)
 {
   m_frontend = frontend;
+  m_bMuted = false;
   m_bAudioOpen = false;
 }
 
@@ -45,9 +51,57 @@ void CAudioStream::Deinitialize()
 
   m_frontend = nullptr;
   m_bAudioOpen = false;
+  m_bQueued = false;
+  m_packet.clear();
+  m_queue.Clear();
+}
+
+void CAudioStream::SetQueued(bool bQueued)
+{
+  m_bQueued = bQueued;
+  m_packet.clear();
+  m_queue.Clear();
 }
 
 void CAudioStream::AddFrames_S16NE(const uint8_t* data, unsigned int size)
+{
+  if (m_bMuted)
+    return;
+
+  if (m_bQueued)
+    m_packet.insert(m_packet.end(), data, data + size);
+  else
+    SendFrames(data, size);
+}
+
+void CAudioStream::EndFrame()
+{
+  if (m_packet.empty())
+    return;
+
+  std::vector<uint8_t>* packet = m_queue.BeginWrite();
+  if (packet != nullptr)
+  {
+    // Swap buffers so that both keep their capacity
+    packet->swap(m_packet);
+    m_queue.EndWrite();
+  }
+
+  // If the queue is full, the frontend is falling behind and the audio is dropped
+  m_packet.clear();
+}
+
+void CAudioStream::Flush()
+{
+  const std::vector<uint8_t>* packet;
+  while ((packet = m_queue.BeginRead()) != nullptr)
+  {
+    SendFrames(packet->data(), packet->size());
+    m_queue.EndRead();
+  }
+}
+
+void CAudioStream::SendFrames(const uint8_t* data, unsigned int size)
 {
   if (m_frontend && !m_bAudioOpen)
   {
@@ -20,9 +20,13 @@
 #pragma once
 
 #include "SingleFrameAudio.h"
+#include "utils/SpscRing.h"
 
 #include "kodi_game_types.h"
 
+#include <stdint.h>
+#include <vector>
+
 class CHelper_libKODI_game;
 
 namespace LIBRETRO
@@ -35,14 +39,45 @@ namespace LIBRETRO
     void Initialize(CHelper_libKODI_game* frontend);
     void Deinitialize();
 
-    void AddFrame_S16NE(int16_t left, int16_t right) { m_singleFrameAudio.AddFrame(left, right); }
+    /*!
+     * \brief Drop audio instead of sending it to the frontend
+     */
+    void SetMuted(bool bMuted) { m_bMuted = bMuted; }
+    bool IsMuted() const { return m_bMuted; }
+
+    void AddFrame_S16NE(int16_t left, int16_t right) { if (!m_bMuted) m_singleFrameAudio.AddFrame(left, right); }
 
     void AddFrames_S16NE(const uint8_t* data, unsigned int size);
 
+    /*!
+     * \brief Queue audio instead of sending it to the frontend
+     *
+     * Audio added during a frame is collected into one packet, which is
+     * queued by EndFrame() and sent by Flush() on the frontend's thread.
+     * Must not be called while audio is being added.
+     */
+    void SetQueued(bool bQueued);
+
+    /*!
+     * \brief Queue the audio collected during the frame
+     */
+    void EndFrame();
+
+    /*!
+     * \brief Send queued audio to the frontend
+     */
+    void Flush();
+
   private:
+    void SendFrames(const uint8_t* data, unsigned int size);
+
     CHelper_libKODI_game* m_frontend;
     CSingleFrameAudio     m_singleFrameAudio;
 
+    bool                            m_bMuted;
+    bool                            m_bQueued;
+    std::vector<uint8_t>            m_packet; // Audio of the current frame
+    CSpscRing<std::vector<uint8_t>> m_queue;
     bool m_bAudioOpen;
   };
 }
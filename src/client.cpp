@@ -18,6 +18,12 @@
  *
  */
 
+#include "emulation/DiskSwapper.h"
+#include "emulation/EmulationThread.h"
+#include "emulation/FastForward.h"
+#include "emulation/FrameClock.h"
+#include "emulation/Rewind.h"
+#include "emulation/RunAhead.h"
 #include "input/ButtonMapper.h"
 #include "input/InputManager.h"
 #include "libretro/ClientBridge.h"
@@ -26,7 +32,14 @@
 #include "libretro/LibretroEnvironment.h"
 #include "log/Log.h"
 #include "log/LogAddon.h"
+#include "profiling/FrameProfiler.h"
+#include "profiling/InputLatency.h"
+#include "profiling/PerfCounters.h"
+#include "profiling/TraceRecorder.h"
 #include "settings/Settings.h"
+#include "utils/ThreadPool.h"
+#include "vfs/ContentCache.h"
+#include "vfs/PlaylistUtils.h"
 #include "GameInfoLoader.h"
 
 #include "libXBMC_addon.h"
@@ -34,16 +47,24 @@
 #include "xbmc_addon_dll.h"
 #include "kodi_game_dll.h"
 
+#include <algorithm>
 #include <set>
 #include <string>
 #include <vector>
 
 using namespace ADDON;
 using namespace LIBRETRO;
+using namespace P8PLATFORM;
 
 #define GAME_CLIENT_NAME_UNKNOWN      "Unknown libretro core"
 #define GAME_CLIENT_VERSION_UNKNOWN   "0.0.0"
 
+#define FRAME_PROFILE_FILE_NAME  "frametimes.json"
+#define INPUT_LATENCY_FILE_NAME  "inputlatency.json"
+#define TRACE_FILE_NAME          "trace.json"
+
+#define MAX_LOAD_THREADS  4 // Threads used to load the files of special content
+
 #ifndef SAFE_DELETE
 #define SAFE_DELETE(x)  do { delete x; x = nullptr; } while (0)
 #endif
@@ -63,6 +84,125 @@ namespace LIBRETRO
   CClientBridge*                CLIENT_BRIDGE = nullptr;
   std::vector<CGameInfoLoader*> GAME_INFO;
   bool                          SUPPORTS_VFS = false; // TODO
+  bool                          ALLOW_EXTRACT = true;
+  bool                          SUPPORTS_PLAYLISTS = false;
+}
+
+void InitializeContentCaches(void)
+{
+  CContentCache::Get().Initialize(CLibretroEnvironment::Get().GetCacheDirectory(),
+                                  static_cast<uint64_t>(CSettings::Get().ContentCacheMB()) * 1024 * 1024);
+  CContentCache::GetStaging().Initialize(CLibretroEnvironment::Get().GetStagingDirectory(),
+                                         static_cast<uint64_t>(CSettings::Get().StagingCacheMB()) * 1024 * 1024);
+}
+
+void FlushContentCaches(void)
+{
+  CContentCache::Get().Flush();
+  CContentCache::GetStaging().Flush();
+}
+
+void RunCoreFrame(void)
+{
+  CLIENT_BRIDGE->FrameTime(CFrameClock::Get().NextFrameTime(CLIENT_BRIDGE->GetFrameTimeReference()));
+
+  CInputManager::Get().FrameStart();
+
+  CProfileScope profile(PROFILE_PHASE_CORE);
+  CTraceScope trace("retro_run");
+  CLIENT->retro_run();
+}
+
+void RunGameFrame(void)
+{
+  CRewind& rewind = CRewind::Get();
+
+  // Fast-forward and rewind report the reference frame time so that the core
+  // doesn't compensate for the change in speed
+  const bool bRealTime = !rewind.IsRewinding() && !CFastForward::Get().IsEnabled();
+  CFrameClock::Get().FrameStart(bRealTime);
+
+  CFrameProfiler::Get().BeginFrame();
+
+  CDiskSwapper::Get().FrameStart();
+
+  if (rewind.IsRewinding())
+  {
+    // Run a frame from the restored state so that it is presented. The frame
+    // isn't captured, so the history is only overwritten once the game moves
+    // forward again.
+    if (rewind.Rewind())
+      RunCoreFrame();
+  }
+  else if (CFastForward::Get().IsEnabled())
+  {
+    // Running ahead is pointless when the intermediate frames aren't shown
+    CFastForward::Get().RunFrame([&rewind]()
+      {
+        RunCoreFrame();
+        rewind.FrameEnd();
+      });
+  }
+  else
+  {
+    if (CRunAhead::Get().IsEnabled())
+      CRunAhead::Get().RunFrame(RunCoreFrame);
+    else
+      RunCoreFrame();
+
+    rewind.FrameEnd();
+  }
+
+  CFrameProfiler::Get().EndFrame();
+}
+
+void InitializeGameLoop(void)
+{
+  CFrameClock::Get().Reset();
+
+  // Game loading has been traced, frames are only traced if enabled
+  CTraceRecorder::Get().SetRecording(CSettings::Get().Tracing());
+
+  if (CSettings::Get().FrameProfiling())
+  {
+    CFrameProfiler::Get().Initialize();
+    CInputLatency::Get().Initialize(INPUT_SLOT_COUNT);
+  }
+
+  if (CSettings::Get().RewindEnabled())
+  {
+    const size_t maxBytes = static_cast<size_t>(CSettings::Get().RewindBufferMB()) * 1024 * 1024;
+    CRewind::Get().Initialize(CLIENT, CSettings::Get().RewindInterval(), maxBytes);
+  }
+
+  if (CSettings::Get().RunAheadFrames() > 0)
+    CRunAhead::Get().Initialize(CLIENT, CSettings::Get().RunAheadFrames());
+
+  if (CSettings::Get().ThreadedEmulation())
+    CEmulationThread::Get().Initialize(RunGameFrame);
+
+  CFastForward::Get().SetRatio(CSettings::Get().FastForwardRatio());
+  CFastForward::Get().SetEnabled(false);
+}
+
+void DeinitializeGameLoop(void)
+{
+  CEmulationThread::Get().Deinitialize();
+  CFastForward::Get().SetEnabled(false);
+  CRunAhead::Get().Deinitialize();
+  CRewind::Get().Deinitialize();
+
+  if (CFrameProfiler::Get().IsEnabled())
+  {
+    CFrameProfiler::Get().Dump(CLibretroEnvironment::Get().GetProfileDirectory() + "/" FRAME_PROFILE_FILE_NAME);
+    CFrameProfiler::Get().Deinitialize();
+  }
+
+  if (CInputLatency::Get().IsEnabled())
+  {
+    CInputLatency::Get().Dump(CLibretroEnvironment::Get().GetProfileDirectory() + "/" INPUT_LATENCY_FILE_NAME);
+    CInputLatency::Get().Deinitialize();
+  }
 }
 
 extern "C"
@@ -70,6 +210,8 @@ extern "C"
 
 ADDON_STATUS ADDON_Create(void* callbacks, void* props)
 {
+  CTraceScope trace("ADDON_Create");
+
   try
   {
     if (!callbacks || !props)
@@ -110,7 +252,10 @@ ADDON_STATUS ADDON_Create(void* callbacks, void* props)
 
     CButtonMapper::Get().LoadButtonMap();
 
-    CLIENT->retro_init();
+    {
+      CTraceScope trace("retro_init");
+      CLIENT->retro_init();
+    }
 
     // Log core info
     retro_system_info systemInfo = { };
@@ -121,15 +266,22 @@ ADDON_STATUS ADDON_Create(void* callbacks, void* props)
     // is false, the core can load from memory.
     SUPPORTS_VFS = !systemInfo.need_fullpath;
 
+    // Some cores need archives as they are, e.g. for multi-file arcade sets
+    ALLOW_EXTRACT = !systemInfo.block_extract;
+
     std::string libraryName = systemInfo.library_name ? systemInfo.library_name : "";
     std::string libraryVersion = systemInfo.library_version ? systemInfo.library_version : "";
     std::string extensions = systemInfo.valid_extensions ? systemInfo.valid_extensions : "";
 
+    // Cores that read M3U playlists are given the playlist instead of the first disc
+    SUPPORTS_PLAYLISTS = ("|" + extensions + "|").find("|m3u|") != std::string::npos;
+
     dsyslog("CORE: ----------------------------------");
     dsyslog("CORE: Library name:    %s", libraryName.c_str());
     dsyslog("CORE: Library version: %s", libraryVersion.c_str());
     dsyslog("CORE: Extensions:      %s", extensions.c_str());
     dsyslog("CORE: Supports VFS:    %s", SUPPORTS_VFS ? "true" : "false");
+    dsyslog("CORE: Reads playlists: %s", SUPPORTS_PLAYLISTS ? "true" : "false");
     dsyslog("CORE: ----------------------------------");
 
     // Reject invalid properties
@@ -173,9 +325,16 @@ void ADDON_Destroy(void)
     CLIENT_BRIDGE->AudioEnable(false);
   */
 
+  DeinitializeGameLoop();
+  FlushContentCaches();
+
   if (CLIENT)
     CLIENT->retro_deinit();
 
+  // Counters live in the core, which is about to be unloaded
+  CPerfCounters::Get().Log();
+  CPerfCounters::Get().Clear();
+
   CLibretroEnvironment::Get().Deinitialize();
 
   CLog::Get().SetType(SYS_LOG_TYPE_CONSOLE);
@@ -217,9 +376,25 @@ GAME_ERROR LoadGame(const char* url)
   if (url == nullptr)
     return GAME_ERROR_INVALID_PARAMETERS;
 
+  CTraceScope trace("LoadGame");
+
+  InitializeContentCaches();
+
+  // Multi-disc games start with the first disc of the playlist
+  std::vector<std::string> images;
+  std::string contentPath = url;
+  if (PlaylistUtils::IsPlaylist(contentPath))
+  {
+    if (!PlaylistUtils::Load(XBMC, contentPath, images))
+      return GAME_ERROR_FAILED;
+
+    if (!SUPPORTS_PLAYLISTS)
+      contentPath = images[0];
+  }
+
   // Build info loader vector
   SAFE_DELETE_GAME_INFO(GAME_INFO);
-  GAME_INFO.push_back(new CGameInfoLoader(url, XBMC, SUPPORTS_VFS));
+  GAME_INFO.push_back(new CGameInfoLoader(contentPath.c_str(), XBMC, SUPPORTS_VFS, ALLOW_EXTRACT));
 
   bool bResult = false;
 
@@ -228,6 +403,7 @@ GAME_ERROR LoadGame(const char* url)
   if (GAME_INFO[0]->Load())
   {
     GAME_INFO[0]->GetMemoryStruct(gameInfo);
+    CTraceScope traceLoad("retro_load_game");
     bResult = CLIENT->retro_load_game(&gameInfo);
   }
 
@@ -235,11 +411,16 @@ GAME_ERROR LoadGame(const char* url)
   {
     // Fall back to loading via path
     GAME_INFO[0]->GetPathStruct(gameInfo);
+    CTraceScope traceLoad("retro_load_game");
     bResult = CLIENT->retro_load_game(&gameInfo);
   }
 
   if (bResult)
   {
+    CDiskSwapper::Get().Initialize(CLIENT_BRIDGE, XBMC, images, !SUPPORTS_PLAYLISTS, SUPPORTS_VFS, ALLOW_EXTRACT);
+
+    InitializeGameLoop();
+
     CInputManager::Get().OpenPort(0);
 
     // TODO
@@ -259,37 +440,99 @@ GAME_ERROR LoadGameSpecial(SPECIAL_GAME_TYPE type, const char** urls, size_t url
   if (urls == nullptr || urlCount == 0)
     return GAME_ERROR_INVALID_PARAMETERS;
 
-  // TODO
-  return GAME_ERROR_FAILED;
-  /*
-  retro_system_info info = { };
-  CLIENT->retro_get_system_info(&info);
-  const bool bSupportsVFS = !info.need_fullpath;
+  CTraceScope trace("LoadGameSpecial");
+
+  const LibretroSubsystem* subsystem = CLibretroEnvironment::Get().Subsystems().GetSubsystem(type);
+  if (subsystem == nullptr)
+  {
+    esyslog("Core doesn't support special game type %d", static_cast<int>(type));
+    return GAME_ERROR_NOT_IMPLEMENTED;
+  }
+
+  if (urlCount > subsystem->roms.size())
+  {
+    esyslog("%s: Expected at most %u files, got %u", subsystem->description.c_str(),
+            static_cast<unsigned int>(subsystem->roms.size()), static_cast<unsigned int>(urlCount));
+    return GAME_ERROR_INVALID_PARAMETERS;
+  }
+
+  for (size_t i = 0; i < subsystem->roms.size(); i++)
+  {
+    if (i < urlCount ? urls[i] == nullptr : subsystem->roms[i].bRequired)
+    {
+      esyslog("%s: Missing %s", subsystem->description.c_str(), subsystem->roms[i].description.c_str());
+      return GAME_ERROR_INVALID_PARAMETERS;
+    }
+  }
+
+  InitializeContentCaches();
 
   // Build info loader vector
   SAFE_DELETE_GAME_INFO(GAME_INFO);
-  for (unsigned int i = 0; i < urlCount; i++)
-    GAME_INFO.push_back(new CGameInfoLoader(urls[i], XBMC, bSupportsVFS));
+  for (size_t i = 0; i < urlCount; i++)
+  {
+    const LibretroSubsystemRom& rom = subsystem->roms[i];
+    GAME_INFO.push_back(new CGameInfoLoader(urls[i], XBMC, !rom.bNeedFullPath, !rom.bBlockExtract));
+  }
 
-  // Try to load via memory
-  std::vector<retro_game_info> infoVec;
-  infoVec.resize(urlCount);
-  bool bLoadFromMemory = true;
-  for (unsigned int i = 0; bLoadFromMemory && i < urlCount; i++)
-    bLoadFromMemory &= GAME_INFO[i]->GetMemoryStruct(infoVec[i]);
-  if (bLoadFromMemory)
+  // Load the files concurrently so that the VFS latency is paid once
+  std::vector<char> loaded(urlCount, 0);
   {
-    if (CLIENT->retro_load_game_special(type, infoVec.data(), urlCount))
-      return GAME_ERROR_NO_ERROR;
+    CThreadPool pool(urlCount > 1 ? std::min<unsigned int>(urlCount, MAX_LOAD_THREADS) : 0);
+    for (size_t i = 0; i < urlCount; i++)
+    {
+      CGameInfoLoader* loader = GAME_INFO[i];
+      char& bLoaded = loaded[i];
+      pool.Submit([loader, &bLoaded]() { bLoaded = loader->Load(); });
+    }
+    pool.Wait();
   }
 
-  // Fall back to loading by path
-  for (unsigned int i = 0; i < urlCount; i++)
-    GAME_INFO[i]->GetPathStruct(infoVec[i]);
-  bool result = CLIENT->retro_load_game_special(type, infoVec.data(), urlCount);
+  // Optional content that wasn't provided is passed zeroed
+  std::vector<retro_game_info> infoVec(subsystem->roms.size(), retro_game_info());
 
-  return result ? GAME_ERROR_NO_ERROR : GAME_ERROR_FAILED;
-  */
+  bool bResult = false;
+
+  // Try to load via memory, falling back to the path for files that couldn't
+  // be loaded or belong to cores that need a path
+  bool bAnyInMemory = false;
+  for (size_t i = 0; i < urlCount; i++)
+  {
+    if (loaded[i] && GAME_INFO[i]->GetMemoryStruct(infoVec[i]))
+      bAnyInMemory = true;
+    else
+      GAME_INFO[i]->GetPathStruct(infoVec[i]);
+  }
+
+  {
+    CTraceScope traceLoad("retro_load_game_special");
+    bResult = CLIENT->retro_load_game_special(subsystem->id, infoVec.data(), infoVec.size());
+  }
+
+  // Retrying by path only makes sense if something was passed in memory
+  if (!bResult && bAnyInMemory)
+  {
+    // Fall back to loading by path
+    for (size_t i = 0; i < urlCount; i++)
+      GAME_INFO[i]->GetPathStruct(infoVec[i]);
+
+    CTraceScope traceLoad("retro_load_game_special");
+    bResult = CLIENT->retro_load_game_special(subsystem->id, infoVec.data(), infoVec.size());
+  }
+
+  if (bResult)
+  {
+    InitializeGameLoop();
+
+    CInputManager::Get().OpenPort(0);
+
+    // TODO
+    CInputManager::Get().OpenPort(1);
+    CInputManager::Get().OpenPort(2);
+    CInputManager::Get().OpenPort(3);
+  }
+
+  return bResult ? GAME_ERROR_NO_ERROR : GAME_ERROR_FAILED;
 }
 
 GAME_ERROR LoadStandalone(void)
@@ -297,9 +540,13 @@ GAME_ERROR LoadStandalone(void)
   if (!CLIENT)
     return GAME_ERROR_FAILED;
 
+  CTraceScope trace("LoadStandalone");
+
   if (!CLIENT->retro_load_game(nullptr))
     return GAME_ERROR_FAILED;
 
+  InitializeGameLoop();
+
   CInputManager::Get().OpenPort(0);
 
   // TODO
@@ -314,12 +561,26 @@ GAME_ERROR UnloadGame(void)
 {
   GAME_ERROR error = GAME_ERROR_FAILED;
 
+  DeinitializeGameLoop();
+
   if (CLIENT)
   {
     CLIENT->retro_unload_game();
 
+    // The core may read the images until the game is unloaded
+    CDiskSwapper::Get().Deinitialize();
+
     CInputManager::Get().ClosePorts();
 
+    FlushContentCaches();
+
+    if (CSettings::Get().Tracing())
+      CTraceRecorder::Get().Write(CLibretroEnvironment::Get().GetProfileDirectory() + "/" TRACE_FILE_NAME);
+
+    // Start over to trace the next game's loading
+    CTraceRecorder::Get().Clear();
+    CTraceRecorder::Get().SetRecording(true);
+
     error = GAME_ERROR_NO_ERROR;
   }
 
@@ -337,7 +598,10 @@ GAME_ERROR GetGameInfo(game_system_av_info* info)
     return GAME_ERROR_INVALID_PARAMETERS;
 
   retro_system_av_info retro_info = { };
-  CLIENT->retro_get_system_av_info(&retro_info);
+  {
+    CLockObject lock(CEmulationThread::Get().CoreMutex());
+    CLIENT->retro_get_system_av_info(&retro_info);
+  }
 
   info->geometry.base_width   = retro_info.geometry.base_width;
   info->geometry.base_height  = retro_info.geometry.base_height;
@@ -374,7 +638,12 @@ GAME_ERROR RunFrame(void)
   if (!CLIENT)
     return GAME_ERROR_FAILED;
 
-  CLIENT->retro_run();
+  CTraceScope trace("RunFrame");
+
+  if (CEmulationThread::Get().IsEnabled())
+    CEmulationThread::Get().RunFrame();
+  else
+    RunGameFrame();
 
   return GAME_ERROR_NO_ERROR;
 }
@@ -384,6 +653,8 @@ GAME_ERROR Reset(void)
   if (!CLIENT)
     return GAME_ERROR_FAILED;
 
+  CLockObject lock(CEmulationThread::Get().CoreMutex());
+
   CLIENT->retro_reset();
 
   return GAME_ERROR_NO_ERROR;
@@ -410,9 +681,118 @@ GAME_ERROR AudioAvailable()
   if (!CLIENT_BRIDGE)
     return GAME_ERROR_FAILED;
 
+  CLockObject lock(CEmulationThread::Get().CoreMutex());
+
   return CLIENT_BRIDGE->AudioAvailable();
 }
 
+/*!
+ * \brief Step back through the rewind history
+ *
+ * The older state is restored on the next call to RunFrame().
+ *
+ * This function is not part of the Game API yet.
+ */
+GAME_ERROR RewindStepBack(unsigned int count)
+{
+  if (!CLIENT)
+    return GAME_ERROR_FAILED;
+
+  if (!CRewind::Get().IsEnabled())
+    return GAME_ERROR_NOT_IMPLEMENTED;
+
+  CRewind::Get().RequestStepBack(count);
+
+  return GAME_ERROR_NO_ERROR;
+}
+
+/*!
+ * \brief Start or stop hold-to-rewind
+ *
+ * While rewinding, every call to RunFrame() steps back one snapshot instead
+ * of advancing the game.
+ *
+ * This function is not part of the Game API yet.
+ */
+GAME_ERROR SetRewinding(bool rewinding)
+{
+  if (!CLIENT)
+    return GAME_ERROR_FAILED;
+
+  if (!CRewind::Get().IsEnabled())
+    return GAME_ERROR_NOT_IMPLEMENTED;
+
+  CRewind::Get().SetRewinding(rewinding);
+
+  return GAME_ERROR_NO_ERROR;
+}
+
+/*!
+ * \brief Start or stop fast-forwarding
+ *
+ * While fast-forwarding, every call to RunFrame() runs several frames and
+ * presents only the last one.
+ *
+ * This function is not part of the Game API yet.
+ */
+GAME_ERROR SetFastForward(bool fastForward)
+{
+  if (!CLIENT)
+    return GAME_ERROR_FAILED;
+
+  CFastForward::Get().SetEnabled(fastForward);
+
+  return GAME_ERROR_NO_ERROR;
+}
+
+/*!
+ * \brief Get the disc image that is inserted
+ *
+ * \param index  The zero-based index of the inserted image
+ * \param count  The number of images of the game
+ *
+ * This function is not part of the Game API yet.
+ */
+GAME_ERROR GetDiskIndex(unsigned int* index, unsigned int* count)
+{
+  if (!CLIENT)
+    return GAME_ERROR_FAILED;
+
+  if (index == nullptr || count == nullptr)
+    return GAME_ERROR_INVALID_PARAMETERS;
+
+  if (!CDiskSwapper::Get().IsEnabled())
+    return GAME_ERROR_NOT_IMPLEMENTED;
+
+  *index = CDiskSwapper::Get().GetImageIndex();
+  *count = CDiskSwapper::Get().GetImageCount();
+
+  return GAME_ERROR_NO_ERROR;
+}
+
+/*!
+ * \brief Swap to another disc image
+ *
+ * The disc is ejected, changed and inserted on the next call to RunFrame().
+ *
+ * This function is not part of the Game API yet.
+ */
+GAME_ERROR SetDiskIndex(unsigned int index)
+{
+  if (!CLIENT)
+    return GAME_ERROR_FAILED;
+
+  if (!CDiskSwapper::Get().IsEnabled())
+    return GAME_ERROR_NOT_IMPLEMENTED;
+
+  if (index >= CDiskSwapper::Get().GetImageCount())
+    return GAME_ERROR_INVALID_PARAMETERS;
+
+  CDiskSwapper::Get().RequestSwap(index);
+
+  return GAME_ERROR_NO_ERROR;
+}
+
 GAME_ERROR HwContextReset()
 {
   if (!CLIENT_BRIDGE)
@@ -437,6 +817,8 @@ void UpdatePort(int port, bool connected, const game_controller* controller)
       return;
   }
 
+  CLockObject lock(CEmulationThread::Get().CoreMutex());
+
   CInputManager::Get().DeviceConnected(port, connected, connected ? controller : nullptr);
 
   if (port >= GAME_INPUT_PORT_JOYSTICK_START)
@@ -469,6 +851,8 @@ size_t SerializeSize(void)
   if (!CLIENT)
     return 0;
 
+  CLockObject lock(CEmulationThread::Get().CoreMutex());
+
   return CLIENT->retro_serialize_size();
 }
 
@@ -480,6 +864,8 @@ GAME_ERROR Serialize(uint8_t* data, size_t size)
   if (data == nullptr)
     return GAME_ERROR_INVALID_PARAMETERS;
 
+  CLockObject lock(CEmulationThread::Get().CoreMutex());
+
   bool result = CLIENT->retro_serialize(data, size);
 
   return result ? GAME_ERROR_NO_ERROR : GAME_ERROR_FAILED;
@@ -493,6 +879,8 @@ GAME_ERROR Deserialize(const uint8_t* data, size_t size)
   if (data == nullptr)
     return GAME_ERROR_INVALID_PARAMETERS;
 
+  CLockObject lock(CEmulationThread::Get().CoreMutex());
+
   bool result = CLIENT->retro_unserialize(data, size);
 
   return result ? GAME_ERROR_NO_ERROR : GAME_ERROR_FAILED;
@@ -503,6 +891,8 @@ GAME_ERROR CheatReset(void)
   if (!CLIENT)
     return GAME_ERROR_FAILED;
 
+  CLockObject lock(CEmulationThread::Get().CoreMutex());
+
   CLIENT->retro_cheat_reset();
 
   return GAME_ERROR_NO_ERROR;
@@ -527,6 +917,8 @@ GAME_ERROR SetCheat(unsigned int index, bool enabled, const char* code)
   if (!CLIENT)
     return GAME_ERROR_FAILED;
 
+  CLockObject lock(CEmulationThread::Get().CoreMutex());
+
   CLIENT->retro_cheat_set(index, enabled, code);
 
   return GAME_ERROR_NO_ERROR;
@@ -0,0 +1,361 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "DiskSwapper.h"
+#include "GameInfoLoader.h"
+#include "libretro/ClientBridge.h"
+#include "libretro/libretro.h"
+#include "log/Log.h"
+#include "profiling/TraceRecorder.h"
+#include "utils/MemoryMappedFile.h"
+#include "utils/PathUtils.h"
+
+using namespace LIBRETRO;
+using namespace P8PLATFORM;
+
+#define NO_REQUEST    (-1)
+#define TOUCH_STRIDE  4096  // Read one byte per page
+
+CDiskSwapper::CDiskSwapper(void) :
+  m_bridge(nullptr),
+  m_xbmc(nullptr),
+  m_bSupportsVFS(false),
+  m_bAllowExtract(true),
+  m_imageCount(0),
+  m_imageIndex(0),
+  m_requestedIndex(NO_REQUEST),
+  m_loadedIndex(0),
+  m_prefetchIndex(0),
+  m_bPrefetchPending(false),
+  m_bLoading(false),
+  m_bPrefetched(false)
+{
+}
+
+CDiskSwapper& CDiskSwapper::Get(void)
+{
+  static CDiskSwapper _instance;
+  return _instance;
+}
+
+CDiskSwapper::~CDiskSwapper(void)
+{
+  Deinitialize();
+}
+
+bool CDiskSwapper::Initialize(CClientBridge* bridge,
+                              ADDON::CHelper_libXBMC_addon* xbmc,
+                              const std::vector<std::string>& images,
+                              bool bRegister,
+                              bool bSupportsVFS,
+                              bool bAllowExtract)
+{
+  Deinitialize();
+
+  if (bridge == nullptr || !bridge->HasDiskControl())
+  {
+    if (images.size() > 1)
+      isyslog("Disk control: Core can't swap discs, only the first of %u is available", static_cast<unsigned int>(images.size()));
+    return false;
+  }
+
+  m_xbmc = xbmc;
+  m_images = images;
+  m_bSupportsVFS = bSupportsVFS;
+  m_bAllowExtract = bAllowExtract;
+  m_requestedIndex = NO_REQUEST;
+
+  // The first image was loaded as the game, add the others by path. Cores
+  // that load from memory are given the image's data when it's inserted.
+  if (bRegister)
+  {
+    for (unsigned int i = bridge->GetNumImages(); i < m_images.size(); i++)
+    {
+      if (bridge->AddImageIndex() != GAME_ERROR_NO_ERROR)
+      {
+        esyslog("Disk control: Failed to add image %u", i);
+        break;
+      }
+
+      retro_game_info info = { };
+      info.path = m_images[i].c_str();
+      if (bridge->ReplaceImageIndex(i, &info) != GAME_ERROR_NO_ERROR)
+        esyslog("Disk control: Failed to set image %u: %s", i, m_images[i].c_str());
+    }
+  }
+
+  m_imageCount = bridge->GetNumImages();
+  m_imageIndex = bridge->GetImageIndex();
+
+  if (!CreateThread(false))
+  {
+    esyslog("Disk control: Failed to create prefetch thread");
+    return false;
+  }
+
+  m_bridge = bridge;
+
+  dsyslog("Disk control: Image %u of %u inserted", m_imageIndex + 1, static_cast<unsigned int>(m_imageCount));
+
+  Prefetch(m_imageIndex + 1);
+
+  return true;
+}
+
+void CDiskSwapper::Deinitialize(void)
+{
+  m_bridge = nullptr;
+
+  StopThread(-1);
+  m_prefetchEvent.Signal();
+  StopThread();
+
+  {
+    CLockObject lock(m_prefetchMutex);
+    m_bPrefetchPending = false;
+    m_bPrefetched = false;
+    m_prefetched.reset();
+  }
+
+  m_loadedImage.reset();
+  m_images.clear();
+  m_imageCount = 0;
+  m_imageIndex = 0;
+  m_requestedIndex = NO_REQUEST;
+}
+
+void CDiskSwapper::FrameStart(void)
+{
+  CClientBridge* bridge = m_bridge;
+  if (bridge == nullptr)
+    return;
+
+  const int requestedIndex = m_requestedIndex.exchange(NO_REQUEST);
+  if (requestedIndex != NO_REQUEST)
+    Swap(bridge, static_cast<unsigned int>(requestedIndex));
+
+  // The core may swap discs by itself
+  const unsigned int imageIndex = bridge->GetImageIndex();
+  if (imageIndex != m_imageIndex)
+  {
+    m_imageIndex = imageIndex;
+    Prefetch(imageIndex + 1);
+  }
+}
+
+void CDiskSwapper::Swap(CClientBridge* bridge, unsigned int index)
+{
+  if (index >= m_imageCount)
+  {
+    esyslog("Disk control: Invalid image %u, the game has %u", index + 1, static_cast<unsigned int>(m_imageCount));
+    return;
+  }
+
+  if (index == m_imageIndex && !bridge->GetEjectState())
+    return;
+
+  CTraceScope trace("CDiskSwapper::Swap");
+
+  if (bridge->SetEjectState(true) != GAME_ERROR_NO_ERROR)
+  {
+    esyslog("Disk control: Failed to eject image %u", m_imageIndex + 1);
+    return;
+  }
+
+  // Hand the prefetched image to the core, from memory or by the path of the
+  // staged copy
+  std::unique_ptr<CGameInfoLoader> image = TakeImage(index);
+  if (image)
+  {
+    retro_game_info info = { };
+    const bool bHasInfo = m_bSupportsVFS ? image->GetMemoryStruct(info) : image->GetPathStruct(info);
+    if (bHasInfo && bridge->ReplaceImageIndex(index, &info) == GAME_ERROR_NO_ERROR)
+    {
+      // Only the inserted image is kept in memory. The previous one is
+      // registered by path again so the core can't read the released buffer.
+      if (m_loadedImage && m_loadedIndex != index && m_bSupportsVFS)
+      {
+        retro_game_info pathInfo = { };
+        pathInfo.path = m_images[m_loadedIndex].c_str();
+        if (bridge->ReplaceImageIndex(m_loadedIndex, &pathInfo) != GAME_ERROR_NO_ERROR)
+          esyslog("Disk control: Failed to reset image %u", m_loadedIndex + 1);
+      }
+
+      m_loadedImage = std::move(image);
+      m_loadedIndex = index;
+    }
+  }
+
+  if (bridge->SetImageIndex(index) != GAME_ERROR_NO_ERROR)
+    esyslog("Disk control: Failed to select image %u", index + 1);
+
+  if (bridge->SetEjectState(false) != GAME_ERROR_NO_ERROR)
+    esyslog("Disk control: Failed to insert image %u", index + 1);
+
+  m_imageIndex = bridge->GetImageIndex();
+
+  isyslog("Disk control: Inserted image %u of %u", m_imageIndex + 1, static_cast<unsigned int>(m_imageCount));
+
+  Prefetch(m_imageIndex + 1);
+}
+
+void CDiskSwapper::Prefetch(unsigned int index)
+{
+  if (index >= m_images.size())
+    return;
+
+  {
+    CLockObject lock(m_prefetchMutex);
+
+    if (m_prefetchIndex == index && (m_bPrefetchPending || m_bLoading || m_bPrefetched))
+      return;
+
+    m_prefetched.reset();
+    m_bPrefetched = false;
+    m_prefetchIndex = index;
+    m_bPrefetchPending = true;
+  }
+
+  m_prefetchEvent.Signal();
+}
+
+std::unique_ptr<CGameInfoLoader> CDiskSwapper::TakeImage(unsigned int index)
+{
+  while (true)
+  {
+    {
+      CLockObject lock(m_prefetchMutex);
+
+      if (m_prefetchIndex != index)
+        break;
+
+      if (m_bPrefetched)
+      {
+        m_bPrefetched = false;
+        return std::move(m_prefetched);
+      }
+
+      if (!m_bLoading)
+      {
+        // Not started yet, load it here instead
+        m_bPrefetchPending = false;
+        break;
+      }
+    }
+
+    // The worker is loading this image
+    m_loadedEvent.Wait();
+  }
+
+  if (index >= m_images.size())
+    return nullptr;
+
+  // Cores that load by path read local images themselves
+  if (!m_bSupportsVFS && PathUtils::IsLocalPath(m_images[index]))
+    return nullptr;
+
+  dsyslog("Disk control: Image %u wasn't prefetched, loading it now", index + 1);
+
+  return LoadImage(index);
+}
+
+std::unique_ptr<CGameInfoLoader> CDiskSwapper::LoadImage(unsigned int index)
+{
+  CTraceScope trace("CDiskSwapper::LoadImage");
+
+  const std::string& path = m_images[index];
+
+  // Cores that load by path open local images themselves
+  if (!m_bSupportsVFS && PathUtils::IsLocalPath(path))
+  {
+    Touch(path);
+    return nullptr;
+  }
+
+  // Other images are staged for cores that load by path, in which case
+  // Load() returns false as nothing is held in memory
+  std::unique_ptr<CGameInfoLoader> image(new CGameInfoLoader(path.c_str(), m_xbmc, m_bSupportsVFS, m_bAllowExtract));
+  if (!image->Load() && m_bSupportsVFS)
+    return nullptr;
+
+  return image;
+}
+
+void CDiskSwapper::Touch(const std::string& path)
+{
+  CMemoryMappedFile file;
+  if (!file.Open(path))
+    return;
+
+  const volatile uint8_t* data = file.Data();
+
+  uint8_t sum = 0;
+  for (size_t offset = 0; offset < file.Size(); offset += TOUCH_STRIDE)
+    sum += data[offset];
+
+  (void)sum;
+}
+
+void* CDiskSwapper::Process(void)
+{
+  CTraceRecorder::Get().SetThreadName("Disk prefetch");
+
+  while (!IsStopped())
+  {
+    m_prefetchEvent.Wait();
+
+    if (IsStopped())
+      break;
+
+    unsigned int index;
+
+    {
+      CLockObject lock(m_prefetchMutex);
+
+      if (!m_bPrefetchPending)
+        continue;
+
+      index = m_prefetchIndex;
+      m_bPrefetchPending = false;
+      m_bLoading = true;
+    }
+
+    dsyslog("Disk control: Prefetching image %u: %s", index + 1, m_images[index].c_str());
+
+    std::unique_ptr<CGameInfoLoader> image = LoadImage(index);
+
+    {
+      CLockObject lock(m_prefetchMutex);
+
+      m_bLoading = false;
+
+      // Discard the image if another one was requested in the meantime
+      if (m_prefetchIndex == index)
+      {
+        m_prefetched = std::move(image);
+        m_bPrefetched = true;
+      }
+    }
+
+    m_loadedEvent.Signal();
+  }
+
+  return nullptr;
+}
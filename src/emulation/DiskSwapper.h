@@ -0,0 +1,160 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include "p8-platform/threads/mutex.h"
+#include "p8-platform/threads/threads.h"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ADDON { class CHelper_libXBMC_addon; }
+
+namespace LIBRETRO
+{
+  class CClientBridge;
+  class CGameInfoLoader;
+
+  /*!
+   * \brief Disc swapping for multi-disc games through the core's disk control
+   *        interface
+   *
+   * Discs listed in an M3U playlist are registered with the core after the
+   * first one is loaded, unless the core reads playlists itself. A swap is
+   * requested from any thread and performed on the emulation thread before
+   * the next frame.
+   *
+   * While a disc is in use, the next one is loaded by a worker thread. Cores
+   * that load from memory are given the prefetched buffer on the swap. For
+   * cores that load by path, a local image is only pulled into the page cache,
+   * so the core's own read doesn't stall the game, and an image outside the
+   * local filesystem is copied to the staging cache and replaced by the copy.
+   */
+  class CDiskSwapper : public P8PLATFORM::CThread
+  {
+  private:
+    CDiskSwapper(void);
+
+  public:
+    static CDiskSwapper& Get(void);
+
+    virtual ~CDiskSwapper(void);
+
+    /*!
+     * \brief Start managing the discs of the loaded game
+     *
+     * \param bridge          The core's callbacks
+     * \param images          The images from the playlist, or empty
+     * \param bRegister       True to register the images after the first with
+     *                        the core, false if the core read the playlist
+     * \param bSupportsVFS    True if the core accepts images in memory
+     * \param bAllowExtract   False if archives must be passed as they are
+     *
+     * \return True if the core supports disk control
+     */
+    bool Initialize(CClientBridge* bridge,
+                    ADDON::CHelper_libXBMC_addon* xbmc,
+                    const std::vector<std::string>& images,
+                    bool bRegister,
+                    bool bSupportsVFS,
+                    bool bAllowExtract);
+
+    /*!
+     * \brief Stop prefetching and release the images
+     *
+     * Must be called after the game is unloaded, as the core may read the
+     * images until then.
+     */
+    void Deinitialize(void);
+
+    bool IsEnabled(void) const { return m_bridge != nullptr; }
+
+    unsigned int GetImageCount(void) const { return m_imageCount; }
+    unsigned int GetImageIndex(void) const { return m_imageIndex; }
+
+    /*!
+     * \brief Swap to another disc on the next frame
+     *
+     * Can be called from any thread.
+     */
+    void RequestSwap(unsigned int index) { m_requestedIndex = static_cast<int>(index); }
+
+    /*!
+     * \brief Perform a requested swap
+     *
+     * Called on the emulation thread before every frame.
+     */
+    void FrameStart(void);
+
+  protected:
+    // implementation of CThread
+    virtual void* Process(void) override;
+
+  private:
+    void Swap(CClientBridge* bridge, unsigned int index);
+
+    /*!
+     * \brief Load an image on the worker thread
+     */
+    void Prefetch(unsigned int index);
+
+    /*!
+     * \brief Get the loader for an image, waiting for the worker or loading
+     *        it on this thread if it hasn't been prefetched
+     */
+    std::unique_ptr<CGameInfoLoader> TakeImage(unsigned int index);
+
+    std::unique_ptr<CGameInfoLoader> LoadImage(unsigned int index);
+
+    /*!
+     * \brief Read a local file so that it's in the page cache when the core
+     *        opens it
+     */
+    static void Touch(const std::string& path);
+
+    // Construction parameters
+    std::atomic<CClientBridge*>   m_bridge; // Read from any thread
+    ADDON::CHelper_libXBMC_addon* m_xbmc;
+    std::vector<std::string>      m_images;
+    bool                          m_bSupportsVFS;
+    bool                          m_bAllowExtract;
+
+    // State of the core's disc tray, readable from any thread
+    std::atomic<unsigned int> m_imageCount;
+    std::atomic<unsigned int> m_imageIndex;
+    std::atomic<int>          m_requestedIndex; // -1 if no swap is requested
+
+    // Image given to the core on the last swap, emulation thread only
+    std::unique_ptr<CGameInfoLoader> m_loadedImage;
+    unsigned int                     m_loadedIndex;
+
+    // Prefetch, protected by m_prefetchMutex
+    P8PLATFORM::CEvent               m_prefetchEvent; // Signaled when a prefetch is requested
+    P8PLATFORM::CEvent               m_loadedEvent;   // Signaled when the worker finishes loading
+    P8PLATFORM::CMutex               m_prefetchMutex;
+    unsigned int                     m_prefetchIndex;
+    bool                             m_bPrefetchPending;
+    bool                             m_bLoading;
+    bool                             m_bPrefetched;
+    std::unique_ptr<CGameInfoLoader> m_prefetched;
+  };
+}
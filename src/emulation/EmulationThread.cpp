@@ -0,0 +1,145 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "EmulationThread.h"
+#include "libretro/ClientBridge.h"
+#include "libretro/LibretroEnvironment.h"
+#include "log/Log.h"
+#include "profiling/FrameProfiler.h"
+#include "profiling/TraceRecorder.h"
+#include "utils/CPUFeatures.h"
+
+using namespace LIBRETRO;
+using namespace P8PLATFORM;
+
+// Frames requested but not yet emulated. Keeps the emulation thread from
+// running away from the frontend, which would add latency.
+#define MAX_FRAMES_IN_FLIGHT  2
+
+CEmulationThread::CEmulationThread(void) :
+  m_bEnabled(false),
+  m_framesRequested(0)
+{
+}
+
+CEmulationThread& CEmulationThread::Get(void)
+{
+  static CEmulationThread _instance;
+  return _instance;
+}
+
+CEmulationThread::~CEmulationThread(void)
+{
+  Deinitialize();
+}
+
+bool CEmulationThread::Initialize(const std::function<void()>& runFrame)
+{
+  Deinitialize();
+
+  CClientBridge* clientBridge = CLibretroEnvironment::Get().GetClientBridge();
+  if (clientBridge != nullptr && clientBridge->HasHwContext())
+  {
+    isyslog("Emulation thread: Core uses hardware rendering, running on the frontend's thread");
+    return false;
+  }
+
+  m_runFrame = runFrame;
+  m_framesRequested = 0;
+
+  CLibretroEnvironment::Get().Video().SetQueued(true);
+  CLibretroEnvironment::Get().Audio().SetQueued(true);
+
+  if (!CreateThread(false))
+  {
+    esyslog("Emulation thread: Failed to create thread");
+    CLibretroEnvironment::Get().Video().SetQueued(false);
+    CLibretroEnvironment::Get().Audio().SetQueued(false);
+    return false;
+  }
+
+  m_bEnabled = true;
+
+  dsyslog("Emulation thread: Started");
+
+  return true;
+}
+
+void CEmulationThread::Deinitialize(void)
+{
+  if (!m_bEnabled)
+    return;
+
+  StopThread(-1);
+  m_frameEvent.Signal();
+  StopThread();
+
+  m_bEnabled = false;
+  m_runFrame = nullptr;
+
+  CLibretroEnvironment::Get().Video().SetQueued(false);
+  CLibretroEnvironment::Get().Audio().SetQueued(false);
+
+  dsyslog("Emulation thread: Stopped");
+}
+
+void CEmulationThread::RunFrame(void)
+{
+  if (m_framesRequested < MAX_FRAMES_IN_FLIGHT)
+  {
+    m_framesRequested++;
+    m_frameEvent.Signal();
+  }
+
+  CTraceScope trace("Flush");
+
+  CFrameProfiler& profiler = CFrameProfiler::Get();
+  const uint64_t flushStart = profiler.IsEnabled() ? CPUFeatures::GetCycleCount() : 0;
+
+  CLibretroEnvironment::Get().Video().Flush();
+  CLibretroEnvironment::Get().Audio().Flush();
+
+  if (flushStart != 0)
+    profiler.Record(PROFILE_PHASE_FLUSH, CPUFeatures::GetCycleCount() - flushStart);
+}
+
+void* CEmulationThread::Process(void)
+{
+  CTraceRecorder::Get().SetThreadName("Emulation");
+
+  while (!IsStopped())
+  {
+    m_frameEvent.Wait();
+
+    while (m_framesRequested > 0 && !IsStopped())
+    {
+      {
+        CLockObject lock(m_coreMutex);
+
+        m_runFrame();
+        CLibretroEnvironment::Get().Audio().EndFrame();
+      }
+
+      m_framesRequested--;
+    }
+  }
+
+  return nullptr;
+}
@@ -0,0 +1,91 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include "p8-platform/threads/mutex.h"
+#include "p8-platform/threads/threads.h"
+
+#include <atomic>
+#include <functional>
+
+namespace LIBRETRO
+{
+  /*!
+   * \brief Runs the core on its own thread
+   *
+   * Each call to RunFrame() from the frontend requests a frame from the
+   * emulation thread and sends the video and audio it has finished so far.
+   * A/V is queued by CVideoStream and CAudioStream in lock-free rings, so
+   * slow calls into the frontend don't stall emulation.
+   *
+   * Because a frame is presented on the call after it was requested, this
+   * adds a frame of latency in exchange for overlapping emulation with the
+   * frontend's rendering.
+   *
+   * Cores using hardware rendering must stay on the frontend's thread, which
+   * owns the GL context.
+   */
+  class CEmulationThread : public P8PLATFORM::CThread
+  {
+  private:
+    CEmulationThread(void);
+
+  public:
+    static CEmulationThread& Get(void);
+
+    virtual ~CEmulationThread(void);
+
+    /*!
+     * \brief Start the emulation thread
+     *
+     * \param runFrame  Function that advances the game by one frame
+     *
+     * \return True if the thread was started
+     */
+    bool Initialize(const std::function<void()>& runFrame);
+
+    void Deinitialize(void);
+
+    bool IsEnabled(void) const { return m_bEnabled; }
+
+    /*!
+     * \brief Request a frame and send finished A/V to the frontend
+     */
+    void RunFrame(void);
+
+    /*!
+     * \brief Held while the core runs a frame
+     *
+     * Other threads calling into the core must hold this lock.
+     */
+    P8PLATFORM::CMutex& CoreMutex(void) { return m_coreMutex; }
+
+  protected:
+    // implementation of CThread
+    virtual void* Process(void) override;
+
+  private:
+    std::function<void()>     m_runFrame;
+    bool                      m_bEnabled;
+    std::atomic<unsigned int> m_framesRequested;
+    P8PLATFORM::CEvent        m_frameEvent;
+    P8PLATFORM::CMutex        m_coreMutex;
+  };
+}
@@ -0,0 +1,105 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "FastForward.h"
+#include "libretro/LibretroEnvironment.h"
+
+#include <chrono>
+
+using namespace LIBRETRO;
+
+// Fraction of the frontend's frame period spent emulating when unbounded,
+// the rest is left for the frontend
+#define UNBOUNDED_BUDGET  0.8
+
+// Fallback when the core hasn't reported its frame rate
+#define DEFAULT_FPS  60.0
+
+// Weight of the newest sample in the average frame cost
+#define AVERAGE_WEIGHT  0.1
+
+CFastForward::CFastForward(void) :
+  m_ratio(4),
+  m_bEnabled(false),
+  m_averageFrameUs(0.0)
+{
+}
+
+CFastForward& CFastForward::Get(void)
+{
+  static CFastForward _instance;
+  return _instance;
+}
+
+unsigned int CFastForward::RunFrame(const std::function<void()>& runFrame)
+{
+  typedef std::chrono::steady_clock clock;
+
+  CVideoStream& video = CLibretroEnvironment::Get().Video();
+  CAudioStream& audio = CLibretroEnvironment::Get().Audio();
+
+  const unsigned int ratio = m_ratio;
+
+  double fps = CLibretroEnvironment::Get().GetSystemInfo().timing.fps;
+  if (fps <= 0.0)
+    fps = DEFAULT_FPS;
+
+  const double budgetUs = UNBOUNDED_BUDGET * 1000000.0 / fps;
+  const clock::time_point start = clock::now();
+
+  unsigned int frameCount = 0;
+
+  video.SetMuted(true);
+  audio.SetMuted(true);
+
+  while (true)
+  {
+    // Stop one frame early so the last frame can be presented
+    bool bLastFrame;
+    if (ratio > 0)
+    {
+      bLastFrame = (frameCount + 1 >= ratio);
+    }
+    else
+    {
+      const double elapsedUs = std::chrono::duration<double, std::micro>(clock::now() - start).count();
+      bLastFrame = (elapsedUs + 2 * m_averageFrameUs >= budgetUs);
+    }
+
+    if (bLastFrame)
+    {
+      video.SetMuted(false);
+      audio.SetMuted(false);
+    }
+
+    const clock::time_point frameStart = clock::now();
+    runFrame();
+    const double frameUs = std::chrono::duration<double, std::micro>(clock::now() - frameStart).count();
+
+    m_averageFrameUs = m_averageFrameUs > 0.0 ? m_averageFrameUs + AVERAGE_WEIGHT * (frameUs - m_averageFrameUs) : frameUs;
+
+    frameCount++;
+
+    if (bLastFrame)
+      break;
+  }
+
+  return frameCount;
+}
@@ -0,0 +1,72 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <atomic>
+#include <functional>
+
+namespace LIBRETRO
+{
+  /*!
+   * \brief Runs several core frames per frontend frame
+   *
+   * Only the last frame is presented. The video of the other frames is
+   * dropped before it is copied, and their audio is dropped as well, so the
+   * frontend receives one frame of video and audio per call regardless of
+   * the speed.
+   *
+   * With a ratio of 0 (unbounded), frames are run until the frontend's frame
+   * period is used up.
+   */
+  class CFastForward
+  {
+  private:
+    CFastForward(void);
+
+  public:
+    static CFastForward& Get(void);
+
+    /*!
+     * \brief Set the number of core frames per frontend frame, 0 for unbounded
+     */
+    void SetRatio(unsigned int ratio) { m_ratio = ratio; }
+    unsigned int GetRatio(void) const { return m_ratio; }
+
+    /*!
+     * \brief Start or stop fast-forwarding. Can be called from any thread.
+     */
+    void SetEnabled(bool bEnabled) { m_bEnabled = bEnabled; }
+    bool IsEnabled(void) const { return m_bEnabled; }
+
+    /*!
+     * \brief Run the frames for one frontend frame
+     *
+     * \param runFrame  Function that advances the game by one frame
+     *
+     * \return The number of frames run
+     */
+    unsigned int RunFrame(const std::function<void()>& runFrame);
+
+  private:
+    std::atomic<unsigned int> m_ratio;
+    std::atomic<bool>         m_bEnabled;
+    double                    m_averageFrameUs; // Cost of one core frame
+  };
+}
@@ -0,0 +1,72 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "FrameClock.h"
+#include "utils/TimeUtils.h"
+
+using namespace LIBRETRO;
+
+// Longer intervals are pauses (menus, loading) rather than slow frames and
+// are reported as the reference frame time
+#define MAX_REFERENCE_FRAMES  8
+
+CFrameClock::CFrameClock(void) :
+  m_lastFrameUsec(0),
+  m_frameTimeUsec(0),
+  m_bHasFrameTime(false)
+{
+}
+
+CFrameClock& CFrameClock::Get(void)
+{
+  static CFrameClock _instance;
+  return _instance;
+}
+
+void CFrameClock::Reset(void)
+{
+  m_lastFrameUsec = 0;
+  m_frameTimeUsec = 0;
+  m_bHasFrameTime = false;
+}
+
+void CFrameClock::FrameStart(bool bRealTime)
+{
+  const int64_t now = TimeUtils::GetTimeUsec();
+
+  m_bHasFrameTime = (bRealTime && m_lastFrameUsec != 0);
+  m_frameTimeUsec = now - m_lastFrameUsec;
+  m_lastFrameUsec = now;
+}
+
+int64_t CFrameClock::NextFrameTime(int64_t reference)
+{
+  int64_t frameTime = reference;
+
+  if (m_bHasFrameTime)
+  {
+    m_bHasFrameTime = false;
+
+    if (m_frameTimeUsec > 0 && (reference <= 0 || m_frameTimeUsec <= MAX_REFERENCE_FRAMES * reference))
+      frameTime = m_frameTimeUsec;
+  }
+
+  return frameTime;
+}
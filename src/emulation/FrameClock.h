@@ -0,0 +1,70 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <stdint.h>
+
+namespace LIBRETRO
+{
+  /*!
+   * \brief Measures the time between frontend frames for the core's frame
+   *        time callback
+   *
+   * The first core frame run for a frontend frame is given the real time
+   * since the previous frontend frame. Any further core frames in the same
+   * frontend frame (fast-forward, run-ahead) are given the core's reference
+   * frame time, as are frames that aren't run in real time (rewinding).
+   */
+  class CFrameClock
+  {
+  private:
+    CFrameClock(void);
+
+  public:
+    static CFrameClock& Get(void);
+
+    /*!
+     * \brief Forget the previous frame, e.g. when a game is loaded
+     */
+    void Reset(void);
+
+    /*!
+     * \brief Called once at the start of each frontend frame
+     *
+     * \param bRealTime  False if the frames are not run in real time, in
+     *                   which case all of them report the reference time
+     */
+    void FrameStart(bool bRealTime);
+
+    /*!
+     * \brief Get the time to report for the next core frame
+     *
+     * \param reference  The core's reference frame time, in microseconds
+     *
+     * \return The frame time, in microseconds
+     */
+    int64_t NextFrameTime(int64_t reference);
+
+  private:
+    int64_t m_lastFrameUsec;
+    int64_t m_frameTimeUsec;
+    bool    m_bHasFrameTime;
+  };
+}
@@ -0,0 +1,269 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "Rewind.h"
+#include "libretro/LibretroDLL.h"
+#include "log/Log.h"
+#include "utils/DeltaCodec.h"
+
+#include <algorithm>
+
+using namespace LIBRETRO;
+using namespace P8PLATFORM;
+
+CRewind::CRewind(void) :
+  m_client(nullptr),
+  m_interval(1),
+  m_frameCounter(0),
+  m_bRewinding(false),
+  m_stepsRequested(0),
+  m_bPending(false),
+  m_historySize(0)
+{
+}
+
+CRewind& CRewind::Get(void)
+{
+  static CRewind _instance;
+  return _instance;
+}
+
+CRewind::~CRewind(void)
+{
+  Deinitialize();
+}
+
+bool CRewind::Initialize(CLibretroDLL* client, unsigned int interval, size_t maxBytes)
+{
+  Deinitialize();
+
+  if (client == nullptr || maxBytes == 0)
+    return false;
+
+  if (client->retro_serialize_size() == 0)
+  {
+    isyslog("Rewind: Core doesn't support serialization, rewind is disabled");
+    return false;
+  }
+
+  m_interval = interval > 0 ? interval : 1;
+  m_frameCounter = 0;
+  m_bRewinding = false;
+  m_stepsRequested = 0;
+  m_bPending = false;
+
+  {
+    CLockObject lock(m_historyMutex);
+
+    m_currentState.clear();
+    m_deltas.clear();
+    m_history.reset(new uint8_t[maxBytes]);
+    m_historySize = maxBytes;
+  }
+
+  if (!CreateThread(false))
+  {
+    esyslog("Rewind: Failed to create worker thread");
+    return false;
+  }
+
+  m_client = client;
+
+  dsyslog("Rewind: Capturing every %u frame(s) into %u KB of history", m_interval, static_cast<unsigned int>(maxBytes / 1024));
+
+  return true;
+}
+
+void CRewind::Deinitialize(void)
+{
+  m_client = nullptr;
+
+  StopThread(-1);
+  m_captureEvent.Signal();
+  StopThread();
+
+  CLockObject lock(m_historyMutex);
+
+  m_pendingState.clear();
+  m_currentState.clear();
+  m_deltas.clear();
+  m_deltaBuffer.clear();
+  m_history.reset();
+  m_historySize = 0;
+  m_bPending = false;
+}
+
+void CRewind::FrameEnd(void)
+{
+  if (m_client == nullptr)
+    return;
+
+  if (++m_frameCounter < m_interval)
+    return;
+
+  // Skip the capture while the previous one is being compressed
+  if (m_bPending)
+    return;
+
+  m_frameCounter = 0;
+
+  // The pending state belongs to this thread until m_bPending is set
+  const size_t stateSize = m_client->retro_serialize_size();
+  if (stateSize == 0)
+    return;
+
+  m_pendingState.resize(stateSize);
+  if (!m_client->retro_serialize(m_pendingState.data(), m_pendingState.size()))
+    return;
+
+  m_bPending = true;
+  m_captureEvent.Signal();
+}
+
+bool CRewind::Rewind(void)
+{
+  if (m_client == nullptr)
+    return false;
+
+  unsigned int count = m_stepsRequested.exchange(0);
+  if (m_bRewinding && count == 0)
+    count = 1;
+
+  if (count == 0)
+    return false;
+
+  m_frameCounter = 0;
+
+  return StepBack(count) > 0;
+}
+
+unsigned int CRewind::StepBack(unsigned int count)
+{
+  if (m_client == nullptr)
+    return 0;
+
+  CLockObject lock(m_historyMutex);
+
+  // The latest capture may not have reached the worker yet
+  if (m_bPending)
+  {
+    CompressPending();
+    m_bPending = false;
+  }
+
+  unsigned int stepped = 0;
+  while (stepped < count && !m_deltas.empty())
+  {
+    const Delta& delta = m_deltas.back();
+    if (!DeltaCodec::Apply(m_history.get() + delta.offset, delta.size, m_currentState.data(), m_currentState.size()))
+    {
+      esyslog("Rewind: Corrupt delta, clearing history");
+      m_deltas.clear();
+      break;
+    }
+    m_deltas.pop_back();
+    stepped++;
+  }
+
+  if (stepped > 0)
+  {
+    if (!m_client->retro_unserialize(m_currentState.data(), m_currentState.size()))
+      esyslog("Rewind: Failed to restore state");
+  }
+
+  return stepped;
+}
+
+unsigned int CRewind::GetHistoryLength(void)
+{
+  CLockObject lock(m_historyMutex);
+  return static_cast<unsigned int>(m_deltas.size());
+}
+
+void* CRewind::Process(void)
+{
+  while (!IsStopped())
+  {
+    m_captureEvent.Wait();
+
+    if (IsStopped())
+      break;
+
+    CLockObject lock(m_historyMutex);
+
+    if (m_bPending)
+    {
+      CompressPending();
+      m_bPending = false;
+    }
+  }
+
+  return nullptr;
+}
+
+void CRewind::CompressPending(void)
+{
+  // Start over if this is the first state or the core changed its state size
+  if (m_currentState.empty() || m_currentState.size() != m_pendingState.size())
+  {
+    m_deltas.clear();
+    m_currentState.swap(m_pendingState);
+    return;
+  }
+
+  DeltaCodec::Encode(m_currentState.data(), m_pendingState.data(), m_currentState.size(), m_deltaBuffer);
+  PushDelta(m_deltaBuffer);
+
+  m_currentState.swap(m_pendingState);
+}
+
+void CRewind::PushDelta(const std::vector<uint8_t>& delta)
+{
+  // A delta larger than the whole budget can't be stored, and the older
+  // deltas can't be reached without it
+  if (delta.size() > m_historySize)
+  {
+    m_deltas.clear();
+    return;
+  }
+
+  size_t offset = m_deltas.empty() ? 0 : m_deltas.back().offset + m_deltas.back().size;
+
+  if (offset + delta.size() > m_historySize)
+  {
+    // Wrap around. Deltas stored past the newest one are the oldest.
+    while (!m_deltas.empty() && m_deltas.front().offset >= offset)
+      m_deltas.pop_front();
+    offset = 0;
+  }
+
+  // Overwrite the oldest deltas
+  while (!m_deltas.empty() &&
+         m_deltas.front().offset < offset + delta.size() &&
+         offset < m_deltas.front().offset + m_deltas.front().size)
+  {
+    m_deltas.pop_front();
+  }
+
+  std::copy(delta.begin(), delta.end(), m_history.get() + offset);
+
+  Delta entry = { offset, delta.size() };
+  m_deltas.push_back(entry);
+}
@@ -0,0 +1,159 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include "p8-platform/threads/mutex.h"
+#include "p8-platform/threads/threads.h"
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace LIBRETRO
+{
+  class CLibretroDLL;
+
+  /*!
+   * \brief Rewind history built on retro_serialize()
+   *
+   * Every N frames the core is serialized on the emulation thread. The state is
+   * handed to a worker thread, which XORs it against the previously captured
+   * state and stores the run-length compressed delta in a fixed-size ring. The
+   * newest state is kept uncompressed, and stepping back applies the newest
+   * delta to it. When the ring is full, the oldest deltas are overwritten.
+   *
+   * If the worker is still busy when a new state is due, the capture is
+   * skipped so that RunFrame() never waits on compression.
+   */
+  class CRewind : public P8PLATFORM::CThread
+  {
+  private:
+    CRewind(void);
+
+  public:
+    static CRewind& Get(void);
+
+    virtual ~CRewind(void);
+
+    /*!
+     * \brief Start capturing states of the loaded game
+     *
+     * \param client     The libretro core
+     * \param interval   Number of frames between captures
+     * \param maxBytes   Memory budget for the compressed history
+     *
+     * \return True if the core can be rewound and the worker was started
+     */
+    bool Initialize(CLibretroDLL* client, unsigned int interval, size_t maxBytes);
+
+    void Deinitialize(void);
+
+    bool IsEnabled(void) const { return m_client != nullptr; }
+
+    /*!
+     * \brief Capture the core's state if one is due
+     *
+     * Called on the emulation thread after every frame.
+     */
+    void FrameEnd(void);
+
+    /*!
+     * \brief Restore an older state
+     *
+     * \param count  The number of captures to step back
+     *
+     * \return The number of captures actually stepped back
+     */
+    unsigned int StepBack(unsigned int count);
+
+    /*!
+     * \brief Enable or disable hold-to-rewind
+     *
+     * While rewinding, each frame steps back one capture instead of moving
+     * the game forward.
+     */
+    void SetRewinding(bool bRewinding) { m_bRewinding = bRewinding; }
+
+    /*!
+     * \brief Step back on the next frame
+     *
+     * Can be called from any thread. The state is restored by Rewind() on the
+     * emulation thread.
+     */
+    void RequestStepBack(unsigned int count) { m_stepsRequested += count; }
+
+    /*!
+     * \brief True if the next frame should be rewound instead of captured
+     */
+    bool IsRewinding(void) const { return m_bRewinding || m_stepsRequested > 0; }
+
+    /*!
+     * \brief Restore the state for this frame when rewinding
+     *
+     * \return True if an older state was restored, false if the start of the
+     *         history has been reached
+     */
+    bool Rewind(void);
+
+    /*!
+     * \brief Number of captures that can be stepped back
+     */
+    unsigned int GetHistoryLength(void);
+
+  protected:
+    // implementation of CThread
+    virtual void* Process(void) override;
+
+  private:
+    struct Delta
+    {
+      size_t offset;
+      size_t size;
+    };
+
+    void CompressPending(void);
+    void PushDelta(const std::vector<uint8_t>& delta);
+
+    // Construction parameters
+    CLibretroDLL* m_client;
+    unsigned int  m_interval;
+
+    // Emulation thread
+    unsigned int              m_frameCounter;
+    std::atomic<bool>         m_bRewinding;
+    std::atomic<unsigned int> m_stepsRequested;
+
+    // Hand-off between threads
+    P8PLATFORM::CEvent   m_captureEvent;
+    std::atomic<bool>    m_bPending;
+    std::vector<uint8_t> m_pendingState;
+
+    // History, protected by m_historyMutex
+    std::vector<uint8_t>       m_currentState;
+    std::unique_ptr<uint8_t[]> m_history;
+    size_t                     m_historySize;
+    std::deque<Delta>          m_deltas;
+    std::vector<uint8_t>       m_deltaBuffer;
+    P8PLATFORM::CMutex         m_historyMutex;
+  };
+}
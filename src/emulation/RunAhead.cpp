@@ -0,0 +1,114 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "RunAhead.h"
+#include "libretro/LibretroDLL.h"
+#include "libretro/LibretroEnvironment.h"
+#include "log/Log.h"
+
+using namespace LIBRETRO;
+
+CRunAhead::CRunAhead(void) :
+  m_client(nullptr),
+  m_frames(0)
+{
+}
+
+CRunAhead& CRunAhead::Get(void)
+{
+  static CRunAhead _instance;
+  return _instance;
+}
+
+bool CRunAhead::Initialize(CLibretroDLL* client, unsigned int frames)
+{
+  Deinitialize();
+
+  if (client == nullptr || frames == 0)
+    return false;
+
+  const size_t stateSize = client->retro_serialize_size();
+  if (stateSize == 0)
+  {
+    isyslog("Run-ahead: Core doesn't support serialization, run-ahead is disabled");
+    return false;
+  }
+
+  m_client = client;
+  m_frames = frames;
+  m_state.resize(stateSize);
+
+  dsyslog("Run-ahead: Running %u frame(s) ahead", m_frames);
+
+  return true;
+}
+
+void CRunAhead::Deinitialize(void)
+{
+  m_client = nullptr;
+  m_frames = 0;
+  m_state.clear();
+  m_state.shrink_to_fit();
+}
+
+bool CRunAhead::RunFrame(const std::function<void()>& runFrame)
+{
+  if (m_client == nullptr)
+    return false;
+
+  CVideoStream& video = CLibretroEnvironment::Get().Video();
+  CAudioStream& audio = CLibretroEnvironment::Get().Audio();
+
+  // Advance the game. Its video is superseded by the speculative frames.
+  video.SetMuted(true);
+  runFrame();
+
+  // The state size may change during the first frames of some cores
+  const size_t stateSize = m_client->retro_serialize_size();
+  if (stateSize > m_state.size())
+    m_state.resize(stateSize);
+
+  if (stateSize == 0 || !m_client->retro_serialize(m_state.data(), stateSize))
+  {
+    esyslog("Run-ahead: Failed to serialize core, run-ahead is disabled");
+    video.SetMuted(false);
+    Deinitialize();
+    return false;
+  }
+
+  // Run ahead, only presenting the last frame
+  audio.SetMuted(true);
+  for (unsigned int i = 0; i < m_frames; i++)
+  {
+    video.SetMuted(i + 1 < m_frames);
+    runFrame();
+  }
+  video.SetMuted(false);
+  audio.SetMuted(false);
+
+  if (!m_client->retro_unserialize(m_state.data(), stateSize))
+  {
+    esyslog("Run-ahead: Failed to restore state, run-ahead is disabled");
+    Deinitialize();
+    return false;
+  }
+
+  return true;
+}
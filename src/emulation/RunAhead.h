@@ -0,0 +1,81 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <functional>
+#include <stdint.h>
+#include <vector>
+
+namespace LIBRETRO
+{
+  class CLibretroDLL;
+
+  /*!
+   * \brief Hides a game's internal input lag by presenting frames from the future
+   *
+   * Every frame, the core is advanced by one frame without presenting video
+   * and its state is saved. It is then run ahead the configured number of
+   * frames with the latest input, and the last of these frames is presented.
+   * Finally, the saved state is restored so the speculative frames never
+   * become part of the game.
+   *
+   * The audio of the real frame is kept, the audio of the speculative frames
+   * is dropped.
+   */
+  class CRunAhead
+  {
+  private:
+    CRunAhead(void);
+
+  public:
+    static CRunAhead& Get(void);
+
+    /*!
+     * \brief Enable run-ahead for the loaded game
+     *
+     * \param client  The libretro core
+     * \param frames  Number of frames to run ahead, 0 to disable
+     *
+     * \return True if run-ahead is enabled
+     */
+    bool Initialize(CLibretroDLL* client, unsigned int frames);
+
+    void Deinitialize(void);
+
+    bool IsEnabled(void) const { return m_client != nullptr; }
+
+    /*!
+     * \brief Advance the game by one frame and present a frame from the future
+     *
+     * The game is advanced even if this fails.
+     *
+     * \param runFrame  Function that runs the core for one frame
+     *
+     * \return False if the core can't be serialized, in which case run-ahead
+     *         is disabled
+     */
+    bool RunFrame(const std::function<void()>& runFrame);
+
+  private:
+    CLibretroDLL*        m_client;
+    unsigned int         m_frames;
+    std::vector<uint8_t> m_state; // Grows to the largest state, never shrinks
+  };
+}
@@ -0,0 +1,165 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "ButtonMapIndex.h"
+#include "libretro/libretro.h"
+
+#include <string.h>
+#include <utility>
+
+using namespace LIBRETRO;
+
+#define INITIAL_CAPACITY  64
+
+CButtonMapIndex::CButtonMapIndex(void) :
+  m_entryCount(0)
+{
+}
+
+void CButtonMapIndex::Clear(void)
+{
+  m_controllers.clear();
+  m_controllerIds.clear();
+  m_entries.clear();
+  m_entryCount = 0;
+}
+
+bool CButtonMapIndex::AddController(const std::string& controllerId, libretro_device_t type)
+{
+  if (HasController(controllerId))
+    return false;
+
+  m_controllerIds[controllerId] = static_cast<unsigned int>(m_controllers.size());
+
+  Controller controller = { controllerId, type };
+  m_controllers.push_back(std::move(controller));
+
+  return true;
+}
+
+void CButtonMapIndex::AddFeature(const std::string& controllerId, const std::string& featureName, int libretroIndex)
+{
+  auto itController = m_controllerIds.find(controllerId);
+  if (itController == m_controllerIds.end())
+    return;
+
+  // Keep the table at most half full so that probe sequences stay short
+  if ((m_entryCount + 1) * 2 > m_entries.size())
+    Grow();
+
+  const uint32_t hash = Hash(controllerId.c_str(), featureName.c_str());
+  const size_t mask = m_entries.size() - 1;
+
+  for (size_t slot = hash & mask; ; slot = (slot + 1) & mask)
+  {
+    Entry& entry = m_entries[slot];
+    if (!entry.bUsed)
+    {
+      entry.hash = hash;
+      entry.controller = itController->second;
+      entry.featureName = featureName;
+      entry.mapping.libretroIndex = libretroIndex;
+      entry.mapping.type = m_controllers[itController->second].type;
+      entry.bUsed = true;
+      m_entryCount++;
+      break;
+    }
+
+    // Already mapped
+    if (entry.hash == hash && entry.controller == itController->second && entry.featureName == featureName)
+      break;
+  }
+}
+
+bool CButtonMapIndex::HasController(const std::string& controllerId) const
+{
+  return m_controllerIds.find(controllerId) != m_controllerIds.end();
+}
+
+libretro_device_t CButtonMapIndex::GetType(const std::string& controllerId) const
+{
+  auto it = m_controllerIds.find(controllerId);
+  if (it != m_controllerIds.end())
+    return m_controllers[it->second].type;
+
+  return RETRO_DEVICE_NONE;
+}
+
+const CButtonMapIndex::Mapping* CButtonMapIndex::Find(const char* controllerId, const char* featureName) const
+{
+  if (m_entries.empty())
+    return nullptr;
+
+  const uint32_t hash = Hash(controllerId, featureName);
+  const size_t mask = m_entries.size() - 1;
+
+  for (size_t slot = hash & mask; m_entries[slot].bUsed; slot = (slot + 1) & mask)
+  {
+    const Entry& entry = m_entries[slot];
+    if (entry.hash == hash &&
+        entry.featureName == featureName &&
+        strcmp(m_controllers[entry.controller].controllerId.c_str(), controllerId) == 0)
+    {
+      return &entry.mapping;
+    }
+  }
+
+  return nullptr;
+}
+
+uint32_t CButtonMapIndex::Hash(const char* controllerId, const char* featureName)
+{
+  // 32-bit FNV-1a over both strings, separated by their terminators
+  uint32_t hash = 2166136261u;
+
+  for (const char* str : { controllerId, featureName })
+  {
+    do
+    {
+      hash ^= static_cast<uint8_t>(*str);
+      hash *= 16777619u;
+    } while (*str++ != '\0');
+  }
+
+  return hash;
+}
+
+void CButtonMapIndex::Grow(void)
+{
+  std::vector<Entry> entries(m_entries.empty() ? INITIAL_CAPACITY : m_entries.size() * 2);
+  for (Entry& entry : entries)
+    entry.bUsed = false;
+
+  entries.swap(m_entries);
+
+  const size_t mask = m_entries.size() - 1;
+
+  for (Entry& entry : entries)
+  {
+    if (!entry.bUsed)
+      continue;
+
+    size_t slot = entry.hash & mask;
+    while (m_entries[slot].bUsed)
+      slot = (slot + 1) & mask;
+
+    m_entries[slot] = std::move(entry);
+  }
+}
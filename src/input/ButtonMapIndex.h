@@ -0,0 +1,103 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include "LibretroDevice.h" // for libretro_device_t
+
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace LIBRETRO
+{
+  /*!
+   * \brief Flat lookup table from controller features to libretro indices
+   *
+   * Built once when the buttonmap is loaded. Controller IDs are interned, and
+   * each (controller, feature) pair is stored with its precomputed hash in an
+   * open-addressed table. Lookups take the C strings of an input event as they
+   * are, so the hot path neither allocates nor walks the buttonmap.
+   */
+  class CButtonMapIndex
+  {
+  public:
+    struct Mapping
+    {
+      int               libretroIndex;
+      libretro_device_t type;
+    };
+
+    CButtonMapIndex(void);
+
+    void Clear(void);
+
+    /*!
+     * \brief Add a controller, ignored if it was already added
+     *
+     * \return False if the controller was already added
+     */
+    bool AddController(const std::string& controllerId, libretro_device_t type);
+
+    /*!
+     * \brief Map a feature of a controller that was added before
+     */
+    void AddFeature(const std::string& controllerId, const std::string& featureName, int libretroIndex);
+
+    bool HasController(const std::string& controllerId) const;
+
+    /*!
+     * \brief Get the type of a controller, or RETRO_DEVICE_NONE if unknown
+     */
+    libretro_device_t GetType(const std::string& controllerId) const;
+
+    /*!
+     * \brief Look up a feature of a controller
+     *
+     * \return The mapping, or nullptr if the feature isn't mapped
+     */
+    const Mapping* Find(const char* controllerId, const char* featureName) const;
+
+  private:
+    struct Entry
+    {
+      uint32_t     hash;
+      unsigned int controller; // Index into m_controllers
+      std::string  featureName;
+      Mapping      mapping;
+      bool         bUsed;
+    };
+
+    struct Controller
+    {
+      std::string       controllerId;
+      libretro_device_t type;
+    };
+
+    static uint32_t Hash(const char* controllerId, const char* featureName);
+
+    void Grow(void);
+
+    std::vector<Controller>                       m_controllers;
+    std::unordered_map<std::string, unsigned int> m_controllerIds; // ID -> index into m_controllers
+    std::vector<Entry>                            m_entries;       // Size is a power of two
+    size_t                                        m_entryCount;
+  };
+}
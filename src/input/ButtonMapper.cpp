@@ -27,6 +27,7 @@
 #include "libretro/LibretroTranslator.h"
 #include "libretro/libretro.h"
 #include "log/Log.h"
+#include "profiling/TraceRecorder.h"
 
 #include "tinyxml.h"
 
@@ -50,9 +51,12 @@ CButtonMapper& CButtonMapper::Get(void)
 
 bool CButtonMapper::LoadButtonMap(void)
 {
+  CTraceScope trace("CButtonMapper::LoadButtonMap");
+
   bool bSuccess = false;
 
   m_devices.clear();
+  m_index.Clear();
 
   std::string strFilename = CLibretroEnvironment::Get().GetResourcePath(BUTTONMAP_XML);
   if (strFilename.empty())
@@ -75,6 +79,8 @@ bool CButtonMapper::LoadButtonMap(void)
     }
   }
 
+  BuildIndex();
+
   return bSuccess;
 }
 
@@ -84,33 +90,22 @@ libretro_device_t CButtonMapper::GetLibretroType(const std::string& strControlle
   if (strControllerId == DEFAULT_CONTROLLER_ID)
     return RETRO_DEVICE_ANALOG;
 
-  libretro_device_t deviceType = RETRO_DEVICE_NONE;
-
-  for (auto& device : m_devices)
-  {
-    if (device->ControllerID() == strControllerId)
-    {
-      deviceType = device->Type();
-      break;
-    }
-  }
+  return m_index.GetType(strControllerId);
+}
 
-  return deviceType;
+int CButtonMapper::GetLibretroIndex(const std::string& strControllerId, const std::string& strFeatureName) const
+{
+  return GetLibretroIndex(strControllerId.c_str(), strFeatureName.c_str());
 }
 
-int CButtonMapper::GetLibretroIndex(const std::string& strControllerId, const std::string& strFeatureName)
+int CButtonMapper::GetLibretroIndex(const char* controllerId, const char* featureName) const
 {
-  if (!strControllerId.empty() && !strFeatureName.empty())
-  {
-    // Handle default controller unless it appears in buttonmap.xml
-    if (strControllerId == DEFAULT_CONTROLLER_ID && !HasController(DEFAULT_CONTROLLER_ID))
-      return CDefaultControllerTranslator::GetLibretroIndex(strFeatureName);
+  if (controllerId == nullptr || featureName == nullptr)
+    return -1;
 
-    // Check buttonmap for other controllers
-    std::string mapto = GetFeature(strControllerId, strFeatureName);
-    if (!mapto.empty())
-      return LibretroTranslator::GetFeatureIndexV2(mapto);
-  }
+  const CButtonMapIndex::Mapping* mapping = m_index.Find(controllerId, featureName);
+  if (mapping != nullptr)
+    return mapping->libretroIndex;
 
   return -1;
 }
@@ -165,31 +160,30 @@ bool CButtonMapper::HasController(const std::string& strControllerId) const
   return bFound;
 }
 
-std::string CButtonMapper::GetFeature(const std::string& strControllerId, const std::string& strFeatureName) const
+void CButtonMapper::BuildIndex(void)
 {
-  std::string mapto;
+  CTraceScope trace("CButtonMapper::BuildIndex");
 
-  for (auto& device : m_devices)
+  // The first entry of a controller wins, as it did for linear lookups
+  for (const auto& device : m_devices)
   {
-    if (device->ControllerID() == strControllerId)
-    {
-      const FeatureMap& features = device->Features();
-      for (auto& featurePair : features)
-      {
-        const std::string& controllerFeature = featurePair.first;
-        const std::string& libretroFeature = featurePair.second;
+    if (!m_index.AddController(device->ControllerID(), device->Type()))
+      continue;
 
-        if (controllerFeature == strFeatureName)
-        {
-          mapto = libretroFeature;
-          break;
-        }
-      }
-      break;
+    for (const auto& featurePair : device->Features())
+    {
+      const int index = LibretroTranslator::GetFeatureIndexV2(featurePair.second);
+      if (index >= 0)
+        m_index.AddFeature(device->ControllerID(), featurePair.first, index);
     }
   }
 
-  return mapto;
+  // Handle default controller unless it appears in buttonmap.xml
+  if (m_index.AddController(DEFAULT_CONTROLLER_ID, RETRO_DEVICE_ANALOG))
+  {
+    for (const std::string& featureName : CDefaultControllerTranslator::GetFeatureNames())
+      m_index.AddFeature(DEFAULT_CONTROLLER_ID, featureName, CDefaultControllerTranslator::GetLibretroIndex(featureName));
+  }
 }
 
 bool CButtonMapper::Deserialize(TiXmlElement* pElement)
@@ -19,6 +19,7 @@
  */
 #pragma once
 
+#include "ButtonMapIndex.h"
 #include "LibretroDevice.h" // for libretro_device_t
 
 #include <string>
@@ -40,17 +41,31 @@ namespace LIBRETRO
 
     libretro_device_t GetLibretroType(const std::string& strControllerId);
 
-    int GetLibretroIndex(const std::string& strControllerId, const std::string& strFeatureName);
+    int GetLibretroIndex(const std::string& strControllerId, const std::string& strFeatureName) const;
+
+    /*!
+     * \brief Translate a feature of an input event
+     *
+     * Uses the index built with the buttonmap, without allocating.
+     *
+     * \return The libretro index, or -1 if the feature isn't mapped
+     */
+    int GetLibretroIndex(const char* controllerId, const char* featureName) const;
 
     std::string GetControllerFeature(const std::string& strControllerId, const std::string& strLibretroFeature);
 
   private:
     bool HasController(const std::string& strControllerId) const;
-    std::string GetFeature(const std::string& strControllerId, const std::string& strFeatureName) const;
 
     bool Deserialize(TiXmlElement* pElement);
 
+    /*!
+     * \brief Index the features of the buttonmap and the default controller
+     */
+    void BuildIndex(void);
+
     bool                   m_bLoadAttempted;
     std::vector<DevicePtr> m_devices;
+    CButtonMapIndex        m_index;
   };
 }
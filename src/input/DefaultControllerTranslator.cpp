@@ -21,57 +21,72 @@
 #include "DefaultControllerTranslator.h"
 #include "DefaultControllerDefines.h"
 #include "libretro/libretro.h"
+#include "utils/StringTable.h"
 
 using namespace LIBRETRO;
 
+namespace
+{
+  struct DefaultFeature
+  {
+    int         libretroIndex;
+    const char* libretroFeature;
+  };
+
+  // Must be kept in strcmp() order of the feature names, see StringTable
+  constexpr StringTableEntry<DefaultFeature> DefaultFeatures[] =
+  {
+    { DEFAULT_CONTROLLER_FEATURE_A,              { RETRO_DEVICE_ID_JOYPAD_A,        "RETRO_DEVICE_ID_JOYPAD_A" } },
+    { DEFAULT_CONTROLLER_FEATURE_B,              { RETRO_DEVICE_ID_JOYPAD_B,        "RETRO_DEVICE_ID_JOYPAD_B" } },
+    { DEFAULT_CONTROLLER_FEATURE_BACK,           { RETRO_DEVICE_ID_JOYPAD_SELECT,   "RETRO_DEVICE_ID_JOYPAD_SELECT" } },
+    { DEFAULT_CONTROLLER_FEATURE_DOWN,           { RETRO_DEVICE_ID_JOYPAD_DOWN,     "RETRO_DEVICE_ID_JOYPAD_DOWN" } },
+    { DEFAULT_CONTROLLER_FEATURE_LEFT,           { RETRO_DEVICE_ID_JOYPAD_LEFT,     "RETRO_DEVICE_ID_JOYPAD_LEFT" } },
+    { DEFAULT_CONTROLLER_FEATURE_LEFT_BUMPER,    { RETRO_DEVICE_ID_JOYPAD_L,        "RETRO_DEVICE_ID_JOYPAD_L" } },
+    { DEFAULT_CONTROLLER_FEATURE_LEFT_MOTOR,     { RETRO_RUMBLE_STRONG,             "RETRO_RUMBLE_STRONG" } },
+    { DEFAULT_CONTROLLER_FEATURE_LEFT_STICK,     { RETRO_DEVICE_INDEX_ANALOG_LEFT,  "RETRO_DEVICE_INDEX_ANALOG_LEFT" } },
+    { DEFAULT_CONTROLLER_FEATURE_LEFT_THUMB,     { RETRO_DEVICE_ID_JOYPAD_L3,       "RETRO_DEVICE_ID_JOYPAD_L3" } },
+    { DEFAULT_CONTROLLER_FEATURE_LEFT_TRIGGER,   { RETRO_DEVICE_ID_JOYPAD_L2,       "RETRO_DEVICE_ID_JOYPAD_L2" } },
+    { DEFAULT_CONTROLLER_FEATURE_RIGHT,          { RETRO_DEVICE_ID_JOYPAD_RIGHT,    "RETRO_DEVICE_ID_JOYPAD_RIGHT" } },
+    { DEFAULT_CONTROLLER_FEATURE_RIGHT_BUMPER,   { RETRO_DEVICE_ID_JOYPAD_R,        "RETRO_DEVICE_ID_JOYPAD_R" } },
+    { DEFAULT_CONTROLLER_FEATURE_RIGHT_MOTOR,    { RETRO_RUMBLE_WEAK,               "RETRO_RUMBLE_WEAK" } },
+    { DEFAULT_CONTROLLER_FEATURE_RIGHT_STICK,    { RETRO_DEVICE_INDEX_ANALOG_RIGHT, "RETRO_DEVICE_INDEX_ANALOG_RIGHT" } },
+    { DEFAULT_CONTROLLER_FEATURE_RIGHT_THUMB,    { RETRO_DEVICE_ID_JOYPAD_R3,       "RETRO_DEVICE_ID_JOYPAD_R3" } },
+    { DEFAULT_CONTROLLER_FEATURE_RIGHT_TRIGGER,  { RETRO_DEVICE_ID_JOYPAD_R2,       "RETRO_DEVICE_ID_JOYPAD_R2" } },
+    { DEFAULT_CONTROLLER_FEATURE_START,          { RETRO_DEVICE_ID_JOYPAD_START,    "RETRO_DEVICE_ID_JOYPAD_START" } },
+    { DEFAULT_CONTROLLER_FEATURE_UP,             { RETRO_DEVICE_ID_JOYPAD_UP,       "RETRO_DEVICE_ID_JOYPAD_UP" } },
+    { DEFAULT_CONTROLLER_FEATURE_X,              { RETRO_DEVICE_ID_JOYPAD_X,        "RETRO_DEVICE_ID_JOYPAD_X" } },
+    { DEFAULT_CONTROLLER_FEATURE_Y,              { RETRO_DEVICE_ID_JOYPAD_Y,        "RETRO_DEVICE_ID_JOYPAD_Y" } },
+  };
+  static_assert(StringTable::IsSorted(DefaultFeatures), "DefaultFeatures must be sorted");
+}
+
 int CDefaultControllerTranslator::GetLibretroIndex(const std::string &strFeatureName)
 {
-  if (strFeatureName == DEFAULT_CONTROLLER_FEATURE_A)             return RETRO_DEVICE_ID_JOYPAD_A;
-  if (strFeatureName == DEFAULT_CONTROLLER_FEATURE_B)             return RETRO_DEVICE_ID_JOYPAD_B;
-  if (strFeatureName == DEFAULT_CONTROLLER_FEATURE_X)             return RETRO_DEVICE_ID_JOYPAD_X;
-  if (strFeatureName == DEFAULT_CONTROLLER_FEATURE_Y)             return RETRO_DEVICE_ID_JOYPAD_Y;
-  if (strFeatureName == DEFAULT_CONTROLLER_FEATURE_START)         return RETRO_DEVICE_ID_JOYPAD_START;
-  if (strFeatureName == DEFAULT_CONTROLLER_FEATURE_BACK)          return RETRO_DEVICE_ID_JOYPAD_SELECT;
-  if (strFeatureName == DEFAULT_CONTROLLER_FEATURE_LEFT_BUMPER)   return RETRO_DEVICE_ID_JOYPAD_L;
-  if (strFeatureName == DEFAULT_CONTROLLER_FEATURE_RIGHT_BUMPER)  return RETRO_DEVICE_ID_JOYPAD_R;
-  if (strFeatureName == DEFAULT_CONTROLLER_FEATURE_LEFT_THUMB)    return RETRO_DEVICE_ID_JOYPAD_L3;
-  if (strFeatureName == DEFAULT_CONTROLLER_FEATURE_RIGHT_THUMB)   return RETRO_DEVICE_ID_JOYPAD_R3;
-  if (strFeatureName == DEFAULT_CONTROLLER_FEATURE_UP)            return RETRO_DEVICE_ID_JOYPAD_UP;
-  if (strFeatureName == DEFAULT_CONTROLLER_FEATURE_DOWN)          return RETRO_DEVICE_ID_JOYPAD_DOWN;
-  if (strFeatureName == DEFAULT_CONTROLLER_FEATURE_RIGHT)         return RETRO_DEVICE_ID_JOYPAD_RIGHT;
-  if (strFeatureName == DEFAULT_CONTROLLER_FEATURE_LEFT)          return RETRO_DEVICE_ID_JOYPAD_LEFT;
-  if (strFeatureName == DEFAULT_CONTROLLER_FEATURE_LEFT_TRIGGER)  return RETRO_DEVICE_ID_JOYPAD_L2;
-  if (strFeatureName == DEFAULT_CONTROLLER_FEATURE_RIGHT_TRIGGER) return RETRO_DEVICE_ID_JOYPAD_R2;
-  if (strFeatureName == DEFAULT_CONTROLLER_FEATURE_LEFT_STICK)    return RETRO_DEVICE_INDEX_ANALOG_LEFT;
-  if (strFeatureName == DEFAULT_CONTROLLER_FEATURE_RIGHT_STICK)   return RETRO_DEVICE_INDEX_ANALOG_RIGHT;
-  if (strFeatureName == DEFAULT_CONTROLLER_FEATURE_LEFT_MOTOR)    return RETRO_RUMBLE_STRONG;
-  if (strFeatureName == DEFAULT_CONTROLLER_FEATURE_RIGHT_MOTOR)   return RETRO_RUMBLE_WEAK;
+  const DefaultFeature* feature = StringTable::Find(DefaultFeatures, strFeatureName.c_str());
+  if (feature != nullptr)
+    return feature->libretroIndex;
 
   return -1;
 }
 
+std::vector<std::string> CDefaultControllerTranslator::GetFeatureNames(void)
+{
+  std::vector<std::string> featureNames;
+  featureNames.reserve(sizeof(DefaultFeatures) / sizeof(DefaultFeatures[0]));
+
+  for (const auto& entry : DefaultFeatures)
+    featureNames.emplace_back(entry.name);
+
+  return featureNames;
+}
+
 std::string CDefaultControllerTranslator::GetControllerFeature(const std::string &strLibretroFeature)
 {
-  if (strLibretroFeature == "RETRO_DEVICE_ID_JOYPAD_A")        return DEFAULT_CONTROLLER_FEATURE_A;
-  if (strLibretroFeature == "RETRO_DEVICE_ID_JOYPAD_B")        return DEFAULT_CONTROLLER_FEATURE_B;
-  if (strLibretroFeature == "RETRO_DEVICE_ID_JOYPAD_X")        return DEFAULT_CONTROLLER_FEATURE_X;
-  if (strLibretroFeature == "RETRO_DEVICE_ID_JOYPAD_Y")        return DEFAULT_CONTROLLER_FEATURE_Y;
-  if (strLibretroFeature == "RETRO_DEVICE_ID_JOYPAD_START")    return DEFAULT_CONTROLLER_FEATURE_START;
-  if (strLibretroFeature == "RETRO_DEVICE_ID_JOYPAD_SELECT")   return DEFAULT_CONTROLLER_FEATURE_BACK;
-  if (strLibretroFeature == "RETRO_DEVICE_ID_JOYPAD_UP")       return DEFAULT_CONTROLLER_FEATURE_UP;
-  if (strLibretroFeature == "RETRO_DEVICE_ID_JOYPAD_DOWN")     return DEFAULT_CONTROLLER_FEATURE_DOWN;
-  if (strLibretroFeature == "RETRO_DEVICE_ID_JOYPAD_RIGHT")    return DEFAULT_CONTROLLER_FEATURE_RIGHT;
-  if (strLibretroFeature == "RETRO_DEVICE_ID_JOYPAD_LEFT")     return DEFAULT_CONTROLLER_FEATURE_LEFT;
-  if (strLibretroFeature == "RETRO_DEVICE_ID_JOYPAD_L")        return DEFAULT_CONTROLLER_FEATURE_LEFT_BUMPER;
-  if (strLibretroFeature == "RETRO_DEVICE_ID_JOYPAD_R")        return DEFAULT_CONTROLLER_FEATURE_RIGHT_BUMPER;
-  if (strLibretroFeature == "RETRO_DEVICE_ID_JOYPAD_L2")       return DEFAULT_CONTROLLER_FEATURE_LEFT_TRIGGER;
-  if (strLibretroFeature == "RETRO_DEVICE_ID_JOYPAD_R2")       return DEFAULT_CONTROLLER_FEATURE_RIGHT_TRIGGER;
-  if (strLibretroFeature == "RETRO_DEVICE_ID_JOYPAD_L3")       return DEFAULT_CONTROLLER_FEATURE_LEFT_THUMB;
-  if (strLibretroFeature == "RETRO_DEVICE_ID_JOYPAD_R3")       return DEFAULT_CONTROLLER_FEATURE_RIGHT_THUMB;
-  if (strLibretroFeature == "RETRO_DEVICE_INDEX_ANALOG_LEFT")  return DEFAULT_CONTROLLER_FEATURE_LEFT_STICK;
-  if (strLibretroFeature == "RETRO_DEVICE_INDEX_ANALOG_RIGHT") return DEFAULT_CONTROLLER_FEATURE_RIGHT_STICK;
-  if (strLibretroFeature == "RETRO_RUMBLE_STRONG")             return DEFAULT_CONTROLLER_FEATURE_LEFT_MOTOR;
-  if (strLibretroFeature == "RETRO_RUMBLE_WEAK")               return DEFAULT_CONTROLLER_FEATURE_RIGHT_MOTOR;
+  for (const auto& entry : DefaultFeatures)
+  {
+    if (strLibretroFeature == entry.value.libretroFeature)
+      return entry.name;
+  }
 
   return "";
 }
@@ -20,6 +20,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 namespace LIBRETRO
 {
@@ -31,6 +32,11 @@ namespace LIBRETRO
      */
     static int GetLibretroIndex(const std::string &strFeatureName);
 
+    /*!
+     * \brief Get the Kodi feature names that have a libretro index
+     */
+    static std::vector<std::string> GetFeatureNames(void);
+
     /*!
      * \brief Translate from libretro feature (from libretro.h) to Kodi feature
      *
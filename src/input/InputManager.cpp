@@ -26,14 +26,62 @@
 #include "libretro/LibretroEnvironment.h"
 #include "libretro/LibretroTranslator.h"
 #include "log/Log.h"
+#include "profiling/InputLatency.h"
+#include "utils/TimeUtils.h"
 
 #include "libKODI_game.h"
 
 #include <algorithm>
+#include <string.h>
 
 using namespace LIBRETRO;
 using namespace P8PLATFORM;
 
+namespace
+{
+  /*!
+   * \brief Get the slot of a device connected to a Kodi port
+   *
+   * \return The slot, or INPUT_SLOT_COUNT if the port is out of range
+   */
+  unsigned int GetPortSlot(int port)
+  {
+    if (port == GAME_INPUT_PORT_MOUSE)
+      return INPUT_SLOT_MOUSE;
+
+    if (port == GAME_INPUT_PORT_KEYBOARD)
+      return INPUT_SLOT_KEYBOARD;
+
+    if (port >= GAME_INPUT_PORT_JOYSTICK_START && port < GAME_INPUT_PORT_JOYSTICK_START + INPUT_MAX_PORTS)
+      return static_cast<unsigned int>(port - GAME_INPUT_PORT_JOYSTICK_START);
+
+    return INPUT_SLOT_COUNT;
+  }
+
+  int GetSlotPort(unsigned int slot)
+  {
+    if (slot == INPUT_SLOT_MOUSE)
+      return GAME_INPUT_PORT_MOUSE;
+
+    if (slot == INPUT_SLOT_KEYBOARD)
+      return GAME_INPUT_PORT_KEYBOARD;
+
+    return GAME_INPUT_PORT_JOYSTICK_START + static_cast<int>(slot);
+  }
+}
+
+CInputManager::CInputManager(void) :
+  m_connectedSlots(0),
+  m_keyboardEventTimeNs(0),
+  m_bPolled(false)
+{
+  for (unsigned int i = 0; i < KEYBOARD_WORD_COUNT; i++)
+    m_keyboardState[i] = 0;
+
+  memset(m_snapshots, 0, sizeof(m_snapshots));
+  memset(m_keyboardSnapshot, 0, sizeof(m_keyboardSnapshot));
+}
+
 CInputManager& CInputManager::Get(void)
 {
   static CInputManager _instance;
@@ -52,18 +100,35 @@ libretro_device_caps_t CInputManager::GetDeviceCaps(void) const
 
 void CInputManager::DeviceConnected(int port, bool bConnected, const game_controller* connectedDevice)
 {
-  if (bConnected)
-    m_devices[port] = std::make_shared<CLibretroDevice>(connectedDevice);
+  const unsigned int slot = GetPortSlot(port);
+  if (slot >= INPUT_SLOT_COUNT)
+  {
+    esyslog("Can't connect device to port %d, only %u ports are supported", port, INPUT_MAX_PORTS);
+    return;
+  }
+
+  SetDevice(slot, bConnected ? std::make_shared<CLibretroDevice>(connectedDevice) : DevicePtr());
+}
+
+void CInputManager::SetDevice(unsigned int slot, const DevicePtr& device)
+{
+  CLockObject lock(m_connectMutex);
+
+  std::atomic_store(&m_devices[slot], device);
+
+  if (device)
+    m_connectedSlots.fetch_or(1U << slot, std::memory_order_release);
   else
-    m_devices[port].reset();
+    m_connectedSlots.fetch_and(~(1U << slot), std::memory_order_release);
 }
 
 libretro_device_t CInputManager::GetDevice(unsigned int port)
 {
   libretro_device_t deviceType = 0;
 
-  if (m_devices[port])
-    deviceType = m_devices[port]->Type();
+  DevicePtr device = GetPort(port);
+  if (device)
+    deviceType = device->Type();
 
   return deviceType;
 }
@@ -80,7 +145,11 @@ bool CInputManager::OpenPort(unsigned int port)
 
 DevicePtr CInputManager::GetPort(unsigned int port)
 {
-  return m_devices[port];
+  const unsigned int slot = GetPortSlot(static_cast<int>(port));
+  if (slot >= INPUT_SLOT_COUNT)
+    return DevicePtr();
+
+  return std::atomic_load(&m_devices[slot]);
 }
 
 void CInputManager::ClosePort(unsigned int port)
@@ -88,20 +157,20 @@ void CInputManager::ClosePort(unsigned int port)
   if (CLibretroEnvironment::Get().GetFrontend())
     CLibretroEnvironment::Get().GetFrontend()->ClosePort(port);
 
-  m_devices[port].reset();
+  const unsigned int slot = GetPortSlot(static_cast<int>(port));
+  if (slot < INPUT_SLOT_COUNT)
+    SetDevice(slot, DevicePtr());
 }
 
 void CInputManager::ClosePorts(void)
 {
-  std::vector<unsigned int> ports;
-  for (auto it = m_devices.begin(); it != m_devices.end(); ++it)
+  const uint32_t connectedSlots = m_connectedSlots.load(std::memory_order_acquire);
+
+  for (unsigned int slot = 0; slot < INPUT_SLOT_COUNT; slot++)
   {
-    if (it->second)
-      ports.push_back(it->first);
+    if (connectedSlots & (1U << slot))
+      ClosePort(static_cast<unsigned int>(GetSlotPort(slot)));
   }
-
-  for (auto port : ports)
-    ClosePort(port);
 }
 
 void CInputManager::EnableAnalogSensors(unsigned int port, bool bEnabled)
@@ -113,14 +182,17 @@ bool CInputManager::InputEvent(const game_input_event& event)
 {
   bool bHandled = false;
 
+  const int64_t eventTimeNs = CInputLatency::Get().IsEnabled() ? TimeUtils::GetTimeNsec() : 0;
+
   if (event.type == GAME_INPUT_EVENT_KEY)
   {
+    const bool      down    = event.key.pressed;
+    const retro_key keycode = LibretroTranslator::GetKeyCode(event.key.character);
+
     // Report key to client
     CClientBridge* clientBridge = CLibretroEnvironment::Get().GetClientBridge();
     if (clientBridge)
     {
-      const bool      down          = event.key.pressed;
-      const retro_key keycode       = LibretroTranslator::GetKeyCode(event.key.character);
       const uint32_t  character     = event.key.character;
       const retro_mod key_modifiers = LibretroTranslator::GetKeyModifiers(event.key.modifiers);
 
@@ -131,16 +203,23 @@ bool CInputManager::InputEvent(const game_input_event& event)
     }
 
     // Record key press for polling
-    HandlePress(event.key);
+    HandlePress(keycode, down);
+
+    if (eventTimeNs != 0)
+      CInputLatency::Stamp(m_keyboardEventTimeNs, eventTimeNs);
 
     bHandled = true;
   }
   else
   {
-    const int port = event.port;
-
-    if (m_devices[port])
-      bHandled = m_devices[port]->Input().InputEvent(event);
+    // Holding a reference keeps the device alive if it's disconnected now
+    const unsigned int slot = GetPortSlot(event.port);
+    if (slot < INPUT_SLOT_COUNT)
+    {
+      DevicePtr device = std::atomic_load(&m_devices[slot]);
+      if (device)
+        bHandled = device->Input().InputEvent(event, eventTimeNs);
+    }
   }
 
   return bHandled;
@@ -183,10 +262,10 @@ std::string CInputManager::ControllerID(unsigned int port) const
 {
   std::string controllerId;
 
-  auto it = m_devices.find(port);
-  if (it != m_devices.end())
+  const unsigned int slot = GetPortSlot(static_cast<int>(port));
+  if (slot < INPUT_SLOT_COUNT)
   {
-    const auto &device = it->second;
+    DevicePtr device = std::atomic_load(&m_devices[slot]);
     if (device)
       controllerId = device->ControllerID();
   }
@@ -194,116 +273,123 @@ std::string CInputManager::ControllerID(unsigned int port) const
   return controllerId;
 }
 
-bool CInputManager::ButtonState(libretro_device_t device, unsigned int port, unsigned int buttonIndex) const
+void CInputManager::Poll(void)
 {
-  bool bState = false;
+  CInputLatency& latency = CInputLatency::Get();
 
-  if (device == RETRO_DEVICE_KEYBOARD)
-  {
-    bState = IsPressed(buttonIndex);
-  }
-  else
+  const uint32_t connectedSlots = m_connectedSlots.load(std::memory_order_acquire);
+
+  for (unsigned int slot = 0; slot <= INPUT_SLOT_MOUSE; slot++)
   {
-    int iPort = port;
+    PortSnapshot& snapshot = m_snapshots[slot];
 
-    if (device == RETRO_DEVICE_MOUSE)
-      iPort = GAME_INPUT_PORT_MOUSE;
+    // Empty slots are skipped without touching the device table
+    DevicePtr device;
+    if (connectedSlots & (1U << slot))
+      device = std::atomic_load(&m_devices[slot]);
 
-    auto it = m_devices.find(iPort);
-    if (it != m_devices.end())
+    if (device)
     {
-      const auto &device = it->second;
-      if (device)
-        bState = device->Input().ButtonState(buttonIndex);
+      CLibretroDeviceInput& input = device->Input();
+
+      Latch(input, snapshot);
+
+      if (latency.IsEnabled())
+        latency.Latched(slot, input.TakeEventTime());
+    }
+    else
+    {
+      memset(&snapshot, 0, sizeof(snapshot));
     }
   }
 
-  return bState;
-}
-
-int CInputManager::DeltaX(libretro_device_t device, unsigned int port)
-{
-  int deltaX = 0;
+  for (unsigned int i = 0; i < KEYBOARD_WORD_COUNT; i++)
+    m_keyboardSnapshot[i] = m_keyboardState[i].load(std::memory_order_relaxed);
 
-  int iPort = port;
+  if (latency.IsEnabled())
+    latency.Latched(INPUT_SLOT_KEYBOARD, CInputLatency::Take(m_keyboardEventTimeNs));
 
-  if (device == RETRO_DEVICE_MOUSE)
-    iPort = GAME_INPUT_PORT_MOUSE;
+  m_bPolled = true;
+}
 
-  auto it = m_devices.find(iPort);
-  if (it != m_devices.end())
-  {
-    const auto &device = it->second;
-    if (device)
-      deltaX = device->Input().RelativePointerDeltaX();
-  }
+void CInputManager::FrameStart(void)
+{
+  if (!m_bPolled)
+    Poll();
 
-  return deltaX;
+  m_bPolled = false;
 }
 
-int CInputManager::DeltaY(libretro_device_t device, unsigned int port)
+unsigned int CInputManager::GetSlot(libretro_device_t device, unsigned int port)
 {
-  int deltaY = 0;
-
-  int iPort = port;
+  if (device == RETRO_DEVICE_KEYBOARD)
+    return INPUT_SLOT_KEYBOARD;
 
   if (device == RETRO_DEVICE_MOUSE)
-    iPort = GAME_INPUT_PORT_MOUSE;
+    return INPUT_SLOT_MOUSE;
 
-  auto it = m_devices.find(iPort);
-  if (it != m_devices.end())
-  {
-    const auto &device = it->second;
-    if (device)
-      deltaY = device->Input().RelativePointerDeltaY();
-  }
+  if (port < INPUT_MAX_PORTS)
+    return port;
 
-  return deltaY;
+  return INPUT_SLOT_COUNT;
 }
 
-bool CInputManager::AnalogStickState(unsigned int port, unsigned int analogStickIndex, float& x, float& y) const
+const PortSnapshot* CInputManager::GetSnapshot(libretro_device_t device, unsigned int port) const
 {
-  bool bSuccess = false;
+  const unsigned int slot = GetSlot(device, port);
+  if (slot < INPUT_SLOT_KEYBOARD)
+    return &m_snapshots[slot];
 
-  auto it = m_devices.find(port);
-  if (it != m_devices.end())
-  {
-    const auto &device = it->second;
-    if (device)
-      bSuccess = device->Input().AnalogStickState(analogStickIndex, x, y);
-  }
-
-  return bSuccess;
+  return nullptr;
 }
 
-bool CInputManager::AbsolutePointerState(unsigned int port, unsigned int pointerIndex, float& x, float& y) const
+void CInputManager::Latch(CLibretroDeviceInput& input, PortSnapshot& snapshot)
 {
-  bool bSuccess = false;
+  int deltaX;
+  int deltaY;
+  const DeviceInputState& state = input.Poll(deltaX, deltaY);
 
-  auto it = m_devices.find(port);
-  if (it != m_devices.end())
+  snapshot.buttons = state.buttons;
+
+  for (unsigned int i = 0; i < LIBRETRO_ANALOG_STICK_COUNT; i++)
   {
-    const auto &device = it->second;
-    if (device)
-      bSuccess = device->Input().AbsolutePointerState(pointerIndex, x, y);
-  }
+    // Sticks that the controller doesn't have are centered
+    if (i >= input.AnalogStickCount())
+    {
+      snapshot.analog[i][RETRO_DEVICE_ID_ANALOG_X] = 0;
+      snapshot.analog[i][RETRO_DEVICE_ID_ANALOG_Y] = 0;
+      continue;
+    }
 
-  return bSuccess;
-}
+    const float normalizedX = (state.analogSticks[i].x + 1.0f) / 2.0f;
+    const float normalizedY = (-state.analogSticks[i].y + 1.0f) / 2.0f; // y axis is inverted
+    snapshot.analog[i][RETRO_DEVICE_ID_ANALOG_X] = static_cast<int16_t>((int)(normalizedX * 0xffff) - 0x8000);
+    snapshot.analog[i][RETRO_DEVICE_ID_ANALOG_Y] = static_cast<int16_t>((int)(normalizedY * 0xffff) - 0x8000);
+  }
 
-bool CInputManager::AccelerometerState(unsigned int port, float& x, float& y, float& z) const
-{
-  bool bSuccess = false;
+  snapshot.relative[0] = static_cast<int16_t>(std::max(-0x8000, std::min(deltaX, 0x7fff)));
+  snapshot.relative[1] = static_cast<int16_t>(std::max(-0x8000, std::min(deltaY, 0x7fff)));
 
-  auto it = m_devices.find(port);
-  if (it != m_devices.end())
+  snapshot.pointersPressed = 0;
+  for (unsigned int i = 0; i < LIBRETRO_ABSOLUTE_POINTER_COUNT; i++)
   {
-    const auto &device = it->second;
-    if (device)
-      bSuccess = device->Input().AccelerometerState(x, y, z);
+    const game_abs_pointer_event& pointer = state.absolutePointers[i];
+    if (pointer.pressed)
+    {
+      snapshot.pointersPressed |= 1 << i;
+      snapshot.pointers[i][0] = static_cast<int16_t>(pointer.x * 0x7fff);
+      snapshot.pointers[i][1] = static_cast<int16_t>(pointer.y * 0x7fff);
+    }
+    else
+    {
+      snapshot.pointers[i][0] = 0;
+      snapshot.pointers[i][1] = 0;
+    }
   }
 
-  return bSuccess;
+  snapshot.accelerometer[0] = state.accelerometer.x;
+  snapshot.accelerometer[1] = state.accelerometer.y;
+  snapshot.accelerometer[2] = state.accelerometer.z;
 }
 
 void CInputManager::SetControllerInfo(const retro_controller_info* info)
@@ -327,31 +413,16 @@ void CInputManager::SetControllerInfo(const retro_controller_info* info)
   dsyslog("------------------------------------------------------------");
 }
 
-void CInputManager::HandlePress(const game_key_event& key)
+void CInputManager::HandlePress(retro_key keycode, bool bPressed)
 {
-  CLockObject lock(m_keyMutex);
+  const unsigned int key = keycode;
+  if (key == RETROK_UNKNOWN || key >= RETROK_LAST)
+    return;
 
-  if (key.pressed)
-  {
-    m_pressedKeys.push_back(key);
-  }
-  else
-  {
-    m_pressedKeys.erase(std::remove_if(m_pressedKeys.begin(), m_pressedKeys.end(),
-      [&key](const game_key_event& pressedKey)
-      {
-        return pressedKey.character == key.character;
-      }), m_pressedKeys.end());
-  }
-}
-
-bool CInputManager::IsPressed(uint32_t character) const
-{
-  CLockObject lock(m_keyMutex);
+  const uint64_t bit = 1ULL << (key % 64);
 
-  return std::count_if(m_pressedKeys.begin(), m_pressedKeys.end(),
-    [character](const game_key_event& keyEvent)
-    {
-      return keyEvent.character == character;
-    }) > 0;
+  if (bPressed)
+    m_keyboardState[key / 64].fetch_or(bit, std::memory_order_relaxed);
+  else
+    m_keyboardState[key / 64].fetch_and(~bit, std::memory_order_relaxed);
 }
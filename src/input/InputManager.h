@@ -20,10 +20,14 @@
 #pragma once
 
 #include "LibretroDevice.h"
+#include "LibretroDeviceInput.h"
 
 #include "kodi_game_types.h"
+#include "libretro/libretro.h"
+
 #include "p8-platform/threads/mutex.h"
 
+#include <atomic>
 #include <stdint.h>
 #include <string>
 #include <vector>
@@ -31,14 +35,41 @@
 struct retro_controller_info;
 struct retro_input_descriptor;
 
+// Number of joystick ports included in the input snapshot
+#define INPUT_MAX_PORTS  16
+
+// Input slots: the joystick ports, then the devices that aren't tied to one
+#define INPUT_SLOT_MOUSE     INPUT_MAX_PORTS
+#define INPUT_SLOT_KEYBOARD  (INPUT_MAX_PORTS + 1)
+#define INPUT_SLOT_COUNT     (INPUT_MAX_PORTS + 2)
+
+// Number of 64-bit words in the keyboard bitset
+#define KEYBOARD_WORD_COUNT  ((RETROK_LAST + 63) / 64)
+
 namespace LIBRETRO
 {
   typedef uint64_t  libretro_device_caps_t;
 
+  /*!
+   * \brief Input of a port, latched when the core polls for input
+   *
+   * Values are already scaled to the ranges defined by libretro.h, so that
+   * reading them is a plain load. Each port gets its own cache lines.
+   */
+  struct alignas(64) PortSnapshot
+  {
+    uint32_t buttons;                                     // Bit N is set while button N is pressed
+    int16_t  analog[LIBRETRO_ANALOG_STICK_COUNT][2];      // Indexed by RETRO_DEVICE_ID_ANALOG_X/Y
+    int16_t  relative[2];                                 // Motion since the previous poll
+    uint16_t pointersPressed;                             // Bit N is set while pointer N is pressed
+    int16_t  pointers[LIBRETRO_ABSOLUTE_POINTER_COUNT][2];
+    float    accelerometer[3];
+  };
+
   class CInputManager
   {
   private:
-    CInputManager(void) { }
+    CInputManager(void);
 
   public:
     static CInputManager& Get(void);
@@ -89,12 +120,48 @@ namespace LIBRETRO
      */
     std::string ControllerID(unsigned int port) const;
 
-    bool ButtonState(libretro_device_t device, unsigned int port, unsigned int buttonIndex) const;
-    int DeltaX(libretro_device_t device, unsigned int port);
-    int DeltaY(libretro_device_t device, unsigned int port);
-    bool AnalogStickState(unsigned int port, unsigned int analogStickIndex, float& x, float& y) const;
-    bool AbsolutePointerState(unsigned int port, unsigned int pointerIndex, float& x, float& y) const;
-    bool AccelerometerState(unsigned int port, float& x, float& y, float& z) const;
+    /*!
+     * \brief Latch the input of all ports
+     *
+     * Called on the emulation thread when the core polls for input. The
+     * snapshot doesn't change until the next poll.
+     */
+    void Poll(void);
+
+    /*!
+     * \brief Called on the emulation thread before the core runs a frame
+     *
+     * Some cores read input without ever calling input_poll_cb. If the core
+     * didn't poll during the previous frame, the input is latched here.
+     */
+    void FrameStart(void);
+
+    /*!
+     * \brief Get the input slot that a libretro device and port are read from
+     *
+     * \return The slot, or INPUT_SLOT_COUNT if the port is out of range
+     */
+    static unsigned int GetSlot(libretro_device_t device, unsigned int port);
+
+    /*!
+     * \brief Get the input of a port as of the last poll
+     *
+     * \param device  The libretro device, used to select the mouse port
+     * \param port    The libretro port
+     *
+     * \return The snapshot, or nullptr if the port is out of range
+     */
+    const PortSnapshot* GetSnapshot(libretro_device_t device, unsigned int port) const;
+
+    /*!
+     * \brief Check if a key was pressed as of the last poll
+     *
+     * \param key  The libretro key code (retro_key)
+     */
+    bool KeyboardState(unsigned int key) const
+    {
+      return key < RETROK_LAST && (m_keyboardSnapshot[key / 64] & (1ULL << (key % 64))) != 0;
+    }
 
     /*!
      * \brief Inform the frontend of controller info
@@ -102,11 +169,25 @@ namespace LIBRETRO
     void SetControllerInfo(const retro_controller_info* info);
 
   private:
-    void HandlePress(const game_key_event& key);
-    bool IsPressed(uint32_t character) const;
+    static void Latch(CLibretroDeviceInput& input, PortSnapshot& snapshot);
+
+    void HandlePress(retro_key keycode, bool bPressed);
+
+    void SetDevice(unsigned int slot, const DevicePtr& device);
+
+    // Indexed by slot. Replaced under m_connectMutex and read from any thread
+    // with std::atomic_load(), so input events never wait for a connection.
+    DevicePtr             m_devices[INPUT_SLOT_COUNT];
+    std::atomic<uint32_t> m_connectedSlots; // Bit N is set while slot N has a device
+    P8PLATFORM::CMutex    m_connectMutex;
+
+    // Input thread, bit N is set while retro_key N is pressed
+    std::atomic<uint64_t> m_keyboardState[KEYBOARD_WORD_COUNT];
+    std::atomic<int64_t>  m_keyboardEventTimeNs;
 
-    std::map<int, DevicePtr>          m_devices;
-    std::vector<game_key_event>       m_pressedKeys;
-    mutable P8PLATFORM::CMutex        m_keyMutex;
+    // Emulation thread, indexed by slot. The keyboard has its own snapshot.
+    PortSnapshot m_snapshots[INPUT_SLOT_KEYBOARD];
+    uint64_t     m_keyboardSnapshot[KEYBOARD_WORD_COUNT];
+    bool         m_bPolled; // True if Poll() was called since FrameStart()
   };
 }
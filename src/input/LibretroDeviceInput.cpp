@@ -22,20 +22,23 @@
 #include "LibretroDevice.h"
 #include "ButtonMapper.h"
 #include "libretro/libretro.h"
+#include "profiling/InputLatency.h"
+
+#include <string.h>
 
 using namespace LIBRETRO;
 using namespace P8PLATFORM;
 
-#define LIBRETRO_JOYPAD_BUTTON_COUNT     16
-#define LIBRETRO_ANALOG_STICK_COUNT      2
-#define LIBRETRO_ACCELEROMETER_COUNT     1
-#define LIBRETRO_MOUSE_BUTTON_COUNT      9
-#define LIBRETRO_LIGHTGUN_BUTTON_COUNT   7
-#define LIBRETRO_RELATIVE_POINTER_COUNT  1
-#define LIBRETRO_ABSOLUTE_POINTER_COUNT  10
-
-CLibretroDeviceInput::CLibretroDeviceInput(const game_controller* controller)
+CLibretroDeviceInput::CLibretroDeviceInput(const game_controller* controller) :
+  m_buttonCount(0),
+  m_analogStickCount(0),
+  m_accelerometerCount(0),
+  m_relativePointerCount(0),
+  m_absolutePointerCount(0),
+  m_eventTimeNs(0)
 {
+  memset(&m_state, 0, sizeof(m_state));
+
   if (controller && controller->controller_id)
   {
     unsigned int type = CButtonMapper::Get().GetLibretroType(controller->controller_id);
@@ -43,132 +46,69 @@ CLibretroDeviceInput::CLibretroDeviceInput(const game_controller* controller)
     switch (type)
     {
       case RETRO_DEVICE_JOYPAD:
-        m_buttons.resize(LIBRETRO_JOYPAD_BUTTON_COUNT);
+        m_buttonCount = LIBRETRO_JOYPAD_BUTTON_COUNT;
         break;
 
       case RETRO_DEVICE_MOUSE:
-        m_buttons.resize(LIBRETRO_MOUSE_BUTTON_COUNT);
-        m_relativePointers.resize(LIBRETRO_RELATIVE_POINTER_COUNT);
+        m_buttonCount = LIBRETRO_MOUSE_BUTTON_COUNT;
+        m_relativePointerCount = LIBRETRO_RELATIVE_POINTER_COUNT;
         break;
 
       case RETRO_DEVICE_LIGHTGUN:
-        m_buttons.resize(LIBRETRO_LIGHTGUN_BUTTON_COUNT);
-        m_relativePointers.resize(LIBRETRO_RELATIVE_POINTER_COUNT);
+        m_buttonCount = LIBRETRO_LIGHTGUN_BUTTON_COUNT;
+        m_relativePointerCount = LIBRETRO_RELATIVE_POINTER_COUNT;
         break;
 
       case RETRO_DEVICE_ANALOG:
-        m_buttons.resize(LIBRETRO_JOYPAD_BUTTON_COUNT);
-        m_analogSticks.resize(LIBRETRO_ANALOG_STICK_COUNT);
+        m_buttonCount = LIBRETRO_JOYPAD_BUTTON_COUNT;
+        m_analogStickCount = LIBRETRO_ANALOG_STICK_COUNT;
         break;
 
       case RETRO_DEVICE_POINTER:
-        m_absolutePointers.resize(LIBRETRO_ABSOLUTE_POINTER_COUNT);
+        m_absolutePointerCount = LIBRETRO_ABSOLUTE_POINTER_COUNT;
         break;
 
       default:
         break;
     }
 
-    m_accelerometers.resize(LIBRETRO_ACCELEROMETER_COUNT);
-  }
-}
-
-bool CLibretroDeviceInput::ButtonState(unsigned int buttonIndex) const
-{
-  bool buttonState = false;
-
-  if (buttonIndex < m_buttons.size())
-    buttonState = m_buttons[buttonIndex].pressed;
-
-  return buttonState;
-}
-
-bool CLibretroDeviceInput::AnalogStickState(unsigned int analogStickIndex, float& x, float& y) const
-{
-  bool bSuccess = false;
-
-  if (analogStickIndex < m_analogSticks.size())
-  {
-    x = m_analogSticks[analogStickIndex].x;
-    y = m_analogSticks[analogStickIndex].y;
-    bSuccess = true;
+    m_accelerometerCount = LIBRETRO_ACCELEROMETER_COUNT;
   }
 
-  return bSuccess;
+  // Nothing is published until the first event, so the reader starts with
+  // the initial state
+  m_published.Back() = m_state;
+  m_published.Publish();
 }
 
-bool CLibretroDeviceInput::AccelerometerState(float& x, float& y, float& z) const
+bool CLibretroDeviceInput::InputEvent(const game_input_event& event, int64_t eventTimeNs)
 {
-  bool bSuccess = false;
-
-  if (!m_accelerometers.empty())
-  {
-    x = m_accelerometers[0].x;
-    y = m_accelerometers[0].y;
-    z = m_accelerometers[0].z;
-    bSuccess = true;
-  }
-
-  return bSuccess;
-}
-
-int CLibretroDeviceInput::RelativePointerDeltaX(void)
-{
-  int deltaX = 0;
-
-  if (!m_relativePointers.empty())
-  {
-    CLockObject lock(m_relativePtrMutex);
-
-    deltaX = m_relativePointers[0].x;
-    m_relativePointers[0].x = 0;
-  }
-
-  return deltaX;
-}
-
-int CLibretroDeviceInput::RelativePointerDeltaY(void)
-{
-  int deltaY = 0;
-
-  if (!m_relativePointers.empty())
+  int index = CButtonMapper::Get().GetLibretroIndex(event.controller_id, event.feature_name);
+  if (index >= 0)
   {
-    CLockObject lock(m_relativePtrMutex);
+    if (eventTimeNs != 0)
+      CInputLatency::Stamp(m_eventTimeNs, eventTimeNs);
 
-    deltaY = m_relativePointers[0].y;
-    m_relativePointers[0].y = 0;
-  }
-
-  return deltaY;
-}
-
-bool CLibretroDeviceInput::AbsolutePointerState(unsigned int pointerIndex, float& x, float& y) const
-{
-  bool bSuccess = false;
-
-  if (pointerIndex < m_absolutePointers.size() &&  m_absolutePointers[pointerIndex].pressed)
-  {
-    x = m_absolutePointers[pointerIndex].x;
-    y = m_absolutePointers[pointerIndex].y;
-    bSuccess = true;
-  }
+    if (event.type == GAME_INPUT_EVENT_RELATIVE_POINTER)
+    {
+      if (index < (int)m_relativePointerCount)
+        m_relativeMotion.Add(event.rel_pointer.x, event.rel_pointer.y);
 
-  return bSuccess;
-}
+      return true;
+    }
 
-bool CLibretroDeviceInput::InputEvent(const game_input_event& event)
-{
-  const std::string strControllerId = event.controller_id ? event.controller_id : "";
-  const std::string strFeatureName = event.feature_name ? event.feature_name : "";
+    CLockObject lock(m_stateMutex);
 
-  int index = CButtonMapper::Get().GetLibretroIndex(strControllerId, strFeatureName);
-  if (index >= 0)
-  {
     switch (event.type)
     {
       case GAME_INPUT_EVENT_DIGITAL_BUTTON:
-        if (index < (int)m_buttons.size())
-          m_buttons[index] = event.digital_button;
+        if (index < (int)m_buttonCount)
+        {
+          if (event.digital_button.pressed)
+            m_state.buttons |= 1u << index;
+          else
+            m_state.buttons &= ~(1u << index);
+        }
         break;
 
       case GAME_INPUT_EVENT_ANALOG_BUTTON:
@@ -176,36 +116,43 @@ bool CLibretroDeviceInput::InputEvent(const game_input_event& event)
         break;
 
       case GAME_INPUT_EVENT_ANALOG_STICK:
-        if (index < (int)m_analogSticks.size())
-          m_analogSticks[index] = event.analog_stick;
+        if (index < (int)m_analogStickCount)
+          m_state.analogSticks[index] = event.analog_stick;
         break;
 
       case GAME_INPUT_EVENT_ACCELEROMETER:
-        if (index < (int)m_accelerometers.size())
-          m_accelerometers[index] = event.accelerometer;
-        break;
-
-      case GAME_INPUT_EVENT_RELATIVE_POINTER:
-        if (index < (int)m_relativePointers.size())
-        {
-          CLockObject lock(m_relativePtrMutex);
-
-          m_relativePointers[index].x += event.rel_pointer.x;
-          m_relativePointers[index].y += event.rel_pointer.y;
-        }
+        if (index < (int)m_accelerometerCount)
+          m_state.accelerometer = event.accelerometer;
         break;
 
       case GAME_INPUT_EVENT_ABSOLUTE_POINTER:
-        if (index < (int)m_absolutePointers.size())
-          m_absolutePointers[index] = event.abs_pointer;
+        if (index < (int)m_absolutePointerCount)
+          m_state.absolutePointers[index] = event.abs_pointer;
         break;
 
       default:
         break;
     }
 
+    m_published.Back() = m_state;
+    m_published.Publish();
+
     return true;
   }
 
   return false;
 }
+
+const DeviceInputState& CLibretroDeviceInput::Poll(int& deltaX, int& deltaY)
+{
+  m_relativeMotion.Take(deltaX, deltaY);
+
+  m_published.Update();
+
+  return m_published.Front();
+}
+
+int64_t CLibretroDeviceInput::TakeEventTime(void)
+{
+  return CInputLatency::Take(m_eventTimeNs);
+}
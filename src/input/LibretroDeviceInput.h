@@ -19,36 +19,98 @@
  */
 #pragma once
 
+#include "utils/AtomicDelta.h"
+#include "utils/TripleBuffer.h"
+
 #include "kodi_game_types.h"
 #include "p8-platform/threads/mutex.h"
 
-#include <string>
-#include <vector>
+#include <atomic>
+#include <stdint.h>
+
+#define LIBRETRO_JOYPAD_BUTTON_COUNT     16
+#define LIBRETRO_ANALOG_STICK_COUNT      2
+#define LIBRETRO_ACCELEROMETER_COUNT     1
+#define LIBRETRO_MOUSE_BUTTON_COUNT      9
+#define LIBRETRO_LIGHTGUN_BUTTON_COUNT   7
+#define LIBRETRO_RELATIVE_POINTER_COUNT  1
+#define LIBRETRO_ABSOLUTE_POINTER_COUNT  10
 
 namespace LIBRETRO
 {
   typedef unsigned int libretro_device_t;
 
+  /*!
+   * \brief The complete input state of a device, as seen by the core
+   */
+  struct DeviceInputState
+  {
+    uint32_t                 buttons; // Bit N is set while button N is pressed
+    game_analog_stick_event  analogSticks[LIBRETRO_ANALOG_STICK_COUNT];
+    game_accelerometer_event accelerometer;
+    game_abs_pointer_event   absolutePointers[LIBRETRO_ABSOLUTE_POINTER_COUNT];
+  };
+
+  /*!
+   * \brief Input of a device, handed from the input thread to the emulation
+   *        thread
+   *
+   * Events update a private copy of the state, which is then published. The
+   * emulation thread picks up the latest published state when the core polls
+   * for input, so neither thread ever waits for the other.
+   *
+   * Relative pointer motion isn't a state, so it's accumulated separately
+   * until the next poll. A high-rate mouse only pays for an atomic add.
+   */
   class CLibretroDeviceInput
   {
   public:
     CLibretroDeviceInput(const game_controller* controller);
 
-    bool  ButtonState(unsigned int buttonIndex) const;
-    bool  AnalogStickState(unsigned int analogStickIndex, float& x, float& y) const;
-    bool  AccelerometerState(float& x, float& y, float& z) const;
-    int   RelativePointerDeltaX(void);
-    int   RelativePointerDeltaY(void);
-    bool  AbsolutePointerState(unsigned int pointerIndex, float& x, float& y) const;
+    /*!
+     * \brief Called on the input thread when an input event has occurred
+     *
+     * \param eventTimeNs  Time the event was received, or 0 if input latency
+     *                     isn't being measured
+     */
+    bool InputEvent(const game_input_event& event, int64_t eventTimeNs);
 
-    bool InputEvent(const game_input_event& event);
+    /*!
+     * \brief Get the latest published state
+     *
+     * Called on the emulation thread.
+     *
+     * \param deltaX  The relative pointer motion since the previous poll
+     * \param deltaY  The relative pointer motion since the previous poll
+     */
+    const DeviceInputState& Poll(int& deltaX, int& deltaY);
+
+    /*!
+     * \brief Take the time of the oldest event since the previous call, or 0
+     */
+    int64_t TakeEventTime(void);
+
+    /*!
+     * \brief The number of analog sticks of the controller
+     */
+    unsigned int AnalogStickCount(void) const { return m_analogStickCount; }
 
   private:
-    std::vector<game_digital_button_event> m_buttons;
-    std::vector<game_analog_stick_event>   m_analogSticks;
-    std::vector<game_accelerometer_event>  m_accelerometers;
-    std::vector<game_rel_pointer_event>    m_relativePointers;
-    std::vector<game_abs_pointer_event>    m_absolutePointers;
-    P8PLATFORM::CMutex                     m_relativePtrMutex;
+    // Construction parameters
+    unsigned int m_buttonCount;
+    unsigned int m_analogStickCount;
+    unsigned int m_accelerometerCount;
+    unsigned int m_relativePointerCount;
+    unsigned int m_absolutePointerCount;
+
+    // Input thread
+    DeviceInputState   m_state; // Protected by m_stateMutex
+    P8PLATFORM::CMutex m_stateMutex;
+
+    // Hand-off between threads
+    CTripleBuffer<DeviceInputState> m_published;
+
+    CAtomicDelta                    m_relativeMotion;
+    std::atomic<int64_t>            m_eventTimeNs;
   };
 }
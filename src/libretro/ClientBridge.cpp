@@ -35,7 +35,16 @@ CClientBridge::CClientBridge()
     m_retro_hw_context_reset(nullptr),
     m_retro_hw_context_destroy(nullptr),
     m_retro_audio_set_state_callback(nullptr),
-    m_retro_audio_callback(nullptr)
+    m_retro_audio_callback(nullptr),
+    m_retro_frame_time_callback(nullptr),
+    m_frameTimeReference(0),
+    m_retro_set_eject_state(nullptr),
+    m_retro_get_eject_state(nullptr),
+    m_retro_get_image_index(nullptr),
+    m_retro_set_image_index(nullptr),
+    m_retro_get_num_images(nullptr),
+    m_retro_replace_image_index(nullptr),
+    m_retro_add_image_index(nullptr)
 {
 }
 
@@ -88,3 +97,101 @@ GAME_ERROR CClientBridge::AudioAvailable(void)
 
   return GAME_ERROR_NO_ERROR;
 }
+
+GAME_ERROR CClientBridge::FrameTime(retro_usec_t usec)
+{
+  if (!m_retro_frame_time_callback)
+    return GAME_ERROR_FAILED;
+
+  m_retro_frame_time_callback(usec);
+
+  return GAME_ERROR_NO_ERROR;
+}
+
+void CClientBridge::SetDiskControl(SetEjectStateCallback setEjectState,
+                                   GetEjectStateCallback getEjectState,
+                                   GetImageIndexCallback getImageIndex,
+                                   SetImageIndexCallback setImageIndex,
+                                   GetNumImagesCallback getNumImages,
+                                   ReplaceImageIndexCallback replaceImageIndex,
+                                   AddImageIndexCallback addImageIndex)
+{
+  // The interface is only usable if the core provides the basic functions
+  const bool bValid = setEjectState && getEjectState && getImageIndex && setImageIndex && getNumImages;
+
+  m_retro_set_eject_state     = bValid ? setEjectState : nullptr;
+  m_retro_get_eject_state     = bValid ? getEjectState : nullptr;
+  m_retro_get_image_index     = bValid ? getImageIndex : nullptr;
+  m_retro_set_image_index     = bValid ? setImageIndex : nullptr;
+  m_retro_get_num_images      = bValid ? getNumImages : nullptr;
+  m_retro_replace_image_index = bValid ? replaceImageIndex : nullptr;
+  m_retro_add_image_index     = bValid ? addImageIndex : nullptr;
+}
+
+GAME_ERROR CClientBridge::SetEjectState(bool ejected)
+{
+  if (!m_retro_set_eject_state)
+    return GAME_ERROR_FAILED;
+
+  if (!m_retro_set_eject_state(ejected))
+    return GAME_ERROR_FAILED;
+
+  return GAME_ERROR_NO_ERROR;
+}
+
+bool CClientBridge::GetEjectState(void)
+{
+  if (!m_retro_get_eject_state)
+    return false;
+
+  return m_retro_get_eject_state();
+}
+
+unsigned int CClientBridge::GetImageIndex(void)
+{
+  if (!m_retro_get_image_index)
+    return 0;
+
+  return m_retro_get_image_index();
+}
+
+GAME_ERROR CClientBridge::SetImageIndex(unsigned int index)
+{
+  if (!m_retro_set_image_index)
+    return GAME_ERROR_FAILED;
+
+  if (!m_retro_set_image_index(index))
+    return GAME_ERROR_FAILED;
+
+  return GAME_ERROR_NO_ERROR;
+}
+
+unsigned int CClientBridge::GetNumImages(void)
+{
+  if (!m_retro_get_num_images)
+    return 0;
+
+  return m_retro_get_num_images();
+}
+
+GAME_ERROR CClientBridge::ReplaceImageIndex(unsigned int index, const retro_game_info* info)
+{
+  if (!m_retro_replace_image_index)
+    return GAME_ERROR_NOT_IMPLEMENTED;
+
+  if (!m_retro_replace_image_index(index, info))
+    return GAME_ERROR_FAILED;
+
+  return GAME_ERROR_NO_ERROR;
+}
+
+GAME_ERROR CClientBridge::AddImageIndex(void)
+{
+  if (!m_retro_add_image_index)
+    return GAME_ERROR_NOT_IMPLEMENTED;
+
+  if (!m_retro_add_image_index())
+    return GAME_ERROR_FAILED;
+
+  return GAME_ERROR_NO_ERROR;
+}
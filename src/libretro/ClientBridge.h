@@ -48,17 +48,66 @@ namespace LIBRETRO
     GAME_ERROR AudioEnable(bool enabled);
     GAME_ERROR AudioAvailable(void);
 
+    /*!
+     * \brief Tell the core how much time has passed since its last frame
+     *
+     * Invoked before each call to retro_run().
+     */
+    GAME_ERROR FrameTime(retro_usec_t usec);
+
+    // Disk control interface, used to swap the discs of multi-disc games.
+    // Indices are zero-based.
+    GAME_ERROR SetEjectState(bool ejected);
+    bool GetEjectState(void);
+    unsigned int GetImageIndex(void);
+    GAME_ERROR SetImageIndex(unsigned int index);
+    unsigned int GetNumImages(void);
+    GAME_ERROR ReplaceImageIndex(unsigned int index, const retro_game_info* info);
+    GAME_ERROR AddImageIndex(void);
+
     typedef void (*KeyboardEventCallback)(bool down, unsigned keycode, uint32_t character, uint16_t key_modifiers);
     typedef void (*HwContextResetCallback)(void);
     typedef void (*HwContextDestroyCallback)(void);
     typedef void (*AudioEnableCallback)(bool enabled);
     typedef void (*AudioAvailableCallback)(void);
+    typedef void (*FrameTimeCallback)(retro_usec_t usec);
+    typedef bool (*SetEjectStateCallback)(bool ejected);
+    typedef bool (*GetEjectStateCallback)(void);
+    typedef unsigned (*GetImageIndexCallback)(void);
+    typedef bool (*SetImageIndexCallback)(unsigned index);
+    typedef unsigned (*GetNumImagesCallback)(void);
+    typedef bool (*ReplaceImageIndexCallback)(unsigned index, const retro_game_info* info);
+    typedef bool (*AddImageIndexCallback)(void);
 
     void SetKeyboardEvent(KeyboardEventCallback callback)       { m_retro_keyboard_event = callback; }
     void SetHwContextReset(HwContextResetCallback callback)     { m_retro_hw_context_reset = callback; }
     void SetHwContextDestroy(HwContextDestroyCallback callback) { m_retro_hw_context_destroy = callback; }
     void SetAudioEnable(AudioEnableCallback callback)           { m_retro_audio_set_state_callback = callback; }
     void SetAudioAvailable(AudioAvailableCallback callback)     { m_retro_audio_callback = callback; }
+    void SetFrameTime(FrameTimeCallback callback, retro_usec_t reference) { m_retro_frame_time_callback = callback; m_frameTimeReference = reference; }
+
+    void SetDiskControl(SetEjectStateCallback setEjectState,
+                        GetEjectStateCallback getEjectState,
+                        GetImageIndexCallback getImageIndex,
+                        SetImageIndexCallback setImageIndex,
+                        GetNumImagesCallback getNumImages,
+                        ReplaceImageIndexCallback replaceImageIndex,
+                        AddImageIndexCallback addImageIndex);
+
+    /*!
+     * \brief The duration of one frame as reported by the core, in microseconds
+     */
+    retro_usec_t GetFrameTimeReference(void) const { return m_frameTimeReference; }
+
+    /*!
+     * \brief True if the core renders through a frontend-provided GL context
+     */
+    bool HasHwContext(void) const { return m_retro_hw_context_reset != nullptr; }
+
+    /*!
+     * \brief True if the core can swap discs at run-time
+     */
+    bool HasDiskControl(void) const { return m_retro_set_eject_state != nullptr; }
 
   private:
     // The bridge is accomplished by invoking the callback provided by libretro's
@@ -69,5 +118,15 @@ namespace LIBRETRO
     HwContextDestroyCallback m_retro_hw_context_destroy;
     AudioEnableCallback      m_retro_audio_set_state_callback;
     AudioAvailableCallback   m_retro_audio_callback;
+    FrameTimeCallback        m_retro_frame_time_callback;
+    retro_usec_t             m_frameTimeReference;
+
+    SetEjectStateCallback     m_retro_set_eject_state;
+    GetEjectStateCallback     m_retro_get_eject_state;
+    GetImageIndexCallback     m_retro_get_image_index;
+    SetImageIndexCallback     m_retro_set_image_index;
+    GetNumImagesCallback      m_retro_get_num_images;
+    ReplaceImageIndexCallback m_retro_replace_image_index;
+    AddImageIndexCallback     m_retro_add_image_index;
   };
 } // namespace LIBRETRO
@@ -23,6 +23,12 @@
 #include "LibretroTranslator.h"
 #include "input/ButtonMapper.h"
 #include "input/InputManager.h"
+#include "profiling/FrameProfiler.h"
+#include "profiling/InputLatency.h"
+#include "profiling/PerfCounters.h"
+#include "profiling/TraceRecorder.h"
+#include "utils/CPUFeatures.h"
+#include "utils/TimeUtils.h"
 
 #include "libXBMC_addon.h"
 #include "libKODI_game.h"
@@ -67,9 +73,19 @@ void CFrontendBridge::LogFrontend(retro_log_level level, const char *fmt, ...)
 
 void CFrontendBridge::VideoRefresh(const void* data, unsigned int width, unsigned int height, size_t pitch)
 {
+  CProfileScope profile(PROFILE_PHASE_VIDEO);
+  CTraceScope trace("VideoRefresh");
+
+  if (!CLibretroEnvironment::Get().Video().IsMuted())
+    CInputLatency::Get().FrameOut();
+
   if (data == RETRO_HW_FRAME_BUFFER_VALID)
   {
-    if (CLibretroEnvironment::Get().GetFrontend())
+    if (CLibretroEnvironment::Get().Video().IsMuted())
+    {
+      // Frame isn't presented
+    }
+    else if (CLibretroEnvironment::Get().GetFrontend())
       CLibretroEnvironment::Get().GetFrontend()->RenderFrame();
   }
   else if (data == nullptr)
@@ -89,11 +105,16 @@ void CFrontendBridge::VideoRefresh(const void* data, unsigned int width, unsigne
 
 void CFrontendBridge::AudioFrame(int16_t left, int16_t right)
 {
+  CProfileScope profile(PROFILE_PHASE_AUDIO);
+
   CLibretroEnvironment::Get().Audio().AddFrame_S16NE(left, right);
 }
 
 size_t CFrontendBridge::AudioFrames(const int16_t* data, size_t frames)
 {
+  CProfileScope profile(PROFILE_PHASE_AUDIO);
+  CTraceScope trace("AudioFrames");
+
   CLibretroEnvironment::Get().Audio().AddFrames_S16NE(reinterpret_cast<const uint8_t*>(data),
                                                       frames * S16NE_FRAMESIZE);
 
@@ -102,21 +123,36 @@ size_t CFrontendBridge::AudioFrames(const int16_t* data, size_t frames)
 
 void CFrontendBridge::InputPoll(void)
 {
-  // Not needed
+  CProfileScope profile(PROFILE_PHASE_INPUT);
+  CTraceScope trace("InputPoll");
+
+  CInputManager::Get().Poll();
 }
 
 int16_t CFrontendBridge::InputState(unsigned int port, unsigned int device, unsigned int index, unsigned int id)
 {
+  CProfileScope profile(PROFILE_PHASE_INPUT);
+
   int16_t inputState = 0;
 
   // According to libretro.h, device should already be masked, but just in case
   device &= RETRO_DEVICE_MASK;
 
+  CInputLatency::Get().Observed(CInputManager::GetSlot(device, port));
+
+  // The keyboard isn't tied to a port
+  if (device == RETRO_DEVICE_KEYBOARD)
+    return CInputManager::Get().KeyboardState(id) ? 1 : 0;
+
+  const PortSnapshot* snapshot = CInputManager::Get().GetSnapshot(device, port);
+  if (snapshot == nullptr)
+    return 0;
+
   switch (device)
   {
   case RETRO_DEVICE_JOYPAD:
-  //case RETRO_DEVICE_KEYBOARD: // TODO
-    inputState = CInputManager::Get().ButtonState(device, port, id) ? 1 : 0;
+    if (id < 32)
+      inputState = (snapshot->buttons >> id) & 1;
     break;
 
   case RETRO_DEVICE_MOUSE:
@@ -127,58 +163,36 @@ int16_t CFrontendBridge::InputState(unsigned int port, unsigned int device, unsi
     switch (id)
     {
       case RETRO_DEVICE_ID_MOUSE_X:
-        inputState = CInputManager::Get().DeltaX(device, port);
+        inputState = snapshot->relative[0];
         break;
       case RETRO_DEVICE_ID_MOUSE_Y:
-        inputState = CInputManager::Get().DeltaY(device, port);
+        inputState = snapshot->relative[1];
         break;
       default:
       {
-        inputState = CInputManager::Get().ButtonState(device, port, id) ? 1 : 0;
+        if (id < 32)
+          inputState = (snapshot->buttons >> id) & 1;
         break;
       }
     }
     break;
 
   case RETRO_DEVICE_ANALOG:
-  {
-    float x, y;
-    if (CInputManager::Get().AnalogStickState(port, index, x, y))
-    {
-      if (id == RETRO_DEVICE_ID_ANALOG_X)
-      {
-        const float normalized = (x + 1.0f) / 2.0f;
-        inputState = (int)(normalized * 0xffff) - 0x8000;
-      }
-      else if (id == RETRO_DEVICE_ID_ANALOG_Y)
-      {
-        const float normalized = (-y + 1.0f) / 2.0f; // y axis is inverted
-        inputState = (int)(normalized * 0xffff) - 0x8000;
-      }
-    }
+    if (index < LIBRETRO_ANALOG_STICK_COUNT && id <= RETRO_DEVICE_ID_ANALOG_Y)
+      inputState = snapshot->analog[index][id];
     break;
-  }
 
   case RETRO_DEVICE_POINTER:
-  {
-    float x, y;
-    if (CInputManager::Get().AbsolutePointerState(port, index, x, y))
+    if (index < LIBRETRO_ABSOLUTE_POINTER_COUNT)
     {
       if (id == RETRO_DEVICE_ID_POINTER_X)
-      {
-        inputState = (int)(x * 0x7fff);
-      }
+        inputState = snapshot->pointers[index][0];
       else if (id == RETRO_DEVICE_ID_POINTER_Y)
-      {
-        inputState = (int)(y * 0x7fff);
-      }
+        inputState = snapshot->pointers[index][1];
       else if (id == RETRO_DEVICE_ID_POINTER_PRESSED)
-      {
-        inputState = 1;
-      }
+        inputState = (snapshot->pointersPressed >> index) & 1;
     }
     break;
-  }
 
   default:
     break;
@@ -237,19 +251,19 @@ float CFrontendBridge::SensorGetInput(unsigned port, unsigned id)
 {
   float axisState = 0.0f;
 
-  float x, y, z;
-  if (CInputManager::Get().AccelerometerState(port, x, y, z))
+  const PortSnapshot* snapshot = CInputManager::Get().GetSnapshot(RETRO_DEVICE_NONE, port);
+  if (snapshot != nullptr)
   {
     switch (id)
     {
     case RETRO_SENSOR_ACCELEROMETER_X:
-      axisState = x;
+      axisState = snapshot->accelerometer[0];
       break;
     case RETRO_SENSOR_ACCELEROMETER_Y:
-      axisState = y;
+      axisState = snapshot->accelerometer[1];
       break;
     case RETRO_SENSOR_ACCELEROMETER_Z:
-      axisState = z;
+      axisState = snapshot->accelerometer[2];
       break;
     default:
       break;
@@ -271,37 +285,37 @@ void CFrontendBridge::StopCamera(void)
 
 retro_time_t CFrontendBridge::PerfGetTimeUsec(void)
 {
-  return 0; // Not implemented
+  return TimeUtils::GetTimeUsec();
 }
 
 retro_perf_tick_t CFrontendBridge::PerfGetCounter(void)
 {
-  return 0; // Not implemented
+  return CPUFeatures::GetCycleCount();
 }
 
 uint64_t CFrontendBridge::PerfGetCpuFeatures(void)
 {
-  return 0; // Not implemented
+  return CPUFeatures::GetSIMDFeatures();
 }
 
 void CFrontendBridge::PerfLog(void)
 {
-  // Not implemented
+  CPerfCounters::Get().Log();
 }
 
 void CFrontendBridge::PerfRegister(retro_perf_counter *counter)
 {
-  // Not implemented
+  CPerfCounters::Get().Register(counter);
 }
 
 void CFrontendBridge::PerfStart(retro_perf_counter *counter)
 {
-  // Not implemented
+  CPerfCounters::Start(counter);
 }
 
 void CFrontendBridge::PerfStop(retro_perf_counter *counter)
 {
-  // Not implemented
+  CPerfCounters::Stop(counter);
 }
 
 bool CFrontendBridge::StartLocation(void)
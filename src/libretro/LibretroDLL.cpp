@@ -20,6 +20,7 @@
 
 #include "LibretroDLL.h"
 #include "log/Log.h"
+#include "profiling/TraceRecorder.h"
 
 #include "libKODI_game.h"
 #include "kodi_game_types.h"
@@ -88,6 +89,8 @@ bool RegisterSymbol(void* dll, T& functionPtr, const char* strFunctionPtr)
 
 bool CLibretroDLL::Load(const AddonProps_Game* gameClientProps)
 {
+  CTraceScope trace("CLibretroDLL::Load");
+
   Unload();
 
   m_libretroClient = dlopen(gameClientProps->game_client_dll_path, RTLD_LAZY);
@@ -35,3 +35,20 @@
  * retro_get_memory_data().
  */
 #define LIBRETRO_SAVE_DIRECTORY_NAME  "save"
+
+/*!
+ * \brief The cache directory of the add-on
+ *
+ * This directory holds extracted archives so that they don't need to be
+ * extracted every time a game is launched. It is not exposed to cores.
+ */
+#define LIBRETRO_CACHE_DIRECTORY_NAME  "cache"
+
+/*!
+ * \brief The staging directory of the add-on
+ *
+ * Cores that can only load by path receive a local copy of content found on
+ * network shares and other VFS locations. The copies are kept here so that
+ * later launches don't copy them again.
+ */
+#define LIBRETRO_STAGING_DIRECTORY_NAME  "staging"
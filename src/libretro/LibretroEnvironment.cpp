@@ -25,6 +25,7 @@
 #include "LibretroDLL.h"
 #include "LibretroTranslator.h"
 #include "input/InputManager.h"
+#include "profiling/FrameProfiler.h"
 #include "settings/Settings.h"
 
 #include "libKODI_game.h"
@@ -90,6 +91,7 @@ void CLibretroEnvironment::Deinitialize()
 {
   m_resources.Deinitialize();
   m_settings.Deinitialize();
+  m_subsystems.Clear();
 
   m_videoStream.Deinitialize();
   m_audioStream.Deinitialize();
@@ -107,6 +109,8 @@ std::string CLibretroEnvironment::GetResourcePath(const char* relPath)
 
 bool CLibretroEnvironment::EnvironmentCallback(unsigned int cmd, void *data)
 {
+  CProfileScope profile(PROFILE_PHASE_ENVIRONMENT);
+
   if (!m_frontend || !m_clientBridge)
     return false;
 
@@ -195,8 +199,14 @@ bool CLibretroEnvironment::EnvironmentCallback(unsigned int cmd, void *data)
       const retro_disk_control_callback *typedData = reinterpret_cast<const retro_disk_control_callback*>(data);
       if (typedData)
       {
-        // Disk control interface not implemented
-        return false;
+        // Store callbacks from libretro client
+        m_clientBridge->SetDiskControl(typedData->set_eject_state,
+                                       typedData->get_eject_state,
+                                       typedData->get_image_index,
+                                       typedData->set_image_index,
+                                       typedData->get_num_images,
+                                       typedData->replace_image_index,
+                                       typedData->add_image_index);
       }
       break;
     }
@@ -297,8 +307,8 @@ bool CLibretroEnvironment::EnvironmentCallback(unsigned int cmd, void *data)
       const retro_frame_time_callback *typedData = reinterpret_cast<const retro_frame_time_callback*>(data);
       if (typedData)
       {
-        // Frame time callback not implemented
-        return false;
+        // Store callback from libretro client
+        m_clientBridge->SetFrameTime(typedData->callback, typedData->reference);
       }
       break;
     }
@@ -431,8 +441,7 @@ bool CLibretroEnvironment::EnvironmentCallback(unsigned int cmd, void *data)
     const retro_subsystem_info* typedData = reinterpret_cast<const retro_subsystem_info*>(data);
     if (typedData)
     {
-      // Not implemented
-      return false;
+      m_subsystems.SetSubsystems(typedData);
     }
     break;
   }
@@ -20,6 +20,7 @@
 #pragma once
 
 #include "LibretroResources.h"
+#include "LibretroSubsystems.h"
 #include "audio/AudioStream.h"
 #include "settings/LibretroSettings.h"
 #include "video/VideoStream.h"
@@ -76,6 +77,15 @@ namespace LIBRETRO
 
     std::string GetResourcePath(const char* relPath);
 
+    std::string GetProfileDirectory(void) const { return m_resources.GetProfileDirectory(); }
+    std::string GetCacheDirectory(void) const { return m_resources.GetCacheDirectory(); }
+    std::string GetStagingDirectory(void) const { return m_resources.GetStagingDirectory(); }
+
+    /*!
+     * The subsystems reported by the core, used to load special content
+     */
+    const CLibretroSubsystems& Subsystems(void) const { return m_subsystems; }
+
     bool EnvironmentCallback(unsigned cmd, void* data);
 
   private:
@@ -94,5 +104,6 @@ namespace LIBRETRO
 
     CLibretroSettings m_settings;
     CLibretroResources m_resources;
+    CLibretroSubsystems m_subsystems;
   };
 } // namespace LIBRETRO
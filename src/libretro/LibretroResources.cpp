@@ -72,9 +72,10 @@ void CLibretroResources::Initialize(ADDON::CHelper_libXBMC_addon* addon, const A
 
   if (gameClientProps->profile_directory != nullptr)
   {
-    m_saveDirectory = gameClientProps->profile_directory;
-    PathUtils::RemoveSlashAtEnd(m_saveDirectory);
-    m_saveDirectory += "/" LIBRETRO_SAVE_DIRECTORY_NAME;
+    m_profileDirectory = gameClientProps->profile_directory;
+    PathUtils::RemoveSlashAtEnd(m_profileDirectory);
+
+    m_saveDirectory = m_profileDirectory + "/" LIBRETRO_SAVE_DIRECTORY_NAME;
 
     // Ensure folder exists
     if (!m_addon->DirectoryExists(m_saveDirectory.c_str()))
@@ -82,6 +83,22 @@ void CLibretroResources::Initialize(ADDON::CHelper_libXBMC_addon* addon, const A
       dsyslog("Creating save directory: %s", m_saveDirectory.c_str());
       m_addon->CreateDirectory(m_saveDirectory.c_str());
     }
+
+    m_cacheDirectory = m_profileDirectory + "/" LIBRETRO_CACHE_DIRECTORY_NAME;
+
+    if (!m_addon->DirectoryExists(m_cacheDirectory.c_str()))
+    {
+      dsyslog("Creating cache directory: %s", m_cacheDirectory.c_str());
+      m_addon->CreateDirectory(m_cacheDirectory.c_str());
+    }
+
+    m_stagingDirectory = m_profileDirectory + "/" LIBRETRO_STAGING_DIRECTORY_NAME;
+
+    if (!m_addon->DirectoryExists(m_stagingDirectory.c_str()))
+    {
+      dsyslog("Creating staging directory: %s", m_stagingDirectory.c_str());
+      m_addon->CreateDirectory(m_stagingDirectory.c_str());
+    }
   }
 }
 
@@ -41,6 +41,9 @@ namespace LIBRETRO
     const char* GetSystemDir() const { return m_systemDirectory.c_str(); }
     const char* GetContentDirectory() { return GetSystemDir(); } // Use system directory
     const char* GetSaveDirectory() const { return m_saveDirectory.c_str(); }
+    const char* GetProfileDirectory() const { return m_profileDirectory.c_str(); }
+    const char* GetCacheDirectory() const { return m_cacheDirectory.c_str(); }
+    const char* GetStagingDirectory() const { return m_stagingDirectory.c_str(); }
 
     const char* GetBasePath(const std::string& relPath);
     const char* GetBaseSystemPath(const std::string& relPath);
@@ -56,5 +59,8 @@ namespace LIBRETRO
     std::map<std::string, std::string> m_pathMap;
     std::string                        m_systemDirectory;
     std::string                        m_saveDirectory;
+    std::string                        m_profileDirectory;
+    std::string                        m_cacheDirectory;
+    std::string                        m_stagingDirectory;
   };
 } // namespace LIBRETRO
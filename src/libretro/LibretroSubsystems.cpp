@@ -0,0 +1,113 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "LibretroSubsystems.h"
+#include "libretro.h"
+#include "log/Log.h"
+
+using namespace LIBRETRO;
+
+// Game types of retro_load_game_special() from before subsystems existed
+#define RETRO_GAME_TYPE_BSX             0x101
+#define RETRO_GAME_TYPE_BSX_SLOTTED     0x102
+#define RETRO_GAME_TYPE_SUFAMI_TURBO    0x103
+#define RETRO_GAME_TYPE_SUPER_GAME_BOY  0x104
+
+namespace
+{
+  struct SpecialGameType
+  {
+    SPECIAL_GAME_TYPE type;
+    unsigned int      legacyId;
+    const char*       idents[2];
+  };
+
+  const SpecialGameType specialGameTypes[] =
+  {
+    { SPECIAL_GAME_TYPE_BSX,            RETRO_GAME_TYPE_BSX,            { "bsx",     nullptr      } },
+    { SPECIAL_GAME_TYPE_BSX_SLOTTED,    RETRO_GAME_TYPE_BSX_SLOTTED,    { "bsxslot", "bsxslotted" } },
+    { SPECIAL_GAME_TYPE_SUFAMI_TURBO,   RETRO_GAME_TYPE_SUFAMI_TURBO,   { "sufami",  nullptr      } },
+    { SPECIAL_GAME_TYPE_SUPER_GAME_BOY, RETRO_GAME_TYPE_SUPER_GAME_BOY, { "sgb",     nullptr      } },
+  };
+}
+
+void CLibretroSubsystems::SetSubsystems(const retro_subsystem_info* subsystems)
+{
+  m_subsystems.clear();
+
+  dsyslog("Libretro subsystems:");
+  dsyslog("------------------------------------------------------------");
+
+  // The array is terminated by a zeroed entry
+  for (const retro_subsystem_info* info = subsystems; info->ident != nullptr; info++)
+  {
+    LibretroSubsystem subsystem;
+    subsystem.description = info->desc ? info->desc : "";
+    subsystem.ident = info->ident;
+    subsystem.id = info->id;
+
+    for (unsigned int i = 0; i < info->num_roms; i++)
+    {
+      const retro_subsystem_rom_info& romInfo = info->roms[i];
+
+      LibretroSubsystemRom rom;
+      rom.description = romInfo.desc ? romInfo.desc : "";
+      rom.extensions = romInfo.valid_extensions ? romInfo.valid_extensions : "";
+      rom.bNeedFullPath = romInfo.need_fullpath;
+      rom.bBlockExtract = romInfo.block_extract;
+      rom.bRequired = romInfo.required;
+      subsystem.roms.push_back(rom);
+    }
+
+    dsyslog("Subsystem: \"%s\" (%s, id 0x%x), %u content file(s)",
+            subsystem.description.c_str(), subsystem.ident.c_str(), subsystem.id,
+            static_cast<unsigned int>(subsystem.roms.size()));
+
+    m_subsystems.push_back(std::move(subsystem));
+  }
+
+  dsyslog("------------------------------------------------------------");
+}
+
+const LibretroSubsystem* CLibretroSubsystems::GetSubsystem(SPECIAL_GAME_TYPE type) const
+{
+  for (const SpecialGameType& specialType : specialGameTypes)
+  {
+    if (specialType.type != type)
+      continue;
+
+    for (const LibretroSubsystem& subsystem : m_subsystems)
+    {
+      for (const char* ident : specialType.idents)
+      {
+        if (ident != nullptr && subsystem.ident == ident)
+          return &subsystem;
+      }
+    }
+
+    for (const LibretroSubsystem& subsystem : m_subsystems)
+    {
+      if (subsystem.id == specialType.legacyId)
+        return &subsystem;
+    }
+  }
+
+  return nullptr;
+}
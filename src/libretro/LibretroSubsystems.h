@@ -0,0 +1,70 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include "kodi_game_types.h"
+
+#include <string>
+#include <vector>
+
+struct retro_subsystem_info;
+
+namespace LIBRETRO
+{
+  struct LibretroSubsystemRom
+  {
+    std::string description;
+    std::string extensions;
+    bool        bNeedFullPath;
+    bool        bBlockExtract;
+    bool        bRequired;
+  };
+
+  struct LibretroSubsystem
+  {
+    std::string                       description;
+    std::string                       ident;
+    unsigned int                      id; // The type passed to retro_load_game_special()
+    std::vector<LibretroSubsystemRom> roms;
+  };
+
+  /*!
+   * \brief Copy of the subsystems reported by RETRO_ENVIRONMENT_SET_SUBSYSTEM_INFO
+   *
+   * Kodi identifies special content by SPECIAL_GAME_TYPE. Each type is matched
+   * to a subsystem by its identifier, or by the game type that libretro used
+   * for the same content before subsystems existed.
+   */
+  class CLibretroSubsystems
+  {
+  public:
+    void SetSubsystems(const retro_subsystem_info* subsystems);
+    void Clear(void) { m_subsystems.clear(); }
+
+    /*!
+     * \brief Get the subsystem for a type of special content, or nullptr if
+     *        the core doesn't support it
+     */
+    const LibretroSubsystem* GetSubsystem(SPECIAL_GAME_TYPE type) const;
+
+  private:
+    std::vector<LibretroSubsystem> m_subsystems;
+  };
+} // namespace LIBRETRO
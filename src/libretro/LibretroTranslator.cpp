@@ -19,6 +19,7 @@
  */
 
 #include "LibretroTranslator.h"
+#include "utils/StringTable.h"
 
 using namespace LIBRETRO;
 
@@ -80,109 +81,138 @@ GAME_HW_CONTEXT_TYPE LibretroTranslator::GetHWContextType(retro_hw_context_type
 
 // --- Input translation --------------------------------------------------
 
+namespace
+{
+  // Tables must be kept in strcmp() order, see StringTable
+
+  constexpr StringTableEntry<libretro_device_t> DeviceTypesV1[] =
+  {
+    { "analog",    RETRO_DEVICE_ANALOG },
+    { "joypad",    RETRO_DEVICE_JOYPAD },
+    { "keyboard",  RETRO_DEVICE_KEYBOARD },
+    { "lightgun",  RETRO_DEVICE_LIGHTGUN },
+    { "mouse",     RETRO_DEVICE_MOUSE },
+    { "pointer",   RETRO_DEVICE_POINTER },
+  };
+  static_assert(StringTable::IsSorted(DeviceTypesV1), "DeviceTypesV1 must be sorted");
+
+  constexpr StringTableEntry<libretro_device_t> DeviceTypesV2[] =
+  {
+    { "RETRO_DEVICE_ANALOG",    RETRO_DEVICE_ANALOG },
+    { "RETRO_DEVICE_JOYPAD",    RETRO_DEVICE_JOYPAD },
+    { "RETRO_DEVICE_KEYBOARD",  RETRO_DEVICE_KEYBOARD },
+    { "RETRO_DEVICE_LIGHTGUN",  RETRO_DEVICE_LIGHTGUN },
+    { "RETRO_DEVICE_MOUSE",     RETRO_DEVICE_MOUSE },
+    { "RETRO_DEVICE_POINTER",   RETRO_DEVICE_POINTER },
+  };
+  static_assert(StringTable::IsSorted(DeviceTypesV2), "DeviceTypesV2 must be sorted");
+
+  constexpr StringTableEntry<const char*> FeaturesV1[] =
+  {
+    { "a",           "RETRO_DEVICE_ID_JOYPAD_A" },
+    { "b",           "RETRO_DEVICE_ID_JOYPAD_B" },
+    { "down",        "RETRO_DEVICE_ID_JOYPAD_DOWN" },
+    { "l",           "RETRO_DEVICE_ID_JOYPAD_L" },
+    { "l2",          "RETRO_DEVICE_ID_JOYPAD_L2" },
+    { "l3",          "RETRO_DEVICE_ID_JOYPAD_L3" },
+    { "left",        "RETRO_DEVICE_ID_JOYPAD_LEFT" },
+    { "leftstick",   "RETRO_DEVICE_INDEX_ANALOG_LEFT" },
+    { "r",           "RETRO_DEVICE_ID_JOYPAD_R" },
+    { "r2",          "RETRO_DEVICE_ID_JOYPAD_R2" },
+    { "r3",          "RETRO_DEVICE_ID_JOYPAD_R3" },
+    { "right",       "RETRO_DEVICE_ID_JOYPAD_RIGHT" },
+    { "rightstick",  "RETRO_DEVICE_INDEX_ANALOG_RIGHT" },
+    { "select",      "RETRO_DEVICE_ID_JOYPAD_SELECT" },
+    { "start",       "RETRO_DEVICE_ID_JOYPAD_START" },
+    { "strong",      "RETRO_RUMBLE_STRONG" },
+    { "up",          "RETRO_DEVICE_ID_JOYPAD_UP" },
+    { "weak",        "RETRO_RUMBLE_WEAK" },
+    { "x",           "RETRO_DEVICE_ID_JOYPAD_X" },
+    { "y",           "RETRO_DEVICE_ID_JOYPAD_Y" },
+  };
+  static_assert(StringTable::IsSorted(FeaturesV1), "FeaturesV1 must be sorted");
+
+  constexpr StringTableEntry<int> FeatureIndicesV2[] =
+  {
+    { "RETRO_DEVICE_ID_JOYPAD_A",               RETRO_DEVICE_ID_JOYPAD_A },
+    { "RETRO_DEVICE_ID_JOYPAD_B",               RETRO_DEVICE_ID_JOYPAD_B },
+    { "RETRO_DEVICE_ID_JOYPAD_DOWN",            RETRO_DEVICE_ID_JOYPAD_DOWN },
+    { "RETRO_DEVICE_ID_JOYPAD_L",               RETRO_DEVICE_ID_JOYPAD_L },
+    { "RETRO_DEVICE_ID_JOYPAD_L2",              RETRO_DEVICE_ID_JOYPAD_L2 },
+    { "RETRO_DEVICE_ID_JOYPAD_L3",              RETRO_DEVICE_ID_JOYPAD_L3 },
+    { "RETRO_DEVICE_ID_JOYPAD_LEFT",            RETRO_DEVICE_ID_JOYPAD_LEFT },
+    { "RETRO_DEVICE_ID_JOYPAD_R",               RETRO_DEVICE_ID_JOYPAD_R },
+    { "RETRO_DEVICE_ID_JOYPAD_R2",              RETRO_DEVICE_ID_JOYPAD_R2 },
+    { "RETRO_DEVICE_ID_JOYPAD_R3",              RETRO_DEVICE_ID_JOYPAD_R3 },
+    { "RETRO_DEVICE_ID_JOYPAD_RIGHT",           RETRO_DEVICE_ID_JOYPAD_RIGHT },
+    { "RETRO_DEVICE_ID_JOYPAD_SELECT",          RETRO_DEVICE_ID_JOYPAD_SELECT },
+    { "RETRO_DEVICE_ID_JOYPAD_START",           RETRO_DEVICE_ID_JOYPAD_START },
+    { "RETRO_DEVICE_ID_JOYPAD_UP",              RETRO_DEVICE_ID_JOYPAD_UP },
+    { "RETRO_DEVICE_ID_JOYPAD_X",               RETRO_DEVICE_ID_JOYPAD_X },
+    { "RETRO_DEVICE_ID_JOYPAD_Y",               RETRO_DEVICE_ID_JOYPAD_Y },
+    { "RETRO_DEVICE_ID_LIGHTGUN_CURSOR",        RETRO_DEVICE_ID_LIGHTGUN_CURSOR },
+    { "RETRO_DEVICE_ID_LIGHTGUN_PAUSE",         RETRO_DEVICE_ID_LIGHTGUN_PAUSE },
+    { "RETRO_DEVICE_ID_LIGHTGUN_START",         RETRO_DEVICE_ID_LIGHTGUN_START },
+    { "RETRO_DEVICE_ID_LIGHTGUN_TRIGGER",       RETRO_DEVICE_ID_LIGHTGUN_TRIGGER },
+    { "RETRO_DEVICE_ID_LIGHTGUN_TURBO",         RETRO_DEVICE_ID_LIGHTGUN_TURBO },
+    { "RETRO_DEVICE_ID_MOUSE_HORIZ_WHEELDOWN",  RETRO_DEVICE_ID_MOUSE_HORIZ_WHEELDOWN },
+    { "RETRO_DEVICE_ID_MOUSE_HORIZ_WHEELUP",    RETRO_DEVICE_ID_MOUSE_HORIZ_WHEELUP },
+    { "RETRO_DEVICE_ID_MOUSE_LEFT",             RETRO_DEVICE_ID_MOUSE_LEFT },
+    { "RETRO_DEVICE_ID_MOUSE_MIDDLE",           RETRO_DEVICE_ID_MOUSE_MIDDLE },
+    { "RETRO_DEVICE_ID_MOUSE_RIGHT",            RETRO_DEVICE_ID_MOUSE_RIGHT },
+    { "RETRO_DEVICE_ID_MOUSE_WHEELDOWN",        RETRO_DEVICE_ID_MOUSE_WHEELDOWN },
+    { "RETRO_DEVICE_ID_MOUSE_WHEELUP",          RETRO_DEVICE_ID_MOUSE_WHEELUP },
+    { "RETRO_DEVICE_INDEX_ANALOG_LEFT",         RETRO_DEVICE_INDEX_ANALOG_LEFT },
+    { "RETRO_DEVICE_INDEX_ANALOG_RIGHT",        RETRO_DEVICE_INDEX_ANALOG_RIGHT },
+    { "RETRO_DEVICE_LIGHTGUN",                  0 }, // Only 1 relative pointer
+    { "RETRO_DEVICE_MOUSE",                     0 }, // Only 1 relative pointer
+    { "RETRO_RUMBLE_STRONG",                    RETRO_RUMBLE_STRONG },
+    { "RETRO_RUMBLE_WEAK",                      RETRO_RUMBLE_WEAK },
+  };
+  static_assert(StringTable::IsSorted(FeatureIndicesV2), "FeatureIndicesV2 must be sorted");
+}
+
 libretro_device_t LibretroTranslator::GetDeviceTypeV1(const std::string& strType)
 {
-  if (strType == "joypad")   return RETRO_DEVICE_JOYPAD;
-  if (strType == "mouse")    return RETRO_DEVICE_MOUSE;
-  if (strType == "keyboard") return RETRO_DEVICE_KEYBOARD;
-  if (strType == "lightgun") return RETRO_DEVICE_LIGHTGUN;
-  if (strType == "analog")   return RETRO_DEVICE_ANALOG;
-  if (strType == "pointer")  return RETRO_DEVICE_POINTER;
+  const libretro_device_t* type = StringTable::Find(DeviceTypesV1, strType.c_str());
+  if (type != nullptr)
+    return *type;
 
   return RETRO_DEVICE_NONE;
 }
 
 libretro_device_t LibretroTranslator::GetDeviceTypeV2(const std::string& strLibretroType)
 {
-  if (strLibretroType == "RETRO_DEVICE_JOYPAD")   return RETRO_DEVICE_JOYPAD;
-  if (strLibretroType == "RETRO_DEVICE_MOUSE")    return RETRO_DEVICE_MOUSE;
-  if (strLibretroType == "RETRO_DEVICE_KEYBOARD") return RETRO_DEVICE_KEYBOARD;
-  if (strLibretroType == "RETRO_DEVICE_LIGHTGUN") return RETRO_DEVICE_LIGHTGUN;
-  if (strLibretroType == "RETRO_DEVICE_ANALOG")   return RETRO_DEVICE_ANALOG;
-  if (strLibretroType == "RETRO_DEVICE_POINTER")  return RETRO_DEVICE_POINTER;
+  const libretro_device_t* type = StringTable::Find(DeviceTypesV2, strLibretroType.c_str());
+  if (type != nullptr)
+    return *type;
 
   return RETRO_DEVICE_NONE;
 }
 
 const char* LibretroTranslator::GetDeviceName(libretro_device_t type)
 {
-  switch (type)
-  {
-  case RETRO_DEVICE_JOYPAD:   return "RETRO_DEVICE_JOYPAD";
-  case RETRO_DEVICE_MOUSE:    return "RETRO_DEVICE_MOUSE";
-  case RETRO_DEVICE_KEYBOARD: return "RETRO_DEVICE_KEYBOARD";
-  case RETRO_DEVICE_LIGHTGUN: return "RETRO_DEVICE_LIGHTGUN";
-  case RETRO_DEVICE_ANALOG:   return "RETRO_DEVICE_ANALOG";
-  case RETRO_DEVICE_POINTER:  return "RETRO_DEVICE_POINTER";
-  default:
-    break;
-  }
+  const char* name = StringTable::FindName(DeviceTypesV2, type);
+  if (name != nullptr)
+    return name;
 
   return "";
 }
 
 std::string LibretroTranslator::GetFeatureV2(const std::string& strLibretroFeature)
 {
-  if (strLibretroFeature == "a")           return "RETRO_DEVICE_ID_JOYPAD_A";
-  if (strLibretroFeature == "b")           return "RETRO_DEVICE_ID_JOYPAD_B";
-  if (strLibretroFeature == "x")           return "RETRO_DEVICE_ID_JOYPAD_X";
-  if (strLibretroFeature == "y")           return "RETRO_DEVICE_ID_JOYPAD_Y";
-  if (strLibretroFeature == "start")       return "RETRO_DEVICE_ID_JOYPAD_START";
-  if (strLibretroFeature == "select")      return "RETRO_DEVICE_ID_JOYPAD_SELECT";
-  if (strLibretroFeature == "up")          return "RETRO_DEVICE_ID_JOYPAD_UP";
-  if (strLibretroFeature == "down")        return "RETRO_DEVICE_ID_JOYPAD_DOWN";
-  if (strLibretroFeature == "right")       return "RETRO_DEVICE_ID_JOYPAD_RIGHT";
-  if (strLibretroFeature == "left")        return "RETRO_DEVICE_ID_JOYPAD_LEFT";
-  if (strLibretroFeature == "l")           return "RETRO_DEVICE_ID_JOYPAD_L";
-  if (strLibretroFeature == "r")           return "RETRO_DEVICE_ID_JOYPAD_R";
-  if (strLibretroFeature == "l2")          return "RETRO_DEVICE_ID_JOYPAD_L2";
-  if (strLibretroFeature == "r2")          return "RETRO_DEVICE_ID_JOYPAD_R2";
-  if (strLibretroFeature == "l3")          return "RETRO_DEVICE_ID_JOYPAD_L3";
-  if (strLibretroFeature == "r3")          return "RETRO_DEVICE_ID_JOYPAD_R3";
-  if (strLibretroFeature == "leftstick")   return "RETRO_DEVICE_INDEX_ANALOG_LEFT";
-  if (strLibretroFeature == "rightstick")  return "RETRO_DEVICE_INDEX_ANALOG_RIGHT";
-  if (strLibretroFeature == "strong")      return "RETRO_RUMBLE_STRONG";
-  if (strLibretroFeature == "weak")        return "RETRO_RUMBLE_WEAK";
+  const char* const* feature = StringTable::Find(FeaturesV1, strLibretroFeature.c_str());
+  if (feature != nullptr)
+    return *feature;
 
   return "";
 }
 
 int LibretroTranslator::GetFeatureIndexV2(const std::string& strLibretroFeature)
 {
-  if (strLibretroFeature == "RETRO_DEVICE_ID_JOYPAD_A")              return RETRO_DEVICE_ID_JOYPAD_A;
-  if (strLibretroFeature == "RETRO_DEVICE_ID_JOYPAD_B")              return RETRO_DEVICE_ID_JOYPAD_B;
-  if (strLibretroFeature == "RETRO_DEVICE_ID_JOYPAD_X")              return RETRO_DEVICE_ID_JOYPAD_X;
-  if (strLibretroFeature == "RETRO_DEVICE_ID_JOYPAD_Y")              return RETRO_DEVICE_ID_JOYPAD_Y;
-  if (strLibretroFeature == "RETRO_DEVICE_ID_JOYPAD_START")          return RETRO_DEVICE_ID_JOYPAD_START;
-  if (strLibretroFeature == "RETRO_DEVICE_ID_JOYPAD_SELECT")         return RETRO_DEVICE_ID_JOYPAD_SELECT;
-  if (strLibretroFeature == "RETRO_DEVICE_ID_JOYPAD_UP")             return RETRO_DEVICE_ID_JOYPAD_UP;
-  if (strLibretroFeature == "RETRO_DEVICE_ID_JOYPAD_DOWN")           return RETRO_DEVICE_ID_JOYPAD_DOWN;
-  if (strLibretroFeature == "RETRO_DEVICE_ID_JOYPAD_RIGHT")          return RETRO_DEVICE_ID_JOYPAD_RIGHT;
-  if (strLibretroFeature == "RETRO_DEVICE_ID_JOYPAD_LEFT")           return RETRO_DEVICE_ID_JOYPAD_LEFT;
-  if (strLibretroFeature == "RETRO_DEVICE_ID_JOYPAD_L")              return RETRO_DEVICE_ID_JOYPAD_L;
-  if (strLibretroFeature == "RETRO_DEVICE_ID_JOYPAD_R")              return RETRO_DEVICE_ID_JOYPAD_R;
-  if (strLibretroFeature == "RETRO_DEVICE_ID_JOYPAD_L2")             return RETRO_DEVICE_ID_JOYPAD_L2;
-  if (strLibretroFeature == "RETRO_DEVICE_ID_JOYPAD_R2")             return RETRO_DEVICE_ID_JOYPAD_R2;
-  if (strLibretroFeature == "RETRO_DEVICE_ID_JOYPAD_L3")             return RETRO_DEVICE_ID_JOYPAD_L3;
-  if (strLibretroFeature == "RETRO_DEVICE_ID_JOYPAD_R3")             return RETRO_DEVICE_ID_JOYPAD_R3;
-  if (strLibretroFeature == "RETRO_DEVICE_INDEX_ANALOG_LEFT")        return RETRO_DEVICE_INDEX_ANALOG_LEFT;
-  if (strLibretroFeature == "RETRO_DEVICE_INDEX_ANALOG_RIGHT")       return RETRO_DEVICE_INDEX_ANALOG_RIGHT;
-  if (strLibretroFeature == "RETRO_DEVICE_MOUSE")                    return 0; // Only 1 relative pointer
-  if (strLibretroFeature == "RETRO_DEVICE_ID_MOUSE_LEFT")            return RETRO_DEVICE_ID_MOUSE_LEFT;
-  if (strLibretroFeature == "RETRO_DEVICE_ID_MOUSE_RIGHT")           return RETRO_DEVICE_ID_MOUSE_RIGHT;
-  if (strLibretroFeature == "RETRO_DEVICE_ID_MOUSE_WHEELUP")         return RETRO_DEVICE_ID_MOUSE_WHEELUP;
-  if (strLibretroFeature == "RETRO_DEVICE_ID_MOUSE_WHEELDOWN")       return RETRO_DEVICE_ID_MOUSE_WHEELDOWN;
-  if (strLibretroFeature == "RETRO_DEVICE_ID_MOUSE_MIDDLE")          return RETRO_DEVICE_ID_MOUSE_MIDDLE;
-  if (strLibretroFeature == "RETRO_DEVICE_ID_MOUSE_HORIZ_WHEELUP")   return RETRO_DEVICE_ID_MOUSE_HORIZ_WHEELUP;
-  if (strLibretroFeature == "RETRO_DEVICE_ID_MOUSE_HORIZ_WHEELDOWN") return RETRO_DEVICE_ID_MOUSE_HORIZ_WHEELDOWN;
-  if (strLibretroFeature == "RETRO_DEVICE_LIGHTGUN")                 return 0; // Only 1 relative pointer
-  if (strLibretroFeature == "RETRO_DEVICE_ID_LIGHTGUN_TRIGGER")      return RETRO_DEVICE_ID_LIGHTGUN_TRIGGER;
-  if (strLibretroFeature == "RETRO_DEVICE_ID_LIGHTGUN_CURSOR")       return RETRO_DEVICE_ID_LIGHTGUN_CURSOR;
-  if (strLibretroFeature == "RETRO_DEVICE_ID_LIGHTGUN_TURBO")        return RETRO_DEVICE_ID_LIGHTGUN_TURBO;
-  if (strLibretroFeature == "RETRO_DEVICE_ID_LIGHTGUN_PAUSE")        return RETRO_DEVICE_ID_LIGHTGUN_PAUSE;
-  if (strLibretroFeature == "RETRO_DEVICE_ID_LIGHTGUN_START")        return RETRO_DEVICE_ID_LIGHTGUN_START;
-  if (strLibretroFeature == "RETRO_RUMBLE_STRONG")                   return RETRO_RUMBLE_STRONG;
-  if (strLibretroFeature == "RETRO_RUMBLE_WEAK")                     return RETRO_RUMBLE_WEAK;
+  const int* index = StringTable::Find(FeatureIndicesV2, strLibretroFeature.c_str());
+  if (index != nullptr)
+    return *index;
 
   return -1;
 }
@@ -0,0 +1,197 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "FrameProfiler.h"
+#include "log/Log.h"
+#include "utils/TimeUtils.h"
+
+#include <fstream>
+#include <iomanip>
+
+using namespace LIBRETRO;
+
+namespace
+{
+  const char* GetPhaseName(PROFILE_PHASE phase)
+  {
+    switch (phase)
+    {
+    case PROFILE_PHASE_FRAME:       return "frame";
+    case PROFILE_PHASE_CORE:        return "retro_run";
+    case PROFILE_PHASE_VIDEO:       return "video";
+    case PROFILE_PHASE_AUDIO:       return "audio";
+    case PROFILE_PHASE_INPUT:       return "input";
+    case PROFILE_PHASE_ENVIRONMENT: return "environment";
+    case PROFILE_PHASE_FLUSH:       return "flush";
+    default:
+      break;
+    }
+    return "";
+  }
+}
+
+CFrameProfiler::CFrameProfiler(void) :
+  m_bEnabled(false),
+  m_frameStart(0),
+  m_frameCount(0),
+  m_startTicks(0),
+  m_startUs(0)
+{
+}
+
+CFrameProfiler& CFrameProfiler::Get(void)
+{
+  static CFrameProfiler _instance;
+  return _instance;
+}
+
+void CFrameProfiler::Initialize(void)
+{
+  for (unsigned int i = 0; i < PROFILE_PHASE_COUNT; i++)
+  {
+    m_phases[i].time.Reset();
+    m_phases[i].calls.Reset();
+    m_phases[i].frameTicks = 0;
+    m_phases[i].frameCalls = 0;
+  }
+
+  m_frameStart = 0;
+  m_frameCount = 0;
+  m_startTicks = CPUFeatures::GetCycleCount();
+  m_startUs = TimeUtils::GetTimeUsec();
+
+  m_bEnabled = true;
+}
+
+void CFrameProfiler::Deinitialize(void)
+{
+  m_bEnabled = false;
+}
+
+void CFrameProfiler::BeginFrame(void)
+{
+  if (!m_bEnabled)
+    return;
+
+  for (unsigned int i = 0; i < PROFILE_PHASE_COUNT; i++)
+  {
+    m_phases[i].frameTicks = 0;
+    m_phases[i].frameCalls = 0;
+  }
+
+  m_frameStart = CPUFeatures::GetCycleCount();
+}
+
+void CFrameProfiler::EndFrame(void)
+{
+  if (!m_bEnabled || m_frameStart == 0)
+    return;
+
+  AddPhase(PROFILE_PHASE_FRAME, CPUFeatures::GetCycleCount() - m_frameStart);
+  m_frameStart = 0;
+  m_frameCount++;
+
+  for (unsigned int i = 0; i < PROFILE_PHASE_COUNT; i++)
+  {
+    // Flushing happens on the frontend's thread and is recorded separately
+    if (i == PROFILE_PHASE_FLUSH)
+      continue;
+
+    m_phases[i].time.Add(m_phases[i].frameTicks);
+    m_phases[i].calls.Add(m_phases[i].frameCalls);
+  }
+}
+
+void CFrameProfiler::Record(PROFILE_PHASE phase, uint64_t ticks)
+{
+  if (!m_bEnabled)
+    return;
+
+  m_phases[phase].time.Add(ticks);
+  m_phases[phase].calls.Add(1);
+}
+
+bool CFrameProfiler::Dump(const std::string& path)
+{
+  if (m_frameCount == 0)
+    return false;
+
+  std::ofstream file(path.c_str(), std::ios::trunc);
+  if (!file.is_open())
+  {
+    esyslog("Failed to open %s for writing", path.c_str());
+    return false;
+  }
+
+  const double usPerTick = GetNanosecondsPerTick() / 1000.0;
+
+  file << std::fixed << std::setprecision(3);
+
+  file << "{" << std::endl;
+  file << "  \"unit\": \"us\"," << std::endl;
+  file << "  \"frames\": " << m_frameCount << "," << std::endl;
+  file << "  \"duration\": " << static_cast<double>(TimeUtils::GetTimeUsec() - m_startUs) << "," << std::endl;
+  file << "  \"phases\": {" << std::endl;
+
+  for (unsigned int i = 0; i < PROFILE_PHASE_COUNT; i++)
+  {
+    const Phase& phase = m_phases[i];
+
+    file << "    \"" << GetPhaseName(static_cast<PROFILE_PHASE>(i)) << "\": {" << std::endl;
+    file << "      \"time\": ";
+    phase.time.WriteJSON(file, usPerTick);
+    file << "," << std::endl;
+    file << "      \"calls\": ";
+    phase.calls.WriteJSON(file, 1.0);
+    file << std::endl;
+    file << "    }" << (i + 1 < PROFILE_PHASE_COUNT ? "," : "") << std::endl;
+  }
+
+  file << "  }" << std::endl;
+  file << "}" << std::endl;
+
+  if (!file.good())
+  {
+    esyslog("Failed to write %s", path.c_str());
+    return false;
+  }
+
+  const CHistogram& frameTime = m_phases[PROFILE_PHASE_FRAME].time;
+  isyslog("Frame time over %llu frames: mean %.3f ms, p99 %.3f ms, max %.3f ms",
+          static_cast<unsigned long long>(m_frameCount),
+          frameTime.Mean() * usPerTick / 1000.0,
+          frameTime.Percentile(99.0) * usPerTick / 1000.0,
+          frameTime.Max() * usPerTick / 1000.0);
+
+  dsyslog("Frame timing written to %s", path.c_str());
+
+  return true;
+}
+
+double CFrameProfiler::GetNanosecondsPerTick(void) const
+{
+  const uint64_t elapsedTicks = CPUFeatures::GetCycleCount() - m_startTicks;
+  const int64_t elapsedUs = TimeUtils::GetTimeUsec() - m_startUs;
+
+  if (elapsedTicks == 0 || elapsedUs <= 0)
+    return 1.0;
+
+  return elapsedUs * 1000.0 / elapsedTicks;
+}
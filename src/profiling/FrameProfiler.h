@@ -0,0 +1,138 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include "utils/CPUFeatures.h"
+#include "utils/Histogram.h"
+
+#include <stdint.h>
+#include <string>
+
+namespace LIBRETRO
+{
+  enum PROFILE_PHASE
+  {
+    PROFILE_PHASE_FRAME,       // A whole frame of the game loop
+    PROFILE_PHASE_CORE,        // retro_run(), including the callbacks below
+    PROFILE_PHASE_VIDEO,       // Video refresh callback
+    PROFILE_PHASE_AUDIO,       // Audio sample callbacks
+    PROFILE_PHASE_INPUT,       // Input state callback
+    PROFILE_PHASE_ENVIRONMENT, // Environment callback
+    PROFILE_PHASE_FLUSH,       // Sending queued frames to Kodi in threaded mode
+    PROFILE_PHASE_COUNT,
+  };
+
+  /*!
+   * \brief Per-frame timing of the game loop
+   *
+   * Time spent in each phase, and the number of times it was entered, is
+   * accumulated over a frame and recorded into a histogram when the frame
+   * ends. Timing uses the CPU's cycle counter, which is converted to wall
+   * time when the histograms are written.
+   *
+   * The profiler is meant to be left compiled in: when disabled, a phase costs
+   * a single branch. Phases must be entered on the thread running the game
+   * loop, except for PROFILE_PHASE_FLUSH.
+   */
+  class CFrameProfiler
+  {
+  private:
+    CFrameProfiler(void);
+
+  public:
+    static CFrameProfiler& Get(void);
+
+    /*!
+     * \brief Clear the histograms and start profiling
+     */
+    void Initialize(void);
+
+    void Deinitialize(void);
+
+    bool IsEnabled(void) const { return m_bEnabled; }
+
+    void BeginFrame(void);
+    void EndFrame(void);
+
+    /*!
+     * \brief Account time and a call to a phase of the current frame
+     */
+    void AddPhase(PROFILE_PHASE phase, uint64_t ticks)
+    {
+      m_phases[phase].frameTicks += ticks;
+      m_phases[phase].frameCalls++;
+    }
+
+    /*!
+     * \brief Record time spent outside of a frame
+     */
+    void Record(PROFILE_PHASE phase, uint64_t ticks);
+
+    /*!
+     * \brief Write the histograms as JSON
+     *
+     * \return True if the file was written
+     */
+    bool Dump(const std::string& path);
+
+  private:
+    struct Phase
+    {
+      CHistogram   time;       // Ticks per frame
+      CHistogram   calls;      // Calls per frame
+      uint64_t     frameTicks;
+      unsigned int frameCalls;
+    };
+
+    double GetNanosecondsPerTick(void) const;
+
+    bool     m_bEnabled;
+    uint64_t m_frameStart;
+    uint64_t m_frameCount;
+    Phase    m_phases[PROFILE_PHASE_COUNT];
+
+    // Calibration of the cycle counter
+    uint64_t m_startTicks;
+    int64_t  m_startUs;
+  };
+
+  /*!
+   * \brief Accounts the lifetime of the object to a phase of the current frame
+   */
+  class CProfileScope
+  {
+  public:
+    CProfileScope(PROFILE_PHASE phase) :
+      m_phase(phase),
+      m_start(CFrameProfiler::Get().IsEnabled() ? CPUFeatures::GetCycleCount() : 0)
+    {
+    }
+
+    ~CProfileScope(void)
+    {
+      if (m_start != 0)
+        CFrameProfiler::Get().AddPhase(m_phase, CPUFeatures::GetCycleCount() - m_start);
+    }
+
+  private:
+    const PROFILE_PHASE m_phase;
+    const uint64_t      m_start;
+  };
+}
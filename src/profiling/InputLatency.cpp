@@ -0,0 +1,149 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "InputLatency.h"
+#include "log/Log.h"
+#include "utils/TimeUtils.h"
+
+#include <fstream>
+#include <iomanip>
+
+using namespace LIBRETRO;
+
+CInputLatency::CInputLatency(void) :
+  m_bEnabled(false),
+  m_observedCount(0)
+{
+}
+
+CInputLatency& CInputLatency::Get(void)
+{
+  static CInputLatency _instance;
+  return _instance;
+}
+
+void CInputLatency::Initialize(unsigned int slotCount)
+{
+  m_latched.assign(slotCount, 0);
+  m_observed.assign(slotCount, 0);
+  m_observedCount = 0;
+
+  m_inputToPoll.Reset();
+  m_inputToFrame.Reset();
+
+  m_bEnabled = true;
+}
+
+void CInputLatency::Deinitialize(void)
+{
+  m_bEnabled = false;
+
+  m_latched.clear();
+  m_observed.clear();
+  m_observedCount = 0;
+}
+
+void CInputLatency::Latched(unsigned int slot, int64_t eventTimeNs)
+{
+  if (!m_bEnabled || eventTimeNs == 0 || slot >= m_latched.size())
+    return;
+
+  // Keep the oldest event if the core hasn't read the slot since the last poll
+  if (m_latched[slot] == 0)
+    m_latched[slot] = eventTimeNs;
+}
+
+void CInputLatency::RecordObserved(unsigned int slot)
+{
+  const int64_t eventTimeNs = m_latched[slot];
+  m_latched[slot] = 0;
+
+  const int64_t now = TimeUtils::GetTimeNsec();
+  m_inputToPoll.Add(now > eventTimeNs ? now - eventTimeNs : 0);
+
+  if (m_observed[slot] == 0)
+  {
+    m_observed[slot] = eventTimeNs;
+    m_observedCount++;
+  }
+}
+
+void CInputLatency::FrameOut(void)
+{
+  if (!m_bEnabled || m_observedCount == 0)
+    return;
+
+  const int64_t now = TimeUtils::GetTimeNsec();
+
+  for (int64_t& eventTimeNs : m_observed)
+  {
+    if (eventTimeNs != 0)
+    {
+      m_inputToFrame.Add(now > eventTimeNs ? now - eventTimeNs : 0);
+      eventTimeNs = 0;
+    }
+  }
+
+  m_observedCount = 0;
+}
+
+bool CInputLatency::Dump(const std::string& path)
+{
+  if (m_inputToPoll.Count() == 0)
+    return false;
+
+  std::ofstream file(path.c_str(), std::ios::trunc);
+  if (!file.is_open())
+  {
+    esyslog("Failed to open %s for writing", path.c_str());
+    return false;
+  }
+
+  const double usPerNs = 1.0 / 1000.0;
+
+  file << std::fixed << std::setprecision(3);
+
+  file << "{" << std::endl;
+  file << "  \"unit\": \"us\"," << std::endl;
+  file << "  \"input_to_poll\": ";
+  m_inputToPoll.WriteJSON(file, usPerNs);
+  file << "," << std::endl;
+  file << "  \"input_to_frame\": ";
+  m_inputToFrame.WriteJSON(file, usPerNs);
+  file << std::endl;
+  file << "}" << std::endl;
+
+  if (!file.good())
+  {
+    esyslog("Failed to write %s", path.c_str());
+    return false;
+  }
+
+  isyslog("Input latency over %llu events: to poll p50 %.3f ms, p99 %.3f ms; to frame p50 %.3f ms, p99 %.3f ms",
+          static_cast<unsigned long long>(m_inputToPoll.Count()),
+          m_inputToPoll.Percentile(50.0) / 1e6,
+          m_inputToPoll.Percentile(99.0) / 1e6,
+          m_inputToFrame.Percentile(50.0) / 1e6,
+          m_inputToFrame.Percentile(99.0) / 1e6);
+
+  dsyslog("Input latency written to %s", path.c_str());
+
+  return true;
+}
@@ -0,0 +1,122 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include "utils/Histogram.h"
+
+#include <atomic>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace LIBRETRO
+{
+  /*!
+   * \brief Latency from receiving input to the core using it
+   *
+   * Input events are stamped with a monotonic time when Kodi delivers them.
+   * Per input slot (a port, the mouse or the keyboard), the oldest event the
+   * core hasn't seen is latched when the core polls for input, and measured
+   * twice: when InputState() is first called for the slot, and when the next
+   * frame is presented. Frames muted by run-ahead aren't presented.
+   *
+   * The two latencies are recorded into histograms, in nanoseconds. Stamping
+   * and polling cost a branch while disabled.
+   */
+  class CInputLatency
+  {
+  private:
+    CInputLatency(void);
+
+  public:
+    static CInputLatency& Get(void);
+
+    /*!
+     * \brief Clear the histograms and start measuring
+     *
+     * \param slotCount  The number of input slots
+     */
+    void Initialize(unsigned int slotCount);
+
+    void Deinitialize(void);
+
+    bool IsEnabled(void) const { return m_bEnabled; }
+
+    // Input thread
+
+    /*!
+     * \brief Record the time of an event, unless an older one is pending
+     */
+    static void Stamp(std::atomic<int64_t>& pendingTimeNs, int64_t eventTimeNs)
+    {
+      int64_t expected = 0;
+      pendingTimeNs.compare_exchange_strong(expected, eventTimeNs, std::memory_order_relaxed);
+    }
+
+    /*!
+     * \brief Take the time of the oldest pending event, or 0 if none
+     */
+    static int64_t Take(std::atomic<int64_t>& pendingTimeNs)
+    {
+      return pendingTimeNs.exchange(0, std::memory_order_relaxed);
+    }
+
+    // Emulation thread
+
+    /*!
+     * \brief Called when an input poll has latched the slot's events
+     */
+    void Latched(unsigned int slot, int64_t eventTimeNs);
+
+    /*!
+     * \brief Called when the core reads the input of a slot
+     */
+    void Observed(unsigned int slot)
+    {
+      if (m_bEnabled && slot < m_latched.size() && m_latched[slot] != 0)
+        RecordObserved(slot);
+    }
+
+    /*!
+     * \brief Called when a frame is presented
+     */
+    void FrameOut(void);
+
+    /*!
+     * \brief Write the histograms as JSON
+     *
+     * \return True if the file was written
+     */
+    bool Dump(const std::string& path);
+
+  private:
+    void RecordObserved(unsigned int slot);
+
+    std::atomic<bool> m_bEnabled;
+
+    // Event times per slot, 0 if none
+    std::vector<int64_t> m_latched;  // Latched, not yet read by the core
+    std::vector<int64_t> m_observed; // Read by the core, not yet presented
+    unsigned int         m_observedCount;
+
+    CHistogram m_inputToPoll;
+    CHistogram m_inputToFrame;
+  };
+}
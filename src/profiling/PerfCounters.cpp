@@ -0,0 +1,107 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "PerfCounters.h"
+#include "libretro/libretro.h"
+#include "log/Log.h"
+#include "utils/CPUFeatures.h"
+
+#include <algorithm>
+
+using namespace LIBRETRO;
+using namespace P8PLATFORM;
+
+CPerfCounters::CPerfCounters(void)
+{
+}
+
+CPerfCounters& CPerfCounters::Get(void)
+{
+  static CPerfCounters _instance;
+  return _instance;
+}
+
+void CPerfCounters::Register(retro_perf_counter* counter)
+{
+  if (counter == nullptr || counter->registered)
+    return;
+
+  CLockObject lock(m_mutex);
+
+  m_counters.push_back(counter);
+  counter->registered = true;
+}
+
+void CPerfCounters::Start(retro_perf_counter* counter)
+{
+  if (counter == nullptr)
+    return;
+
+  counter->call_cnt++;
+  counter->start = CPUFeatures::GetCycleCount();
+}
+
+void CPerfCounters::Stop(retro_perf_counter* counter)
+{
+  if (counter == nullptr)
+    return;
+
+  counter->total += CPUFeatures::GetCycleCount() - counter->start;
+}
+
+void CPerfCounters::Log(void)
+{
+  std::vector<retro_perf_counter*> counters;
+
+  {
+    CLockObject lock(m_mutex);
+    counters = m_counters;
+  }
+
+  if (counters.empty())
+    return;
+
+  std::sort(counters.begin(), counters.end(),
+    [](const retro_perf_counter* lhs, const retro_perf_counter* rhs)
+    {
+      return lhs->total > rhs->total;
+    });
+
+  isyslog("PERF: %-32s %16s %10s %12s", "Counter", "Total ticks", "Calls", "Ticks/call");
+
+  for (const retro_perf_counter* counter : counters)
+  {
+    const unsigned long long total = counter->total;
+    const unsigned long long calls = counter->call_cnt;
+
+    isyslog("PERF: %-32s %16llu %10llu %12llu", counter->ident ? counter->ident : "(unnamed)",
+            total, calls, calls > 0 ? total / calls : 0);
+  }
+}
+
+void CPerfCounters::Clear(void)
+{
+  CLockObject lock(m_mutex);
+
+  for (retro_perf_counter* counter : m_counters)
+    counter->registered = false;
+
+  m_counters.clear();
+}
@@ -0,0 +1,64 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include "p8-platform/threads/mutex.h"
+
+#include <vector>
+
+struct retro_perf_counter;
+
+namespace LIBRETRO
+{
+  /*!
+   * \brief Registry of the performance counters of a libretro core
+   *
+   * The counters themselves are owned by the core. They are started and
+   * stopped without going through the registry, which only keeps track of
+   * them so that they can be reported.
+   */
+  class CPerfCounters
+  {
+  private:
+    CPerfCounters(void);
+
+  public:
+    static CPerfCounters& Get(void);
+
+    void Register(retro_perf_counter* counter);
+
+    static void Start(retro_perf_counter* counter);
+    static void Stop(retro_perf_counter* counter);
+
+    /*!
+     * \brief Log all counters, sorted by total time
+     */
+    void Log(void);
+
+    /*!
+     * \brief Forget all counters, e.g. before the core is unloaded
+     */
+    void Clear(void);
+
+  private:
+    std::vector<retro_perf_counter*> m_counters;
+    P8PLATFORM::CMutex               m_mutex;
+  };
+}
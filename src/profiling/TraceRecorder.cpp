@@ -0,0 +1,251 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "TraceRecorder.h"
+#include "log/Log.h"
+
+#include <fstream>
+#include <iomanip>
+
+using namespace LIBRETRO;
+using namespace P8PLATFORM;
+
+#define TRACE_CHUNK_SIZE  4096 // Events per chunk
+#define TRACE_MAX_CHUNKS  256  // About 24 MB of events
+
+struct CTraceRecorder::Chunk
+{
+  Chunk(void) : count(0), next(nullptr) { }
+
+  TraceEvent            events[TRACE_CHUNK_SIZE];
+  std::atomic<unsigned> count;
+  std::atomic<Chunk*>   next;
+};
+
+struct CTraceRecorder::ThreadBuffer
+{
+  ThreadBuffer(unsigned int threadId) : threadId(threadId), head(nullptr), tail(nullptr), bInUse(false) { }
+
+  const unsigned int  threadId;
+  std::string         name;
+  std::atomic<Chunk*> head;
+  Chunk*              tail;   // Only used by the owning thread
+  bool                bInUse; // Protected by m_mutex
+};
+
+/*!
+ * \brief Releases the buffer of a thread when the thread exits
+ */
+struct CTraceRecorder::ThreadLease
+{
+  ThreadLease(void) : buffer(nullptr) { }
+
+  ~ThreadLease(void)
+  {
+    if (buffer != nullptr)
+      CTraceRecorder::Get().ReleaseThreadBuffer(buffer);
+  }
+
+  ThreadBuffer* buffer;
+};
+
+CTraceRecorder::CTraceRecorder(void) :
+  m_bRecording(true),
+  m_epoch(TimeUtils::GetTimeNsec()),
+  m_chunkCount(0),
+  m_droppedCount(0)
+{
+}
+
+CTraceRecorder& CTraceRecorder::Get(void)
+{
+  static CTraceRecorder _instance;
+  return _instance;
+}
+
+CTraceRecorder::~CTraceRecorder(void)
+{
+  Clear();
+}
+
+void CTraceRecorder::AddSpan(const char* name, int64_t start, int64_t end)
+{
+  ThreadBuffer* buffer = GetThreadBuffer();
+
+  Chunk* chunk = buffer->tail;
+  if (chunk == nullptr || chunk->count.load(std::memory_order_relaxed) == TRACE_CHUNK_SIZE)
+  {
+    Chunk* newChunk = AllocateChunk();
+    if (newChunk == nullptr)
+    {
+      m_droppedCount++;
+      return;
+    }
+
+    if (chunk == nullptr)
+      buffer->head.store(newChunk, std::memory_order_release);
+    else
+      chunk->next.store(newChunk, std::memory_order_release);
+
+    buffer->tail = chunk = newChunk;
+  }
+
+  const unsigned int index = chunk->count.load(std::memory_order_relaxed);
+
+  TraceEvent& event = chunk->events[index];
+  event.name = name;
+  event.start = start;
+  event.duration = end - start;
+
+  chunk->count.store(index + 1, std::memory_order_release);
+}
+
+void CTraceRecorder::SetThreadName(const char* name)
+{
+  ThreadBuffer* buffer = GetThreadBuffer(name);
+
+  CLockObject lock(m_mutex);
+  buffer->name = name;
+}
+
+CTraceRecorder::ThreadBuffer* CTraceRecorder::GetThreadBuffer(const char* name /* = "" */)
+{
+  static thread_local ThreadLease lease;
+
+  if (lease.buffer == nullptr)
+  {
+    CLockObject lock(m_mutex);
+
+    // Continue the buffer of an exited thread with the same name
+    for (const auto& buffer : m_buffers)
+    {
+      if (!buffer->bInUse && buffer->name == name)
+      {
+        lease.buffer = buffer.get();
+        break;
+      }
+    }
+
+    if (lease.buffer == nullptr)
+    {
+      m_buffers.emplace_back(new ThreadBuffer(static_cast<unsigned int>(m_buffers.size()) + 1));
+      lease.buffer = m_buffers.back().get();
+    }
+
+    lease.buffer->bInUse = true;
+  }
+
+  return lease.buffer;
+}
+
+void CTraceRecorder::ReleaseThreadBuffer(ThreadBuffer* buffer)
+{
+  CLockObject lock(m_mutex);
+  buffer->bInUse = false;
+}
+
+CTraceRecorder::Chunk* CTraceRecorder::AllocateChunk(void)
+{
+  if (m_chunkCount.fetch_add(1) >= TRACE_MAX_CHUNKS)
+  {
+    m_chunkCount--;
+    return nullptr;
+  }
+
+  return new Chunk;
+}
+
+bool CTraceRecorder::Write(const std::string& path)
+{
+  std::ofstream file(path.c_str(), std::ios::trunc);
+  if (!file.is_open())
+  {
+    esyslog("Failed to open %s for writing", path.c_str());
+    return false;
+  }
+
+  // Timestamps and durations are in microseconds
+  file << std::fixed << std::setprecision(3);
+
+  file << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [" << std::endl;
+
+  file << "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"args\": {\"name\": \"game.libretro\"}}";
+
+  unsigned int eventCount = 0;
+
+  CLockObject lock(m_mutex);
+
+  for (const auto& buffer : m_buffers)
+  {
+    if (!buffer->name.empty())
+    {
+      file << "," << std::endl;
+      file << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << buffer->threadId
+           << ", \"args\": {\"name\": \"" << buffer->name << "\"}}";
+    }
+
+    for (Chunk* chunk = buffer->head.load(std::memory_order_acquire); chunk != nullptr; chunk = chunk->next.load(std::memory_order_acquire))
+    {
+      const unsigned int count = chunk->count.load(std::memory_order_acquire);
+      for (unsigned int i = 0; i < count; i++)
+      {
+        const TraceEvent& event = chunk->events[i];
+
+        file << "," << std::endl;
+        file << "{\"name\": \"" << event.name << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << buffer->threadId
+             << ", \"ts\": " << (event.start - m_epoch) / 1000.0
+             << ", \"dur\": " << event.duration / 1000.0 << "}";
+      }
+      eventCount += count;
+    }
+  }
+
+  file << std::endl << "]}" << std::endl;
+
+  if (!file.good())
+  {
+    esyslog("Failed to write %s", path.c_str());
+    return false;
+  }
+
+  dsyslog("Trace of %u spans written to %s (%u dropped)", eventCount, path.c_str(), m_droppedCount.load());
+
+  return true;
+}
+
+void CTraceRecorder::Clear(void)
+{
+  CLockObject lock(m_mutex);
+
+  for (const auto& buffer : m_buffers)
+  {
+    Chunk* chunk = buffer->head.exchange(nullptr);
+    while (chunk != nullptr)
+    {
+      Chunk* next = chunk->next.load();
+      delete chunk;
+      chunk = next;
+    }
+    buffer->tail = nullptr;
+  }
+
+  m_chunkCount = 0;
+  m_droppedCount = 0;
+}
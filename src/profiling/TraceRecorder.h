@@ -0,0 +1,141 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include "utils/TimeUtils.h"
+
+#include "p8-platform/threads/mutex.h"
+
+#include <atomic>
+#include <memory>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace LIBRETRO
+{
+  /*!
+   * \brief Timeline of named spans in Chrome's trace event format
+   *
+   * Each thread records into its own buffer, so recording a span takes no
+   * lock: the buffer is a list of fixed-size chunks that only its thread
+   * appends to, and each chunk publishes its event count with release
+   * semantics for the writer. The total number of chunks is capped; spans
+   * recorded beyond the cap are dropped and counted.
+   *
+   * When a thread exits, its buffer is handed to the next thread with the
+   * same name, so threads that are restarted for every game keep one buffer.
+   *
+   * Recording is on from the start so that add-on creation and game loading
+   * are always captured. The resulting file can be opened in Perfetto or
+   * chrome://tracing.
+   */
+  class CTraceRecorder
+  {
+  private:
+    CTraceRecorder(void);
+
+  public:
+    static CTraceRecorder& Get(void);
+
+    ~CTraceRecorder(void);
+
+    bool IsRecording(void) const { return m_bRecording; }
+    void SetRecording(bool bRecording) { m_bRecording = bRecording; }
+
+    /*!
+     * \brief Record a span on the calling thread
+     *
+     * \param name   A string literal, stored by pointer
+     * \param start  Start time from TimeUtils::GetTimeNsec()
+     * \param end    End time from TimeUtils::GetTimeNsec()
+     */
+    void AddSpan(const char* name, int64_t start, int64_t end);
+
+    /*!
+     * \brief Name the calling thread in the trace
+     */
+    void SetThreadName(const char* name);
+
+    /*!
+     * \brief Write all recorded spans as JSON
+     *
+     * \return True if the file was written
+     */
+    bool Write(const std::string& path);
+
+    /*!
+     * \brief Discard all recorded spans
+     *
+     * Must not be called while other threads are recording.
+     */
+    void Clear(void);
+
+  private:
+    struct TraceEvent
+    {
+      const char* name;
+      int64_t     start;
+      int64_t     duration;
+    };
+
+    struct Chunk;
+    struct ThreadBuffer;
+    struct ThreadLease;
+
+    ThreadBuffer* GetThreadBuffer(const char* name = "");
+    void ReleaseThreadBuffer(ThreadBuffer* buffer);
+    Chunk* AllocateChunk(void);
+
+    std::atomic<bool>     m_bRecording;
+    const int64_t         m_epoch;
+    std::atomic<unsigned> m_chunkCount;
+    std::atomic<unsigned> m_droppedCount;
+
+    // Registry of thread buffers, protected by m_mutex
+    std::vector<std::unique_ptr<ThreadBuffer>> m_buffers;
+    P8PLATFORM::CMutex                         m_mutex;
+  };
+
+  /*!
+   * \brief Records the lifetime of the object as a span
+   */
+  class CTraceScope
+  {
+  public:
+    CTraceScope(const char* name) :
+      m_name(name),
+      m_bRecording(CTraceRecorder::Get().IsRecording()),
+      m_start(m_bRecording ? TimeUtils::GetTimeNsec() : 0)
+    {
+    }
+
+    ~CTraceScope(void)
+    {
+      if (m_bRecording)
+        CTraceRecorder::Get().AddSpan(m_name, m_start, TimeUtils::GetTimeNsec());
+    }
+
+  private:
+    const char* const m_name;
+    const bool        m_bRecording;
+    const int64_t     m_start;
+  };
+}
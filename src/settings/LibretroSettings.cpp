@@ -23,6 +23,7 @@
 #include "SettingsGenerator.h"
 #include "libretro/libretro.h"
 #include "log/Log.h"
+#include "profiling/TraceRecorder.h"
 #include "utils/PathUtils.h"
 
 #include "kodi_game_types.h"
@@ -71,6 +72,8 @@ void CLibretroSettings::SetUnchanged()
 
 void CLibretroSettings::SetAllSettings(const retro_variable* libretroVariables)
 {
+  CTraceScope trace("CLibretroSettings::SetAllSettings");
+
   // Keep track of whether Kodi has the correct settings
   bool bValid = true;
 
@@ -167,6 +170,8 @@ void CLibretroSettings::SetCurrentValue(const std::string& name, const std::stri
 
 void CLibretroSettings::GenerateSettings()
 {
+  CTraceScope trace("CLibretroSettings::GenerateSettings");
+
   if (!m_bGenerated && !m_settings.empty())
   {
     isyslog("Invalid settings detected, generating new settings and language files");
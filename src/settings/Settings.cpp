@@ -22,11 +22,39 @@
 
 using namespace LIBRETRO;
 
-#define SETTING_CROP_OVERSCAN  "cropoverscan"
+namespace
+{
+  // Values of the fast-forward enum in settings.xml. 0 is unbounded.
+  const unsigned int FastForwardRatios[] = { 2, 3, 4, 6, 8, 12, 16, 0 };
+}
+
+#define SETTING_CROP_OVERSCAN    "cropoverscan"
+#define SETTING_REWIND_ENABLED   "rewindenabled"
+#define SETTING_REWIND_INTERVAL  "rewindinterval"
+#define SETTING_REWIND_BUFFER    "rewindbuffer"
+#define SETTING_RUNAHEAD_FRAMES  "runaheadframes"
+#define SETTING_THREADED         "threadedemulation"
+#define SETTING_FASTFORWARD      "fastforwardratio"
+#define SETTING_FRAME_PROFILING  "frameprofiling"
+#define SETTING_TRACING          "tracing"
+#define SETTING_CONTENT_CACHE    "contentcache"
+#define SETTING_STAGING_CACHE    "stagingcache"
+#define SETTING_MEMORY_BUDGET    "memorybudget"
 
 CSettings::CSettings(void)
   : m_bInitialized(false),
-    m_bCropOverscan(false)
+    m_bCropOverscan(false),
+    m_bRewindEnabled(false),
+    m_rewindInterval(1),
+    m_rewindBufferMB(128),
+    m_runAheadFrames(0),
+    m_bThreadedEmulation(false),
+    m_fastForwardRatio(4),
+    m_bFrameProfiling(false),
+    m_bTracing(false),
+    m_contentCacheMB(256),
+    m_stagingCacheMB(4096),
+    m_memoryBudgetMB(0)
 {
 }
 
@@ -43,6 +71,58 @@ void CSettings::SetSetting(const std::string& strName, const void* value)
     m_bCropOverscan = *static_cast<const bool*>(value);
     //dsyslog("Setting \"%s\" set to %f", SETTING_CROP_OVERSCAN, m_bCropOverscan ? "true" : "false");
   }
+  else if (strName == SETTING_REWIND_ENABLED)
+  {
+    m_bRewindEnabled = *static_cast<const bool*>(value);
+  }
+  else if (strName == SETTING_REWIND_INTERVAL)
+  {
+    const int interval = *static_cast<const int*>(value);
+    m_rewindInterval = interval > 0 ? interval : 1;
+  }
+  else if (strName == SETTING_REWIND_BUFFER)
+  {
+    const int bufferMB = *static_cast<const int*>(value);
+    m_rewindBufferMB = bufferMB > 0 ? bufferMB : 1;
+  }
+  else if (strName == SETTING_RUNAHEAD_FRAMES)
+  {
+    const int frames = *static_cast<const int*>(value);
+    m_runAheadFrames = frames > 0 ? frames : 0;
+  }
+  else if (strName == SETTING_THREADED)
+  {
+    m_bThreadedEmulation = *static_cast<const bool*>(value);
+  }
+  else if (strName == SETTING_FASTFORWARD)
+  {
+    const int index = *static_cast<const int*>(value);
+    if (0 <= index && index < static_cast<int>(sizeof(FastForwardRatios) / sizeof(FastForwardRatios[0])))
+      m_fastForwardRatio = FastForwardRatios[index];
+  }
+  else if (strName == SETTING_FRAME_PROFILING)
+  {
+    m_bFrameProfiling = *static_cast<const bool*>(value);
+  }
+  else if (strName == SETTING_TRACING)
+  {
+    m_bTracing = *static_cast<const bool*>(value);
+  }
+  else if (strName == SETTING_CONTENT_CACHE)
+  {
+    const int cacheMB = *static_cast<const int*>(value);
+    m_contentCacheMB = cacheMB > 0 ? cacheMB : 0;
+  }
+  else if (strName == SETTING_STAGING_CACHE)
+  {
+    const int cacheMB = *static_cast<const int*>(value);
+    m_stagingCacheMB = cacheMB > 0 ? cacheMB : 0;
+  }
+  else if (strName == SETTING_MEMORY_BUDGET)
+  {
+    const int budgetMB = *static_cast<const int*>(value);
+    m_memoryBudgetMB = budgetMB > 0 ? budgetMB : 0;
+  }
 
   m_bInitialized = true;
 }
@@ -40,8 +40,79 @@ namespace LIBRETRO
      */
     bool CropOverscan(void) const { return m_bCropOverscan; }
 
+    /*!
+     * \brief True if states should be captured for rewinding
+     */
+    bool RewindEnabled(void) const { return m_bRewindEnabled; }
+
+    /*!
+     * \brief Number of frames between rewind captures
+     */
+    unsigned int RewindInterval(void) const { return m_rewindInterval; }
+
+    /*!
+     * \brief Memory budget for the rewind history, in MB
+     */
+    unsigned int RewindBufferMB(void) const { return m_rewindBufferMB; }
+
+    /*!
+     * \brief Number of frames to run ahead to hide input lag, 0 if disabled
+     */
+    unsigned int RunAheadFrames(void) const { return m_runAheadFrames; }
+
+    /*!
+     * \brief True if the core should run on its own thread
+     */
+    bool ThreadedEmulation(void) const { return m_bThreadedEmulation; }
+
+    /*!
+     * \brief Number of core frames per frontend frame when fast-forwarding,
+     *        0 if unbounded
+     */
+    unsigned int FastForwardRatio(void) const { return m_fastForwardRatio; }
+
+    /*!
+     * \brief True if frame timing and input latency should be recorded to the
+     *        profile directory
+     */
+    bool FrameProfiling(void) const { return m_bFrameProfiling; }
+
+    /*!
+     * \brief True if a timeline of game loading and frames should be written
+     *        to the profile directory
+     */
+    bool Tracing(void) const { return m_bTracing; }
+
+    /*!
+     * \brief Size of the cache of extracted archives, 0 if disabled
+     */
+    unsigned int ContentCacheMB(void) const { return m_contentCacheMB; }
+
+    /*!
+     * \brief Size of the local copies of VFS content for cores that need a
+     *        path, 0 if disabled
+     */
+    unsigned int StagingCacheMB(void) const { return m_stagingCacheMB; }
+
+    /*!
+     * \brief Largest content read into memory, 0 to derive it from the
+     *        available memory
+     */
+    unsigned int MemoryBudgetMB(void) const { return m_memoryBudgetMB; }
+
   private:
-    bool  m_bInitialized;
-    bool  m_bCropOverscan;
+    bool         m_bInitialized;
+    bool         m_bCropOverscan;
+    bool         m_bRewindEnabled;
+    unsigned int m_rewindInterval;
+    unsigned int m_rewindBufferMB;
+    unsigned int m_runAheadFrames;
+    bool         m_bThreadedEmulation;
+    unsigned int m_fastForwardRatio;
+    bool         m_bFrameProfiling;
+    bool         m_bTracing;
+    unsigned int m_contentCacheMB;
+    unsigned int m_stagingCacheMB;
+    unsigned int m_memoryBudgetMB;
   };
 }
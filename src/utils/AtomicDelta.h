@@ -0,0 +1,65 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+
+namespace LIBRETRO
+{
+  /*!
+   * \brief Lock-free accumulator of two-dimensional motion
+   *
+   * X and Y are packed into the two halves of one 64-bit atomic, so that a
+   * writer adds to both at once and a reader takes both at once, resetting
+   * them to zero. Any number of writers may add while a reader takes, and no
+   * motion is lost or split between two takes.
+   */
+  class CAtomicDelta
+  {
+  public:
+    CAtomicDelta(void) : m_packed(0) { }
+
+    void Add(int32_t x, int32_t y)
+    {
+      uint64_t expected = m_packed.load(std::memory_order_relaxed);
+      uint64_t desired;
+      do
+      {
+        desired = Pack(Low(expected) + static_cast<uint32_t>(x), High(expected) + static_cast<uint32_t>(y));
+      } while (!m_packed.compare_exchange_weak(expected, desired, std::memory_order_relaxed));
+    }
+
+    void Take(int32_t& x, int32_t& y)
+    {
+      const uint64_t packed = m_packed.exchange(0, std::memory_order_relaxed);
+      x = static_cast<int32_t>(Low(packed));
+      y = static_cast<int32_t>(High(packed));
+    }
+
+  private:
+    // Each half wraps around on its own, it never carries into the other
+    static uint64_t Pack(uint32_t low, uint32_t high) { return static_cast<uint64_t>(high) << 32 | low; }
+    static uint32_t Low(uint64_t packed) { return static_cast<uint32_t>(packed); }
+    static uint32_t High(uint64_t packed) { return static_cast<uint32_t>(packed >> 32); }
+
+    std::atomic<uint64_t> m_packed;
+  };
+}
@@ -0,0 +1,219 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "CPUFeatures.h"
+#include "libretro/libretro.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+  #define CPU_X86 1
+  #if defined(_MSC_VER)
+    #include <intrin.h>
+  #else
+    #include <cpuid.h>
+    #include <x86intrin.h>
+  #endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+  #define CPU_ARM64 1
+#elif defined(__arm__)
+  #define CPU_ARM 1
+  #if defined(__linux__)
+    #include <sys/auxv.h>
+    #include <asm/hwcap.h>
+  #endif
+#endif
+
+#include <chrono>
+
+using namespace LIBRETRO;
+
+namespace
+{
+#if defined(CPU_X86)
+  void CPUID(uint32_t leaf, uint32_t subleaf, uint32_t regs[4])
+  {
+  #if defined(_MSC_VER)
+    int info[4];
+    __cpuidex(info, leaf, subleaf);
+    for (unsigned int i = 0; i < 4; i++)
+      regs[i] = static_cast<uint32_t>(info[i]);
+  #else
+    __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+  #endif
+  }
+
+  // XCR0 tells whether the OS saves the AVX registers on context switches
+  uint64_t XGETBV(void)
+  {
+  #if defined(_MSC_VER)
+    return _xgetbv(0);
+  #else
+    uint32_t eax, edx;
+    __asm__ volatile ("xgetbv" : "=a" (eax), "=d" (edx) : "c" (0));
+    return (static_cast<uint64_t>(edx) << 32) | eax;
+  #endif
+  }
+
+  uint64_t DetectSIMDFeatures(void)
+  {
+    uint64_t features = 0;
+
+    uint32_t regs[4]; // eax, ebx, ecx, edx
+
+    CPUID(0, 0, regs);
+    const uint32_t maxLeaf = regs[0];
+    if (maxLeaf < 1)
+      return 0;
+
+    CPUID(1, 0, regs);
+    const uint32_t ecx = regs[2];
+    const uint32_t edx = regs[3];
+
+    if (edx & (1 << 15)) features |= RETRO_SIMD_CMOV;
+    if (edx & (1 << 23)) features |= RETRO_SIMD_MMX;
+    if (edx & (1 << 25)) features |= RETRO_SIMD_SSE | RETRO_SIMD_MMXEXT;
+    if (edx & (1 << 26)) features |= RETRO_SIMD_SSE2;
+    if (ecx & (1 << 0))  features |= RETRO_SIMD_SSE3;
+    if (ecx & (1 << 9))  features |= RETRO_SIMD_SSSE3;
+    if (ecx & (1 << 19)) features |= RETRO_SIMD_SSE4;
+    if (ecx & (1 << 20)) features |= RETRO_SIMD_SSE42;
+    if (ecx & (1 << 22)) features |= RETRO_SIMD_MOVBE;
+    if (ecx & (1 << 23)) features |= RETRO_SIMD_POPCNT;
+    if (ecx & (1 << 25)) features |= RETRO_SIMD_AES;
+
+    // AVX needs the OS to preserve the YMM registers (OSXSAVE, XCR0 bits 1-2)
+    const bool bOSXSave = (ecx & (1 << 27)) != 0;
+    const bool bAVXState = bOSXSave && (XGETBV() & 0x6) == 0x6;
+
+    if (bAVXState && (ecx & (1 << 28)))
+      features |= RETRO_SIMD_AVX;
+
+    if (bAVXState && maxLeaf >= 7)
+    {
+      CPUID(7, 0, regs);
+      if (regs[1] & (1 << 5))
+        features |= RETRO_SIMD_AVX2;
+    }
+
+    return features;
+  }
+
+  enum CPU_EXTENSION
+  {
+    CPU_EXTENSION_CLMUL = 1 << 0,
+    CPU_EXTENSION_SHA   = 1 << 1,
+  };
+
+  unsigned int DetectExtensions(void)
+  {
+    unsigned int extensions = 0;
+
+    uint32_t regs[4]; // eax, ebx, ecx, edx
+
+    CPUID(0, 0, regs);
+    const uint32_t maxLeaf = regs[0];
+    if (maxLeaf < 1)
+      return 0;
+
+    CPUID(1, 0, regs);
+    const bool bSSE41 = (regs[2] & (1 << 19)) != 0;
+    if (!bSSE41)
+      return 0;
+
+    if (regs[2] & (1 << 1))
+      extensions |= CPU_EXTENSION_CLMUL;
+
+    if (maxLeaf >= 7)
+    {
+      CPUID(7, 0, regs);
+      if (regs[1] & (1 << 29))
+        extensions |= CPU_EXTENSION_SHA;
+    }
+
+    return extensions;
+  }
+#elif defined(CPU_ARM64)
+  uint64_t DetectSIMDFeatures(void)
+  {
+    // Advanced SIMD is mandatory on ARMv8-A
+    return RETRO_SIMD_NEON;
+  }
+#elif defined(CPU_ARM)
+  uint64_t DetectSIMDFeatures(void)
+  {
+    uint64_t features = 0;
+
+  #if defined(__linux__) && defined(HWCAP_NEON)
+    const unsigned long hwcap = getauxval(AT_HWCAP);
+    if (hwcap & HWCAP_NEON)  features |= RETRO_SIMD_NEON;
+    if (hwcap & HWCAP_VFPv3) features |= RETRO_SIMD_VFPV3;
+    if (hwcap & HWCAP_VFPv4) features |= RETRO_SIMD_VFPV4;
+  #elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+    features |= RETRO_SIMD_NEON;
+  #endif
+
+    return features;
+  }
+#else
+  uint64_t DetectSIMDFeatures(void)
+  {
+    return 0;
+  }
+#endif
+}
+
+uint64_t CPUFeatures::GetSIMDFeatures(void)
+{
+  // CPUID can be slow (it traps in some VMs), so only query it once
+  static const uint64_t features = DetectSIMDFeatures();
+  return features;
+}
+
+bool CPUFeatures::HasCLMUL(void)
+{
+#if defined(CPU_X86)
+  static const bool bHasCLMUL = (DetectExtensions() & CPU_EXTENSION_CLMUL) != 0;
+  return bHasCLMUL;
+#else
+  return false;
+#endif
+}
+
+bool CPUFeatures::HasSHA(void)
+{
+#if defined(CPU_X86)
+  static const bool bHasSHA = (DetectExtensions() & CPU_EXTENSION_SHA) != 0;
+  return bHasSHA;
+#else
+  return false;
+#endif
+}
+
+uint64_t CPUFeatures::GetCycleCount(void)
+{
+#if defined(CPU_X86)
+  return __rdtsc();
+#elif defined(CPU_ARM64) && !defined(_MSC_VER)
+  uint64_t count;
+  __asm__ volatile ("mrs %0, cntvct_el0" : "=r" (count));
+  return count;
+#else
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
@@ -0,0 +1,57 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <stdint.h>
+
+namespace LIBRETRO
+{
+  class CPUFeatures
+  {
+  public:
+    /*!
+     * \brief Get the SIMD extensions supported by the CPU and the OS
+     *
+     * \return A mask of RETRO_SIMD_* flags
+     */
+    static uint64_t GetSIMDFeatures(void);
+
+    /*!
+     * \brief True if the CPU has carry-less multiplication (PCLMULQDQ) along
+     *        with SSE4.1, used for CRC-32
+     */
+    static bool HasCLMUL(void);
+
+    /*!
+     * \brief True if the CPU has the SHA extensions along with SSE4.1, used
+     *        for SHA-1
+     */
+    static bool HasSHA(void);
+
+    /*!
+     * \brief Read the CPU's cycle counter
+     *
+     * Uses the TSC on x86 and the virtual counter on ARMv8. Elsewhere, falls
+     * back to a monotonic clock in nanoseconds. Only differences between two
+     * readings on the same thread are meaningful.
+     */
+    static uint64_t GetCycleCount(void);
+  };
+}
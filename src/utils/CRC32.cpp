@@ -0,0 +1,218 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "CRC32.h"
+#include "CPUFeatures.h"
+
+#include <zlib.h>
+
+#include <algorithm>
+
+#if (defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86))
+  #define CRC32_CLMUL 1
+  #include <immintrin.h>
+  #if defined(__GNUC__)
+    #define TARGET_CLMUL __attribute__((target("pclmul,sse4.1")))
+  #else
+    #define TARGET_CLMUL
+  #endif
+#elif defined(__ARM_FEATURE_CRC32)
+  #define CRC32_ARM 1
+  #include <arm_acle.h>
+#endif
+
+using namespace LIBRETRO;
+
+// zlib takes 32-bit lengths
+#define ZLIB_MAX_CHUNK  (1U << 30)
+
+namespace
+{
+  uint32_t UpdateZlib(uint32_t crc, const uint8_t* data, size_t size)
+  {
+    while (size > 0)
+    {
+      const size_t chunk = std::min<size_t>(size, ZLIB_MAX_CHUNK);
+      crc = static_cast<uint32_t>(crc32(crc, data, static_cast<uInt>(chunk)));
+      data += chunk;
+      size -= chunk;
+    }
+    return crc;
+  }
+
+#if defined(CRC32_CLMUL)
+  // Folding constants for the bit-reflected polynomial 0x04C11DB7, see Intel's
+  // "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ Instruction"
+  alignas(16) const uint64_t k1k2[2] = { 0x0154442bd4ULL, 0x01c6e41596ULL }; // x^(4*128+32), x^(4*128-32)
+  alignas(16) const uint64_t k3k4[2] = { 0x01751997d0ULL, 0x00ccaa009eULL }; // x^(128+32), x^(128-32)
+  alignas(16) const uint64_t k5k0[2] = { 0x0163cd6124ULL, 0x0000000000ULL }; // x^64
+  alignas(16) const uint64_t poly[2] = { 0x01db710641ULL, 0x01f7011641ULL }; // P(x), floor(x^64 / P(x))
+
+  /*!
+   * \brief Fold 16-byte blocks with carry-less multiplication
+   *
+   * \param size  At least 64, and a multiple of 16
+   * \param crc   The inverted running CRC
+   */
+  TARGET_CLMUL
+  uint32_t UpdateCLMUL(uint32_t crc, const uint8_t* data, size_t size)
+  {
+    __m128i x0, x1, x2, x3, x4, x5, x6, x7, x8, y5, y6, y7, y8;
+
+    x1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x00));
+    x2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x10));
+    x3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x20));
+    x4 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x30));
+
+    x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(static_cast<int>(crc)));
+
+    x0 = _mm_load_si128(reinterpret_cast<const __m128i*>(k1k2));
+
+    data += 64;
+    size -= 64;
+
+    // Fold four blocks at a time
+    while (size >= 64)
+    {
+      x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+      x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+      x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+      x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+
+      x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+      x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+      x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+      x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+
+      y5 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x00));
+      y6 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x10));
+      y7 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x20));
+      y8 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x30));
+
+      x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), y5);
+      x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), y6);
+      x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), y7);
+      x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), y8);
+
+      data += 64;
+      size -= 64;
+    }
+
+    // Fold into a single block
+    x0 = _mm_load_si128(reinterpret_cast<const __m128i*>(k3k4));
+
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+    // Fold the remaining blocks one at a time
+    while (size >= 16)
+    {
+      x2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+
+      x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+      x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+      x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+
+      data += 16;
+      size -= 16;
+    }
+
+    // Fold 128 bits to 64 bits
+    x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+    x3 = _mm_setr_epi32(~0, 0, ~0, 0);
+    x1 = _mm_srli_si128(x1, 8);
+    x1 = _mm_xor_si128(x1, x2);
+
+    x0 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(k5k0));
+
+    x2 = _mm_srli_si128(x1, 4);
+    x1 = _mm_and_si128(x1, x3);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    // Barrett reduction to 32 bits
+    x0 = _mm_load_si128(reinterpret_cast<const __m128i*>(poly));
+
+    x2 = _mm_and_si128(x1, x3);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x10);
+    x2 = _mm_and_si128(x2, x3);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    return static_cast<uint32_t>(_mm_extract_epi32(x1, 1));
+  }
+#endif
+
+#if defined(CRC32_ARM)
+  uint32_t UpdateARM(uint32_t crc, const uint8_t* data, size_t size)
+  {
+    crc = ~crc;
+
+    while (size > 0 && (reinterpret_cast<uintptr_t>(data) & 7) != 0)
+    {
+      crc = __crc32b(crc, *data++);
+      size--;
+    }
+
+    while (size >= 8)
+    {
+      crc = __crc32d(crc, *reinterpret_cast<const uint64_t*>(data));
+      data += 8;
+      size -= 8;
+    }
+
+    while (size > 0)
+    {
+      crc = __crc32b(crc, *data++);
+      size--;
+    }
+
+    return ~crc;
+  }
+#endif
+}
+
+uint32_t CRC32::Update(uint32_t crc, const uint8_t* data, size_t size)
+{
+#if defined(CRC32_CLMUL)
+  if (size >= 64 && CPUFeatures::HasCLMUL())
+  {
+    const size_t blocks = size & ~static_cast<size_t>(15);
+
+    crc = ~UpdateCLMUL(~crc, data, blocks);
+
+    data += blocks;
+    size -= blocks;
+  }
+#elif defined(CRC32_ARM)
+  return UpdateARM(crc, data, size);
+#endif
+
+  return UpdateZlib(crc, data, size);
+}
@@ -0,0 +1,45 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace LIBRETRO
+{
+  /*!
+   * \brief The CRC-32 used by zip, gzip and ROM databases
+   *
+   * Uses carry-less multiplication on x86 and the CRC32 instructions on ARMv8
+   * when available, and zlib otherwise.
+   */
+  class CRC32
+  {
+  public:
+    /*!
+     * \brief Update a running CRC
+     *
+     * \param crc  The CRC of the preceding data, 0 to start
+     *
+     * \return The CRC including the new data
+     */
+    static uint32_t Update(uint32_t crc, const uint8_t* data, size_t size);
+  };
+}
@@ -0,0 +1,146 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "DeltaCodec.h"
+
+#include <string.h>
+
+using namespace LIBRETRO;
+
+// A changed run ends once this many unchanged bytes are found in a row. Short
+// gaps are cheaper to store as XOR'd zeros than as a new record.
+#define MIN_UNCHANGED_RUN  4
+
+namespace
+{
+  inline uint64_t Load64(const uint8_t* data)
+  {
+    uint64_t value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+  }
+
+  inline void WriteVarint(std::vector<uint8_t>& out, size_t value)
+  {
+    while (value >= 0x80)
+    {
+      out.push_back(static_cast<uint8_t>(value | 0x80));
+      value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+  }
+
+  inline bool ReadVarint(const uint8_t*& data, const uint8_t* end, size_t& value)
+  {
+    value = 0;
+    for (unsigned int shift = 0; data < end && shift < 64; shift += 7)
+    {
+      const uint8_t byte = *data++;
+      value |= static_cast<size_t>(byte & 0x7f) << shift;
+      if ((byte & 0x80) == 0)
+        return true;
+    }
+    return false;
+  }
+}
+
+void DeltaCodec::Encode(const uint8_t* previous, const uint8_t* current, size_t size, std::vector<uint8_t>& delta)
+{
+  delta.clear();
+
+  size_t pos = 0;
+  while (pos < size)
+  {
+    // Skip unchanged bytes, a word at a time where possible
+    const size_t unchangedStart = pos;
+    while (pos + sizeof(uint64_t) <= size && Load64(previous + pos) == Load64(current + pos))
+      pos += sizeof(uint64_t);
+    while (pos < size && previous[pos] == current[pos])
+      pos++;
+
+    const size_t unchanged = pos - unchangedStart;
+
+    // Collect changed bytes until a long enough unchanged run is found
+    const size_t changedStart = pos;
+    unsigned int unchangedRun = 0;
+    while (pos < size)
+    {
+      if (previous[pos] == current[pos])
+      {
+        if (++unchangedRun >= MIN_UNCHANGED_RUN)
+          break;
+      }
+      else
+      {
+        unchangedRun = 0;
+      }
+      pos++;
+    }
+
+    // Leave the trailing unchanged bytes for the next record
+    if (pos < size)
+      pos -= MIN_UNCHANGED_RUN - 1;
+    else
+      pos -= unchangedRun;
+
+    const size_t changed = pos - changedStart;
+
+    if (changed == 0 && pos >= size)
+      break; // Only unchanged bytes remain
+
+    WriteVarint(delta, unchanged);
+    WriteVarint(delta, changed);
+
+    const size_t offset = delta.size();
+    delta.resize(offset + changed);
+    for (size_t i = 0; i < changed; i++)
+      delta[offset + i] = previous[changedStart + i] ^ current[changedStart + i];
+  }
+}
+
+bool DeltaCodec::Apply(const uint8_t* delta, size_t deltaSize, uint8_t* buffer, size_t size)
+{
+  const uint8_t* data = delta;
+  const uint8_t* const end = delta + deltaSize;
+
+  size_t pos = 0;
+  while (data < end)
+  {
+    size_t unchanged;
+    size_t changed;
+    if (!ReadVarint(data, end, unchanged) || !ReadVarint(data, end, changed))
+      return false;
+
+    if (unchanged > size - pos)
+      return false;
+    pos += unchanged;
+
+    if (changed > size - pos || changed > static_cast<size_t>(end - data))
+      return false;
+
+    for (size_t i = 0; i < changed; i++)
+      buffer[pos + i] ^= data[i];
+
+    pos += changed;
+    data += changed;
+  }
+
+  return true;
+}
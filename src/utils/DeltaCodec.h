@@ -0,0 +1,59 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace LIBRETRO
+{
+  /*!
+   * \brief Run-length compressed XOR deltas between two equally-sized buffers
+   *
+   * Consecutive save states of a core differ in only a few bytes, so the XOR
+   * of two states is mostly zero. The encoded delta is a sequence of records:
+   *
+   *   <varint: unchanged byte count> <varint: changed byte count> <changed bytes XOR'd>
+   *
+   * Because XOR is its own inverse, applying a delta to either buffer yields
+   * the other one.
+   */
+  class DeltaCodec
+  {
+  public:
+    /*!
+     * \brief Encode the delta between two buffers of the given size
+     *
+     * \param previous  The older buffer
+     * \param current   The newer buffer
+     * \param size      The size of both buffers
+     * \param delta     The encoded delta (overwritten)
+     */
+    static void Encode(const uint8_t* previous, const uint8_t* current, size_t size, std::vector<uint8_t>& delta);
+
+    /*!
+     * \brief Apply an encoded delta to a buffer in place
+     *
+     * \return False if the delta is malformed or doesn't fit the buffer
+     */
+    static bool Apply(const uint8_t* delta, size_t deltaSize, uint8_t* buffer, size_t size);
+  };
+}
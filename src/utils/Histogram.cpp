@@ -0,0 +1,169 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "Histogram.h"
+
+#if defined(_MSC_VER)
+  #include <intrin.h>
+#endif
+
+#include <limits>
+
+using namespace LIBRETRO;
+
+#define SUB_BUCKET_BITS   4
+#define SUB_BUCKET_COUNT  (1 << SUB_BUCKET_BITS)
+
+// Values below SUB_BUCKET_COUNT have a bucket each, then every power of two
+// from 2^SUB_BUCKET_BITS to 2^63 has SUB_BUCKET_COUNT buckets
+#define BUCKET_COUNT  ((64 - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT)
+
+namespace
+{
+  inline unsigned int HighestBit(uint64_t value)
+  {
+#if defined(_MSC_VER) && defined(_M_X64)
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return index;
+#elif defined(__GNUC__)
+    return 63 - __builtin_clzll(value);
+#else
+    unsigned int index = 0;
+    while (value >>= 1)
+      index++;
+    return index;
+#endif
+  }
+}
+
+CHistogram::CHistogram(void) :
+  m_buckets(BUCKET_COUNT)
+{
+  Reset();
+}
+
+void CHistogram::Add(uint64_t value)
+{
+  m_buckets[BucketIndex(value)]++;
+
+  m_count++;
+  m_sum += value;
+
+  if (value < m_min)
+    m_min = value;
+  if (value > m_max)
+    m_max = value;
+}
+
+void CHistogram::Reset(void)
+{
+  m_buckets.assign(BUCKET_COUNT, 0);
+  m_count = 0;
+  m_sum = 0;
+  m_min = std::numeric_limits<uint64_t>::max();
+  m_max = 0;
+}
+
+uint64_t CHistogram::Percentile(double percentile) const
+{
+  if (m_count == 0)
+    return 0;
+
+  uint64_t target = static_cast<uint64_t>(percentile / 100.0 * m_count + 0.5);
+  if (target < 1)
+    target = 1;
+
+  uint64_t cumulative = 0;
+  for (unsigned int i = 0; i < m_buckets.size(); i++)
+  {
+    cumulative += m_buckets[i];
+    if (cumulative >= target)
+    {
+      const uint64_t upperBound = BucketUpperBound(i);
+      return upperBound < m_max ? upperBound : m_max;
+    }
+  }
+
+  return m_max;
+}
+
+unsigned int CHistogram::BucketIndex(uint64_t value)
+{
+  if (value < SUB_BUCKET_COUNT)
+    return static_cast<unsigned int>(value);
+
+  const unsigned int exponent = HighestBit(value);
+  const unsigned int subBucket = static_cast<unsigned int>(value >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKET_COUNT - 1);
+
+  return (exponent - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT + subBucket;
+}
+
+uint64_t CHistogram::BucketLowerBound(unsigned int index)
+{
+  if (index < SUB_BUCKET_COUNT)
+    return index;
+
+  const unsigned int exponent = index / SUB_BUCKET_COUNT + SUB_BUCKET_BITS - 1;
+  const uint64_t subBucket = index % SUB_BUCKET_COUNT;
+
+  return (SUB_BUCKET_COUNT + subBucket) << (exponent - SUB_BUCKET_BITS);
+}
+
+uint64_t CHistogram::BucketUpperBound(unsigned int index)
+{
+  if (index < SUB_BUCKET_COUNT)
+    return index;
+
+  const unsigned int exponent = index / SUB_BUCKET_COUNT + SUB_BUCKET_BITS - 1;
+
+  return BucketLowerBound(index) + (static_cast<uint64_t>(1) << (exponent - SUB_BUCKET_BITS)) - 1;
+}
+
+void CHistogram::WriteJSON(std::ostream& stream, double scale) const
+{
+  stream << "{ ";
+  stream << "\"count\": " << Count() << ", ";
+  stream << "\"min\": " << Min() * scale << ", ";
+  stream << "\"mean\": " << Mean() * scale << ", ";
+  stream << "\"p50\": " << Percentile(50.0) * scale << ", ";
+  stream << "\"p90\": " << Percentile(90.0) * scale << ", ";
+  stream << "\"p99\": " << Percentile(99.0) * scale << ", ";
+  stream << "\"p99.9\": " << Percentile(99.9) * scale << ", ";
+  stream << "\"max\": " << Max() * scale << ", ";
+
+  // Only non-empty buckets, as [lower bound, upper bound, count]
+  stream << "\"buckets\": [";
+  bool bFirst = true;
+  for (unsigned int i = 0; i < BucketCount(); i++)
+  {
+    if (m_buckets[i] == 0)
+      continue;
+
+    if (!bFirst)
+      stream << ", ";
+    bFirst = false;
+
+    stream << "[" << BucketLowerBound(i) * scale << ", "
+                  << BucketUpperBound(i) * scale << ", "
+                  << m_buckets[i] << "]";
+  }
+  stream << "] }";
+}
@@ -0,0 +1,83 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <ostream>
+#include <stdint.h>
+#include <vector>
+
+namespace LIBRETRO
+{
+  /*!
+   * \brief Fixed-bucket histogram with a bounded relative error
+   *
+   * Values are bucketed log-linearly, like HdrHistogram: every power of two
+   * is split into 16 equal buckets, so any recorded value is known to within
+   * 1/16 (6.25%) over the full 64-bit range. Adding a value is a bit scan and
+   * an increment, and never allocates.
+   *
+   * The histogram is unit-agnostic. Not thread safe.
+   */
+  class CHistogram
+  {
+  public:
+    CHistogram(void);
+
+    void Add(uint64_t value);
+    void Reset(void);
+
+    uint64_t Count(void) const { return m_count; }
+    uint64_t Min(void) const { return m_count > 0 ? m_min : 0; }
+    uint64_t Max(void) const { return m_max; }
+    double Mean(void) const { return m_count > 0 ? static_cast<double>(m_sum) / m_count : 0.0; }
+
+    /*!
+     * \brief Get the value below which the given percentage of values fall
+     *
+     * \param percentile  A percentage in [0, 100]
+     *
+     * \return The upper bound of the bucket containing the percentile,
+     *         clamped to the largest value recorded
+     */
+    uint64_t Percentile(double percentile) const;
+
+    // Access to the raw buckets
+    unsigned int BucketCount(void) const { return static_cast<unsigned int>(m_buckets.size()); }
+    uint64_t BucketValue(unsigned int index) const { return m_buckets[index]; }
+    static uint64_t BucketLowerBound(unsigned int index);
+    static uint64_t BucketUpperBound(unsigned int index);
+
+    /*!
+     * \brief Write the statistics and the non-empty buckets as a JSON object
+     *
+     * \param scale  Factor converting recorded values to the output unit
+     */
+    void WriteJSON(std::ostream& stream, double scale) const;
+
+  private:
+    static unsigned int BucketIndex(uint64_t value);
+
+    std::vector<uint64_t> m_buckets;
+    uint64_t              m_count;
+    uint64_t              m_sum;
+    uint64_t              m_min;
+    uint64_t              m_max;
+  };
+}
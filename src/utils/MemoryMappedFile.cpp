@@ -0,0 +1,167 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "MemoryMappedFile.h"
+#include "log/Log.h"
+
+#ifdef _WIN32
+  #include <windows.h>
+#else
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+#include <limits>
+#include <utility>
+
+using namespace LIBRETRO;
+
+CMemoryMappedFile::CMemoryMappedFile(void) :
+  m_data(nullptr),
+  m_size(0),
+  m_mappedSize(0)
+{
+}
+
+void CMemoryMappedFile::Swap(CMemoryMappedFile& other)
+{
+  std::swap(m_data, other.m_data);
+  std::swap(m_size, other.m_size);
+  std::swap(m_mappedSize, other.m_mappedSize);
+}
+
+#ifdef _WIN32
+
+bool CMemoryMappedFile::Open(const std::string& path)
+{
+  Close();
+
+  const int length = MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, nullptr, 0);
+  if (length <= 0)
+    return false;
+
+  std::wstring widePath(length, L'\0');
+  MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, &widePath[0], length);
+
+  HANDLE file = CreateFileW(widePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if (file == INVALID_HANDLE_VALUE)
+    return false;
+
+  LARGE_INTEGER fileSize = { };
+  if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart <= 0 ||
+      static_cast<uint64_t>(fileSize.QuadPart) > std::numeric_limits<size_t>::max())
+  {
+    CloseHandle(file);
+    return false;
+  }
+
+  // Cores may patch their content in place. Copy-on-write pages are copied
+  // on the first write, so the file itself is never modified.
+  HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+  CloseHandle(file);
+
+  if (mapping == nullptr)
+    return false;
+
+  void* data = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+
+  // The view keeps the mapping alive
+  CloseHandle(mapping);
+
+  if (data == nullptr)
+  {
+    dsyslog("Failed to map %s (error %lu)", path.c_str(), GetLastError());
+    return false;
+  }
+
+  m_data = static_cast<uint8_t*>(data);
+  m_size = static_cast<size_t>(fileSize.QuadPart);
+  m_mappedSize = m_size;
+
+  return true;
+}
+
+void CMemoryMappedFile::Close(void)
+{
+  if (m_data != nullptr)
+    UnmapViewOfFile(m_data);
+
+  m_data = nullptr;
+  m_size = 0;
+  m_mappedSize = 0;
+}
+
+#else
+
+bool CMemoryMappedFile::Open(const std::string& path)
+{
+  Close();
+
+  const int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    return false;
+
+  struct stat statStruct = { };
+  if (fstat(fd, &statStruct) != 0 || !S_ISREG(statStruct.st_mode) || statStruct.st_size <= 0 ||
+      static_cast<uint64_t>(statStruct.st_size) > std::numeric_limits<size_t>::max())
+  {
+    close(fd);
+    return false;
+  }
+
+  const size_t size = static_cast<size_t>(statStruct.st_size);
+
+  // Cores may patch their content in place. Private writable pages are
+  // copied on the first write, so the file itself is never modified.
+  void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+
+  // The mapping keeps the file open
+  close(fd);
+
+  if (data == MAP_FAILED)
+  {
+    dsyslog("Failed to map %s", path.c_str());
+    return false;
+  }
+
+  // Cores usually read the whole image right away, start reading it in now
+  madvise(data, size, MADV_SEQUENTIAL);
+  madvise(data, size, MADV_WILLNEED);
+
+  m_data = static_cast<uint8_t*>(data);
+  m_size = size;
+  m_mappedSize = size;
+
+  return true;
+}
+
+void CMemoryMappedFile::Close(void)
+{
+  if (m_data != nullptr)
+    munmap(m_data, m_mappedSize);
+
+  m_data = nullptr;
+  m_size = 0;
+  m_mappedSize = 0;
+}
+
+#endif
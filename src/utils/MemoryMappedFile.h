@@ -0,0 +1,83 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+namespace LIBRETRO
+{
+  /*!
+   * \brief Private memory mapping of a file on the local filesystem
+   *
+   * Pages are faulted in from the page cache as they are touched, so the
+   * contents are never copied and don't count twice against the process's
+   * memory. The mapping is writable, but copy-on-write: a page that is
+   * written to becomes a private copy, and the file is left untouched. The
+   * kernel is advised that the file will be read soon and sequentially, which
+   * enables aggressive read-ahead.
+   */
+  class CMemoryMappedFile
+  {
+  public:
+    CMemoryMappedFile(void);
+    ~CMemoryMappedFile(void) { Close(); }
+
+    /*!
+     * \brief Map the entire file
+     *
+     * \param path  A local path, UTF-8 encoded
+     *
+     * \return True if the file was mapped, false if it couldn't be opened or
+     *         is empty
+     */
+    bool Open(const std::string& path);
+
+    void Close(void);
+
+    /*!
+     * \brief Exchange mappings with another instance
+     */
+    void Swap(CMemoryMappedFile& other);
+
+    bool IsOpen(void) const { return m_data != nullptr; }
+
+    const uint8_t* Data(void) const { return m_data; }
+    uint8_t* Data(void) { return m_data; }
+    size_t Size(void) const { return m_size; }
+
+    /*!
+     * \brief Shrink the size reported by Size(), such as after patching
+     *
+     * The whole file stays mapped until Close().
+     */
+    void Truncate(size_t size) { if (size < m_size) m_size = size; }
+
+  private:
+    // Non-copyable
+    CMemoryMappedFile(const CMemoryMappedFile&);
+    CMemoryMappedFile& operator=(const CMemoryMappedFile&);
+
+    uint8_t* m_data;
+    size_t   m_size;
+    size_t   m_mappedSize;
+  };
+}
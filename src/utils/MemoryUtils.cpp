@@ -0,0 +1,85 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "MemoryUtils.h"
+
+#if defined(_WIN32)
+  #include <windows.h>
+#elif defined(__APPLE__)
+  #include <mach/mach.h>
+#else
+  #include <fstream>
+  #include <stdio.h>
+  #include <string>
+  #include <unistd.h>
+#endif
+
+using namespace LIBRETRO;
+
+#if defined(_WIN32)
+
+uint64_t MemoryUtils::GetAvailableMemory(void)
+{
+  MEMORYSTATUSEX status = { };
+  status.dwLength = sizeof(status);
+  if (!GlobalMemoryStatusEx(&status))
+    return 0;
+
+  return status.ullAvailPhys;
+}
+
+#elif defined(__APPLE__)
+
+uint64_t MemoryUtils::GetAvailableMemory(void)
+{
+  vm_statistics64_data_t stats = { };
+  mach_msg_type_number_t count = HOST_VM_INFO64_COUNT;
+  if (host_statistics64(mach_host_self(), HOST_VM_INFO64, reinterpret_cast<host_info64_t>(&stats), &count) != KERN_SUCCESS)
+    return 0;
+
+  // Inactive pages are reclaimed before anything is swapped out
+  return static_cast<uint64_t>(stats.free_count + stats.inactive_count) * vm_page_size;
+}
+
+#else
+
+uint64_t MemoryUtils::GetAvailableMemory(void)
+{
+  // Free pages don't include the page cache, which the kernel gives up when
+  // needed. MemAvailable accounts for it (Linux 3.14 and later).
+  std::ifstream meminfo("/proc/meminfo");
+
+  std::string line;
+  while (std::getline(meminfo, line))
+  {
+    unsigned long long valueKB;
+    if (sscanf(line.c_str(), "MemAvailable: %llu kB", &valueKB) == 1)
+      return static_cast<uint64_t>(valueKB) * 1024;
+  }
+
+  const long pages = sysconf(_SC_AVPHYS_PAGES);
+  const long pageSize = sysconf(_SC_PAGESIZE);
+  if (pages <= 0 || pageSize <= 0)
+    return 0;
+
+  return static_cast<uint64_t>(pages) * static_cast<uint64_t>(pageSize);
+}
+
+#endif
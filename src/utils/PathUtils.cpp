@@ -20,6 +20,7 @@
 
 #include "PathUtils.h"
 
+#include <ctype.h>
 #include <string.h>
 
 using namespace LIBRETRO;
@@ -48,3 +49,33 @@ std::string PathUtils::GetBasename(const std::string& path)
 
   return s;
 }
+
+std::string PathUtils::RemoveExtension(const std::string& path)
+{
+  const size_t dot = path.rfind('.');
+  if (dot == std::string::npos)
+    return path;
+
+  // The dot must be in the filename, not a directory
+  const size_t slash = path.find_last_of("/\\");
+  if (slash != std::string::npos && slash > dot)
+    return path;
+
+  return path.substr(0, dot);
+}
+
+bool PathUtils::IsLocalPath(const std::string& path)
+{
+  if (path.find("://") != std::string::npos)
+    return false;
+
+  // POSIX absolute path
+  if (!path.empty() && path[0] == '/')
+    return true;
+
+  // Windows drive letter, e.g. C:\ or C:/
+  if (path.size() >= 3 && isalpha(static_cast<unsigned char>(path[0])) && path[1] == ':' && (path[2] == '\\' || path[2] == '/'))
+    return true;
+
+  return false;
+}
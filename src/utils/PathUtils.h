@@ -37,5 +37,16 @@ namespace LIBRETRO
      * \brief Get the base filename, or empty if path ends in a / or \
      */
     static std::string GetBasename(const std::string& path);
+
+    /*!
+     * \brief Get the path without the extension of its filename, if any
+     */
+    static std::string RemoveExtension(const std::string& path);
+
+    /*!
+     * \brief Check if a path is an absolute path on the local filesystem, as
+     *        opposed to a VFS URL such as smb:// or special://
+     */
+    static bool IsLocalPath(const std::string& path);
   };
 }
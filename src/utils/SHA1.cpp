@@ -0,0 +1,375 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "SHA1.h"
+#include "CPUFeatures.h"
+
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
+
+#if (defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86))
+  #define SHA1_SHANI 1
+  #include <immintrin.h>
+  #if defined(__GNUC__)
+    #define TARGET_SHA __attribute__((target("sha,sse4.1,ssse3")))
+  #else
+    #define TARGET_SHA
+  #endif
+#endif
+
+using namespace LIBRETRO;
+
+#define SHA1_BLOCK_SIZE  64
+
+namespace
+{
+  inline uint32_t Rotl(uint32_t value, unsigned int bits)
+  {
+    return (value << bits) | (value >> (32 - bits));
+  }
+
+  inline uint32_t LoadBE32(const uint8_t* data)
+  {
+    return (static_cast<uint32_t>(data[0]) << 24) |
+           (static_cast<uint32_t>(data[1]) << 16) |
+           (static_cast<uint32_t>(data[2]) << 8) |
+            static_cast<uint32_t>(data[3]);
+  }
+
+  void ProcessBlocksScalar(uint32_t state[5], const uint8_t* data, size_t count)
+  {
+    uint32_t w[80];
+
+    for (size_t block = 0; block < count; block++, data += SHA1_BLOCK_SIZE)
+    {
+      for (unsigned int i = 0; i < 16; i++)
+        w[i] = LoadBE32(data + 4 * i);
+      for (unsigned int i = 16; i < 80; i++)
+        w[i] = Rotl(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+
+      uint32_t a = state[0];
+      uint32_t b = state[1];
+      uint32_t c = state[2];
+      uint32_t d = state[3];
+      uint32_t e = state[4];
+
+      for (unsigned int i = 0; i < 80; i++)
+      {
+        uint32_t f;
+        uint32_t k;
+        if (i < 20)
+        {
+          f = (b & c) | (~b & d);
+          k = 0x5a827999;
+        }
+        else if (i < 40)
+        {
+          f = b ^ c ^ d;
+          k = 0x6ed9eba1;
+        }
+        else if (i < 60)
+        {
+          f = (b & c) | (b & d) | (c & d);
+          k = 0x8f1bbcdc;
+        }
+        else
+        {
+          f = b ^ c ^ d;
+          k = 0xca62c1d6;
+        }
+
+        const uint32_t temp = Rotl(a, 5) + f + e + k + w[i];
+        e = d;
+        d = c;
+        c = Rotl(b, 30);
+        b = a;
+        a = temp;
+      }
+
+      state[0] += a;
+      state[1] += b;
+      state[2] += c;
+      state[3] += d;
+      state[4] += e;
+    }
+  }
+
+#if defined(SHA1_SHANI)
+  /*!
+   * \brief Process blocks with the SHA extensions
+   *
+   * Each sha1rnds4 performs four rounds. The message schedule for later
+   * rounds is computed by sha1msg1/sha1msg2 interleaved with the rounds.
+   */
+  TARGET_SHA
+  void ProcessBlocksSHANI(uint32_t state[5], const uint8_t* data, size_t count)
+  {
+    const __m128i MASK = _mm_set_epi64x(0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL);
+
+    __m128i ABCD = _mm_loadu_si128(reinterpret_cast<const __m128i*>(state));
+    __m128i E0 = _mm_set_epi32(static_cast<int>(state[4]), 0, 0, 0);
+    ABCD = _mm_shuffle_epi32(ABCD, 0x1b);
+
+    for (size_t block = 0; block < count; block++, data += SHA1_BLOCK_SIZE)
+    {
+      const __m128i ABCD_SAVE = ABCD;
+      const __m128i E0_SAVE = E0;
+      __m128i E1;
+
+      __m128i MSG0 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x00)), MASK);
+      __m128i MSG1 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x10)), MASK);
+      __m128i MSG2 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x20)), MASK);
+      __m128i MSG3 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x30)), MASK);
+
+      // Rounds 0-3
+      E0 = _mm_add_epi32(E0, MSG0);
+      E1 = ABCD;
+      ABCD = _mm_sha1rnds4_epu32(ABCD, E0, 0);
+
+      // Rounds 4-7
+      E1 = _mm_sha1nexte_epu32(E1, MSG1);
+      E0 = ABCD;
+      ABCD = _mm_sha1rnds4_epu32(ABCD, E1, 0);
+      MSG0 = _mm_sha1msg1_epu32(MSG0, MSG1);
+
+      // Rounds 8-11
+      E0 = _mm_sha1nexte_epu32(E0, MSG2);
+      E1 = ABCD;
+      ABCD = _mm_sha1rnds4_epu32(ABCD, E0, 0);
+      MSG1 = _mm_sha1msg1_epu32(MSG1, MSG2);
+      MSG0 = _mm_xor_si128(MSG0, MSG2);
+
+      // Rounds 12-15
+      E1 = _mm_sha1nexte_epu32(E1, MSG3);
+      E0 = ABCD;
+      MSG0 = _mm_sha1msg2_epu32(MSG0, MSG3);
+      ABCD = _mm_sha1rnds4_epu32(ABCD, E1, 0);
+      MSG2 = _mm_sha1msg1_epu32(MSG2, MSG3);
+      MSG1 = _mm_xor_si128(MSG1, MSG3);
+
+      // Rounds 16-19
+      E0 = _mm_sha1nexte_epu32(E0, MSG0);
+      E1 = ABCD;
+      MSG1 = _mm_sha1msg2_epu32(MSG1, MSG0);
+      ABCD = _mm_sha1rnds4_epu32(ABCD, E0, 0);
+      MSG3 = _mm_sha1msg1_epu32(MSG3, MSG0);
+      MSG2 = _mm_xor_si128(MSG2, MSG0);
+
+      // Rounds 20-23
+      E1 = _mm_sha1nexte_epu32(E1, MSG1);
+      E0 = ABCD;
+      MSG2 = _mm_sha1msg2_epu32(MSG2, MSG1);
+      ABCD = _mm_sha1rnds4_epu32(ABCD, E1, 1);
+      MSG0 = _mm_sha1msg1_epu32(MSG0, MSG1);
+      MSG3 = _mm_xor_si128(MSG3, MSG1);
+
+      // Rounds 24-27
+      E0 = _mm_sha1nexte_epu32(E0, MSG2);
+      E1 = ABCD;
+      MSG3 = _mm_sha1msg2_epu32(MSG3, MSG2);
+      ABCD = _mm_sha1rnds4_epu32(ABCD, E0, 1);
+      MSG1 = _mm_sha1msg1_epu32(MSG1, MSG2);
+      MSG0 = _mm_xor_si128(MSG0, MSG2);
+
+      // Rounds 28-31
+      E1 = _mm_sha1nexte_epu32(E1, MSG3);
+      E0 = ABCD;
+      MSG0 = _mm_sha1msg2_epu32(MSG0, MSG3);
+      ABCD = _mm_sha1rnds4_epu32(ABCD, E1, 1);
+      MSG2 = _mm_sha1msg1_epu32(MSG2, MSG3);
+      MSG1 = _mm_xor_si128(MSG1, MSG3);
+
+      // Rounds 32-35
+      E0 = _mm_sha1nexte_epu32(E0, MSG0);
+      E1 = ABCD;
+      MSG1 = _mm_sha1msg2_epu32(MSG1, MSG0);
+      ABCD = _mm_sha1rnds4_epu32(ABCD, E0, 1);
+      MSG3 = _mm_sha1msg1_epu32(MSG3, MSG0);
+      MSG2 = _mm_xor_si128(MSG2, MSG0);
+
+      // Rounds 36-39
+      E1 = _mm_sha1nexte_epu32(E1, MSG1);
+      E0 = ABCD;
+      MSG2 = _mm_sha1msg2_epu32(MSG2, MSG1);
+      ABCD = _mm_sha1rnds4_epu32(ABCD, E1, 1);
+      MSG0 = _mm_sha1msg1_epu32(MSG0, MSG1);
+      MSG3 = _mm_xor_si128(MSG3, MSG1);
+
+      // Rounds 40-43
+      E0 = _mm_sha1nexte_epu32(E0, MSG2);
+      E1 = ABCD;
+      MSG3 = _mm_sha1msg2_epu32(MSG3, MSG2);
+      ABCD = _mm_sha1rnds4_epu32(ABCD, E0, 2);
+      MSG1 = _mm_sha1msg1_epu32(MSG1, MSG2);
+      MSG0 = _mm_xor_si128(MSG0, MSG2);
+
+      // Rounds 44-47
+      E1 = _mm_sha1nexte_epu32(E1, MSG3);
+      E0 = ABCD;
+      MSG0 = _mm_sha1msg2_epu32(MSG0, MSG3);
+      ABCD = _mm_sha1rnds4_epu32(ABCD, E1, 2);
+      MSG2 = _mm_sha1msg1_epu32(MSG2, MSG3);
+      MSG1 = _mm_xor_si128(MSG1, MSG3);
+
+      // Rounds 48-51
+      E0 = _mm_sha1nexte_epu32(E0, MSG0);
+      E1 = ABCD;
+      MSG1 = _mm_sha1msg2_epu32(MSG1, MSG0);
+      ABCD = _mm_sha1rnds4_epu32(ABCD, E0, 2);
+      MSG3 = _mm_sha1msg1_epu32(MSG3, MSG0);
+      MSG2 = _mm_xor_si128(MSG2, MSG0);
+
+      // Rounds 52-55
+      E1 = _mm_sha1nexte_epu32(E1, MSG1);
+      E0 = ABCD;
+      MSG2 = _mm_sha1msg2_epu32(MSG2, MSG1);
+      ABCD = _mm_sha1rnds4_epu32(ABCD, E1, 2);
+      MSG0 = _mm_sha1msg1_epu32(MSG0, MSG1);
+      MSG3 = _mm_xor_si128(MSG3, MSG1);
+
+      // Rounds 56-59
+      E0 = _mm_sha1nexte_epu32(E0, MSG2);
+      E1 = ABCD;
+      MSG3 = _mm_sha1msg2_epu32(MSG3, MSG2);
+      ABCD = _mm_sha1rnds4_epu32(ABCD, E0, 2);
+      MSG1 = _mm_sha1msg1_epu32(MSG1, MSG2);
+      MSG0 = _mm_xor_si128(MSG0, MSG2);
+
+      // Rounds 60-63
+      E1 = _mm_sha1nexte_epu32(E1, MSG3);
+      E0 = ABCD;
+      MSG0 = _mm_sha1msg2_epu32(MSG0, MSG3);
+      ABCD = _mm_sha1rnds4_epu32(ABCD, E1, 3);
+      MSG2 = _mm_sha1msg1_epu32(MSG2, MSG3);
+      MSG1 = _mm_xor_si128(MSG1, MSG3);
+
+      // Rounds 64-67
+      E0 = _mm_sha1nexte_epu32(E0, MSG0);
+      E1 = ABCD;
+      MSG1 = _mm_sha1msg2_epu32(MSG1, MSG0);
+      ABCD = _mm_sha1rnds4_epu32(ABCD, E0, 3);
+      MSG3 = _mm_sha1msg1_epu32(MSG3, MSG0);
+      MSG2 = _mm_xor_si128(MSG2, MSG0);
+
+      // Rounds 68-71
+      E1 = _mm_sha1nexte_epu32(E1, MSG1);
+      E0 = ABCD;
+      MSG2 = _mm_sha1msg2_epu32(MSG2, MSG1);
+      ABCD = _mm_sha1rnds4_epu32(ABCD, E1, 3);
+      MSG3 = _mm_xor_si128(MSG3, MSG1);
+
+      // Rounds 72-75
+      E0 = _mm_sha1nexte_epu32(E0, MSG2);
+      E1 = ABCD;
+      MSG3 = _mm_sha1msg2_epu32(MSG3, MSG2);
+      ABCD = _mm_sha1rnds4_epu32(ABCD, E0, 3);
+
+      // Rounds 76-79
+      E1 = _mm_sha1nexte_epu32(E1, MSG3);
+      E0 = ABCD;
+      ABCD = _mm_sha1rnds4_epu32(ABCD, E1, 3);
+
+      E0 = _mm_sha1nexte_epu32(E0, E0_SAVE);
+      ABCD = _mm_add_epi32(ABCD, ABCD_SAVE);
+    }
+
+    ABCD = _mm_shuffle_epi32(ABCD, 0x1b);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(state), ABCD);
+    state[4] = static_cast<uint32_t>(_mm_extract_epi32(E0, 3));
+  }
+#endif
+}
+
+void CSHA1::Reset(void)
+{
+  m_state[0] = 0x67452301;
+  m_state[1] = 0xefcdab89;
+  m_state[2] = 0x98badcfe;
+  m_state[3] = 0x10325476;
+  m_state[4] = 0xc3d2e1f0;
+  m_length = 0;
+  m_bufferSize = 0;
+}
+
+void CSHA1::Update(const uint8_t* data, size_t size)
+{
+  m_length += size;
+
+  if (m_bufferSize > 0)
+  {
+    const size_t count = std::min(size, SHA1_BLOCK_SIZE - m_bufferSize);
+    memcpy(m_buffer + m_bufferSize, data, count);
+    m_bufferSize += count;
+    data += count;
+    size -= count;
+
+    if (m_bufferSize < SHA1_BLOCK_SIZE)
+      return;
+
+    ProcessBlocks(m_buffer, 1);
+    m_bufferSize = 0;
+  }
+
+  const size_t blocks = size / SHA1_BLOCK_SIZE;
+  if (blocks > 0)
+  {
+    ProcessBlocks(data, blocks);
+    data += blocks * SHA1_BLOCK_SIZE;
+    size -= blocks * SHA1_BLOCK_SIZE;
+  }
+
+  if (size > 0)
+  {
+    memcpy(m_buffer, data, size);
+    m_bufferSize = size;
+  }
+}
+
+std::string CSHA1::Finalize(void)
+{
+  const uint64_t bitLength = m_length * 8;
+
+  // Pad with 0x80, zeros, then the big-endian bit length
+  uint8_t padding[2 * SHA1_BLOCK_SIZE] = { 0x80 };
+  const size_t padSize = (m_bufferSize < 56 ? 56 : 120) - m_bufferSize;
+  for (unsigned int i = 0; i < 8; i++)
+    padding[padSize + i] = static_cast<uint8_t>(bitLength >> (56 - 8 * i));
+  Update(padding, padSize + 8);
+
+  char digest[41];
+  for (unsigned int i = 0; i < 5; i++)
+    sprintf(digest + 8 * i, "%08x", m_state[i]);
+
+  return digest;
+}
+
+void CSHA1::ProcessBlocks(const uint8_t* data, size_t count)
+{
+#if defined(SHA1_SHANI)
+  if (CPUFeatures::HasSHA())
+  {
+    ProcessBlocksSHANI(m_state, data, count);
+    return;
+  }
+#endif
+
+  ProcessBlocksScalar(m_state, data, count);
+}
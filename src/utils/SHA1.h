@@ -0,0 +1,56 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+namespace LIBRETRO
+{
+  /*!
+   * \brief Incremental SHA-1, as used by ROM databases to identify content
+   *
+   * Uses the SHA extensions on x86 when available.
+   */
+  class CSHA1
+  {
+  public:
+    CSHA1(void) { Reset(); }
+
+    void Reset(void);
+    void Update(const uint8_t* data, size_t size);
+
+    /*!
+     * \brief Get the digest of the data added so far as 40 lowercase hex digits
+     *
+     * The hash must be reset before it's used again.
+     */
+    std::string Finalize(void);
+
+  private:
+    void ProcessBlocks(const uint8_t* data, size_t count);
+
+    uint32_t m_state[5];
+    uint64_t m_length; // In bytes
+    uint8_t  m_buffer[64];
+    size_t   m_bufferSize;
+  };
+}
@@ -0,0 +1,133 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <atomic>
+#include <stddef.h>
+#include <vector>
+
+namespace LIBRETRO
+{
+  /*!
+   * \brief Lock-free ring of reusable slots for one producer and one consumer
+   *
+   * Slots are written and read in place, so buffers inside T keep their
+   * capacity and are reused without allocating once the ring has warmed up.
+   *
+   * The producer calls BeginWrite() and, if a slot was returned, EndWrite()
+   * to publish it. The consumer does the same with BeginRead() and EndRead().
+   */
+  template<typename T>
+  class CSpscRing
+  {
+  public:
+    /*!
+     * \param capacity  Number of slots, rounded up to a power of two
+     */
+    explicit CSpscRing(size_t capacity) :
+      m_head(0),
+      m_tail(0)
+    {
+      size_t size = 1;
+      while (size < capacity)
+        size <<= 1;
+
+      m_slots.resize(size);
+      m_mask = size - 1;
+    }
+
+    // Producer side
+
+    /*!
+     * \brief Get the next free slot
+     *
+     * \return The slot, or nullptr if the ring is full
+     */
+    T* BeginWrite()
+    {
+      const size_t tail = m_tail.load(std::memory_order_relaxed);
+      if (tail - m_head.load(std::memory_order_acquire) == m_slots.size())
+        return nullptr;
+
+      return &m_slots[tail & m_mask];
+    }
+
+    /*!
+     * \brief Publish the slot returned by BeginWrite()
+     */
+    void EndWrite()
+    {
+      m_tail.store(m_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // Consumer side
+
+    /*!
+     * \brief Get the oldest published slot
+     *
+     * \return The slot, or nullptr if the ring is empty
+     */
+    T* BeginRead()
+    {
+      const size_t head = m_head.load(std::memory_order_relaxed);
+      if (head == m_tail.load(std::memory_order_acquire))
+        return nullptr;
+
+      return &m_slots[head & m_mask];
+    }
+
+    /*!
+     * \brief Release the slot returned by BeginRead()
+     */
+    void EndRead()
+    {
+      m_head.store(m_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    /*!
+     * \brief Approximate number of published slots
+     */
+    size_t Size() const
+    {
+      return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+    }
+
+    /*!
+     * \brief Discard all slots. Neither side may be active.
+     */
+    void Clear()
+    {
+      m_head.store(0);
+      m_tail.store(0);
+    }
+
+  private:
+    std::vector<T> m_slots;
+    size_t         m_mask;
+
+    // Keep the indices on separate cache lines so the two threads don't
+    // invalidate each other's line on every update
+    char                m_pad0[64];
+    std::atomic<size_t> m_head; // Written by the consumer
+    char                m_pad1[64 - sizeof(std::atomic<size_t>)];
+    std::atomic<size_t> m_tail; // Written by the producer
+    char                m_pad2[64 - sizeof(std::atomic<size_t>)];
+  };
+}
@@ -0,0 +1,116 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <stddef.h>
+#include <string.h>
+
+namespace LIBRETRO
+{
+  /*!
+   * \brief Entry of a constant table from names to values
+   */
+  template<typename T>
+  struct StringTableEntry
+  {
+    const char* name;
+    T           value;
+  };
+
+  /*!
+   * \brief Lookups in constant tables sorted by name
+   *
+   * Tables are constexpr arrays of StringTableEntry written in strcmp() order.
+   * Each table is the only place its names are spelled out, and IsSorted()
+   * lets a static_assert reject a table that was edited out of order. Lookups
+   * are a binary search that doesn't allocate.
+   */
+  class StringTable
+  {
+  public:
+    /*!
+     * \brief strcmp() that can be evaluated at compile time
+     */
+    static constexpr int Compare(const char* lhs, const char* rhs)
+    {
+      return *lhs != *rhs ? (static_cast<unsigned char>(*lhs) < static_cast<unsigned char>(*rhs) ? -1 : 1) :
+             *lhs == '\0' ? 0 :
+             Compare(lhs + 1, rhs + 1);
+    }
+
+    /*!
+     * \brief True if the names of a table are unique and in strcmp() order
+     */
+    template<typename T, size_t N>
+    static constexpr bool IsSorted(const StringTableEntry<T> (&table)[N], size_t index = 1)
+    {
+      return index >= N || (Compare(table[index - 1].name, table[index].name) < 0 && IsSorted(table, index + 1));
+    }
+
+    /*!
+     * \brief Find the value of a name
+     *
+     * \return The value, or nullptr if the name isn't in the table
+     */
+    template<typename T, size_t N>
+    static const T* Find(const StringTableEntry<T> (&table)[N], const char* name)
+    {
+      size_t first = 0;
+      size_t count = N;
+
+      while (count > 0)
+      {
+        const size_t step = count / 2;
+        if (strcmp(table[first + step].name, name) < 0)
+        {
+          first += step + 1;
+          count -= step + 1;
+        }
+        else
+        {
+          count = step;
+        }
+      }
+
+      if (first < N && strcmp(table[first].name, name) == 0)
+        return &table[first].value;
+
+      return nullptr;
+    }
+
+    /*!
+     * \brief Find the first name with the given value, for the rare reverse
+     *        lookups. Takes linear time.
+     *
+     * \return The name, or nullptr if no entry has the value
+     */
+    template<typename T, size_t N>
+    static const char* FindName(const StringTableEntry<T> (&table)[N], const T& value)
+    {
+      for (const StringTableEntry<T>& entry : table)
+      {
+        if (entry.value == value)
+          return entry.name;
+      }
+
+      return nullptr;
+    }
+  };
+}
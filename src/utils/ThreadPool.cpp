@@ -0,0 +1,137 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "ThreadPool.h"
+#include "log/Log.h"
+
+using namespace LIBRETRO;
+using namespace P8PLATFORM;
+
+CThreadPool::CThreadPool(unsigned int threadCount) :
+  m_runningTasks(0)
+{
+  for (unsigned int i = 0; i < threadCount; i++)
+  {
+    std::unique_ptr<CWorker> worker(new CWorker(*this));
+    if (!worker->CreateThread(false))
+    {
+      esyslog("Failed to create worker thread");
+      break;
+    }
+    m_workers.push_back(std::move(worker));
+  }
+}
+
+CThreadPool::~CThreadPool(void)
+{
+  for (auto& worker : m_workers)
+    worker->StopThread(-1);
+
+  m_taskEvent.Broadcast();
+
+  for (auto& worker : m_workers)
+    worker->StopThread();
+}
+
+void CThreadPool::Submit(Task task)
+{
+  // Without workers, run the task on the calling thread
+  if (m_workers.empty())
+  {
+    task();
+    return;
+  }
+
+  {
+    CLockObject lock(m_mutex);
+    m_tasks.push_back(std::move(task));
+  }
+
+  m_taskEvent.Signal();
+}
+
+void CThreadPool::Wait(void)
+{
+  while (true)
+  {
+    {
+      CLockObject lock(m_mutex);
+      if (m_tasks.empty() && m_runningTasks == 0)
+        break;
+    }
+
+    m_doneEvent.Wait();
+  }
+}
+
+bool CThreadPool::GetTask(Task& task)
+{
+  CLockObject lock(m_mutex);
+
+  if (m_tasks.empty())
+    return false;
+
+  task = std::move(m_tasks.front());
+  m_tasks.pop_front();
+  m_runningTasks++;
+
+  // Signals may have coalesced while the workers were busy, so pass the
+  // wake-up on to the next worker
+  if (!m_tasks.empty())
+    m_taskEvent.Signal();
+
+  return true;
+}
+
+void CThreadPool::TaskFinished(void)
+{
+  bool bDone;
+
+  {
+    CLockObject lock(m_mutex);
+    m_runningTasks--;
+    bDone = (m_tasks.empty() && m_runningTasks == 0);
+  }
+
+  if (bDone)
+    m_doneEvent.Signal();
+}
+
+void* CThreadPool::CWorker::Process(void)
+{
+  while (!IsStopped())
+  {
+    Task task;
+    if (!m_pool.GetTask(task))
+    {
+      m_pool.m_taskEvent.Wait();
+      continue;
+    }
+
+    task();
+
+    m_pool.TaskFinished();
+  }
+
+  // Wake the next worker being stopped in case the broadcast was consumed
+  m_pool.m_taskEvent.Signal();
+
+  return nullptr;
+}
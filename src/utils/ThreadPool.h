@@ -0,0 +1,89 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include "p8-platform/threads/mutex.h"
+#include "p8-platform/threads/threads.h"
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace LIBRETRO
+{
+  /*!
+   * \brief Small fixed-size pool of worker threads
+   *
+   * Tasks are run in submission order by whichever worker is free. Wait()
+   * blocks until every submitted task has finished, so a batch of independent
+   * jobs can be fanned out and joined.
+   */
+  class CThreadPool
+  {
+  public:
+    typedef std::function<void()> Task;
+
+    CThreadPool(unsigned int threadCount);
+    ~CThreadPool(void);
+
+    unsigned int ThreadCount(void) const { return static_cast<unsigned int>(m_workers.size()); }
+
+    void Submit(Task task);
+
+    /*!
+     * \brief Wait for all submitted tasks to finish
+     */
+    void Wait(void);
+
+  private:
+    class CWorker : public P8PLATFORM::CThread
+    {
+    public:
+      CWorker(CThreadPool& pool) : m_pool(pool) { }
+
+    protected:
+      // implementation of CThread
+      virtual void* Process(void) override;
+
+    private:
+      CThreadPool& m_pool;
+    };
+
+    /*!
+     * \brief Take the next task from the queue
+     *
+     * \return False if the queue is empty
+     */
+    bool GetTask(Task& task);
+
+    void TaskFinished(void);
+
+    std::vector<std::unique_ptr<CWorker>> m_workers;
+
+    // Queue, protected by m_mutex
+    std::deque<Task>   m_tasks;
+    unsigned int       m_runningTasks;
+    P8PLATFORM::CMutex m_mutex;
+
+    P8PLATFORM::CEvent m_taskEvent; // Signaled when a task is submitted
+    P8PLATFORM::CEvent m_doneEvent; // Signaled when the last task finishes
+  };
+}
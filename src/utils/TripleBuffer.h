@@ -0,0 +1,86 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <atomic>
+
+namespace LIBRETRO
+{
+  /*!
+   * \brief Lock-free hand-off of the latest value from one writer to one reader
+   *
+   * Double buffering where the buffers are swapped through a third one, so
+   * that neither side ever waits for the other. The writer fills the back
+   * buffer and publishes it. The reader picks up the most recently published
+   * buffer, if any, and reads it until the next update. Values published
+   * while the reader isn't looking are replaced, never queued, so the value
+   * must be a complete state rather than a change.
+   */
+  template<typename T>
+  class CTripleBuffer
+  {
+  public:
+    CTripleBuffer(void) :
+      m_back(0),
+      m_middle(1),
+      m_front(2)
+    {
+    }
+
+    // Writer side
+
+    T& Back(void) { return m_buffers[m_back]; }
+
+    /*!
+     * \brief Make the back buffer available to the reader
+     */
+    void Publish(void)
+    {
+      m_back = m_middle.exchange(m_back | DIRTY_FLAG, std::memory_order_acq_rel) & INDEX_MASK;
+    }
+
+    // Reader side
+
+    /*!
+     * \brief Switch to the most recently published buffer
+     *
+     * \return True if a buffer was published since the last update
+     */
+    bool Update(void)
+    {
+      if ((m_middle.load(std::memory_order_relaxed) & DIRTY_FLAG) == 0)
+        return false;
+
+      m_front = m_middle.exchange(m_front, std::memory_order_acq_rel) & INDEX_MASK;
+      return true;
+    }
+
+    const T& Front(void) const { return m_buffers[m_front]; }
+
+  private:
+    static const unsigned int INDEX_MASK = 0x3;
+    static const unsigned int DIRTY_FLAG = 0x4;
+
+    T                         m_buffers[3];
+    unsigned int              m_back;   // Writer only
+    std::atomic<unsigned int> m_middle; // Index of the buffer in transit, with DIRTY_FLAG if published
+    unsigned int              m_front;  // Reader only
+  };
+}
@@ -0,0 +1,328 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "ArchiveUtils.h"
+#include "log/Log.h"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <string.h>
+
+using namespace LIBRETRO;
+
+#define ZIP_LOCAL_HEADER_SIGNATURE    0x04034b50
+#define ZIP_CENTRAL_HEADER_SIGNATURE  0x02014b50
+#define ZIP_END_SIGNATURE             0x06054b50
+
+#define ZIP_LOCAL_HEADER_SIZE    30
+#define ZIP_CENTRAL_HEADER_SIZE  46
+#define ZIP_END_SIZE             22
+#define ZIP_MAX_COMMENT_SIZE     0xffff
+
+#define ZIP_METHOD_STORE    0
+#define ZIP_METHOD_DEFLATE  8
+
+#define ZIP_FLAG_ENCRYPTED  0x0001
+
+// zlib takes 32-bit lengths, so large buffers are fed in pieces
+#define INFLATE_MAX_CHUNK  (1U << 30)
+
+namespace
+{
+  inline uint16_t Read16(const uint8_t* data)
+  {
+    return static_cast<uint16_t>(data[0] | (data[1] << 8));
+  }
+
+  inline uint32_t Read32(const uint8_t* data)
+  {
+    return static_cast<uint32_t>(data[0]) |
+           static_cast<uint32_t>(data[1]) << 8 |
+           static_cast<uint32_t>(data[2]) << 16 |
+           static_cast<uint32_t>(data[3]) << 24;
+  }
+
+  /*!
+   * \brief Inflate a stream into the end of the content buffer
+   *
+   * \param windowBits  -15 for raw deflate, 15 + 16 for gzip
+   * \param sizeHint    Expected size of the content
+   * \param consumed    Set to the number of input bytes used
+   */
+  bool Inflate(const uint8_t* data, size_t size, int windowBits, size_t sizeHint, size_t maxSize, std::vector<uint8_t>& content, size_t& consumed)
+  {
+    z_stream stream = { };
+    if (inflateInit2(&stream, windowBits) != Z_OK)
+      return false;
+
+    size_t inputPos = 0;
+    size_t outputPos = content.size();
+    int result = Z_OK;
+
+    while (result == Z_OK)
+    {
+      if (stream.avail_in == 0 && inputPos < size)
+      {
+        const size_t chunk = std::min<size_t>(size - inputPos, INFLATE_MAX_CHUNK);
+        stream.next_in = const_cast<Bytef*>(data + inputPos);
+        stream.avail_in = static_cast<uInt>(chunk);
+        inputPos += chunk;
+      }
+
+      if (outputPos == content.size())
+      {
+        if (content.size() >= maxSize)
+        {
+          result = Z_MEM_ERROR;
+          break;
+        }
+
+        // Leave a spare byte so that zlib can report the end of the stream
+        // without another round of growth. Grow geometrically once the hint
+        // turns out to be too small.
+        size_t newSize = content.size() <= sizeHint ? sizeHint + 1 : content.size() * 2;
+        newSize = std::min(std::max<size_t>(newSize, 64 * 1024), maxSize);
+        content.resize(newSize);
+      }
+
+      const size_t available = std::min<size_t>(content.size() - outputPos, INFLATE_MAX_CHUNK);
+      stream.next_out = content.data() + outputPos;
+      stream.avail_out = static_cast<uInt>(available);
+
+      result = inflate(&stream, Z_NO_FLUSH);
+
+      outputPos += available - stream.avail_out;
+
+      // No progress is possible without more input
+      if (result == Z_BUF_ERROR && stream.avail_in == 0 && inputPos == size)
+        break;
+      if (result == Z_BUF_ERROR)
+        result = Z_OK;
+    }
+
+    consumed = inputPos - stream.avail_in;
+    content.resize(outputPos);
+
+    inflateEnd(&stream);
+
+    return result == Z_STREAM_END;
+  }
+}
+
+ARCHIVE_FORMAT ArchiveUtils::GetFormat(const uint8_t* data, size_t size)
+{
+  if (size >= ZIP_LOCAL_HEADER_SIZE && Read32(data) == ZIP_LOCAL_HEADER_SIGNATURE)
+    return ARCHIVE_FORMAT_ZIP;
+
+  if (size >= 18 && data[0] == 0x1f && data[1] == 0x8b && data[2] == Z_DEFLATED)
+    return ARCHIVE_FORMAT_GZIP;
+
+  return ARCHIVE_FORMAT_NONE;
+}
+
+bool ArchiveUtils::Extract(const uint8_t* data, size_t size, size_t maxSize, std::vector<uint8_t>& content)
+{
+  content.clear();
+
+  switch (GetFormat(data, size))
+  {
+  case ARCHIVE_FORMAT_ZIP:
+    return ExtractZip(data, size, maxSize, content);
+  case ARCHIVE_FORMAT_GZIP:
+    return ExtractGzip(data, size, maxSize, content);
+  default:
+    break;
+  }
+
+  return false;
+}
+
+bool ArchiveUtils::ExtractZip(const uint8_t* data, size_t size, size_t maxSize, std::vector<uint8_t>& content)
+{
+  // Find the end of central directory record, which is followed by a comment
+  // of variable length
+  const uint8_t* end = nullptr;
+  const size_t searchStart = size > ZIP_END_SIZE + ZIP_MAX_COMMENT_SIZE ? size - ZIP_END_SIZE - ZIP_MAX_COMMENT_SIZE : 0;
+  for (size_t pos = size - ZIP_END_SIZE + 1; pos-- > searchStart; )
+  {
+    if (Read32(data + pos) == ZIP_END_SIGNATURE)
+    {
+      end = data + pos;
+      break;
+    }
+  }
+
+  if (end == nullptr)
+  {
+    esyslog("Zip: Missing central directory");
+    return false;
+  }
+
+  const unsigned int entryCount = Read16(end + 10);
+  const size_t directorySize = Read32(end + 12);
+  const size_t directoryOffset = Read32(end + 16);
+
+  if (directoryOffset > size || directorySize > size - directoryOffset)
+  {
+    esyslog("Zip: Invalid central directory (ZIP64 archives are not supported)");
+    return false;
+  }
+
+  // Pick the largest file
+  const uint8_t* entry = nullptr;
+  const uint8_t* pos = data + directoryOffset;
+  const uint8_t* const directoryEnd = pos + directorySize;
+  unsigned int fileCount = 0;
+
+  for (unsigned int i = 0; i < entryCount; i++)
+  {
+    if (directoryEnd - pos < ZIP_CENTRAL_HEADER_SIZE || Read32(pos) != ZIP_CENTRAL_HEADER_SIGNATURE)
+    {
+      esyslog("Zip: Corrupt central directory");
+      return false;
+    }
+
+    const size_t nameLength = Read16(pos + 28);
+    const size_t entrySize = ZIP_CENTRAL_HEADER_SIZE + nameLength + Read16(pos + 30) + Read16(pos + 32);
+    if (static_cast<size_t>(directoryEnd - pos) < entrySize)
+    {
+      esyslog("Zip: Corrupt central directory");
+      return false;
+    }
+
+    const bool bDirectory = nameLength > 0 && pos[ZIP_CENTRAL_HEADER_SIZE + nameLength - 1] == '/';
+    if (!bDirectory)
+    {
+      fileCount++;
+      if (entry == nullptr || Read32(pos + 24) > Read32(entry + 24))
+        entry = pos;
+    }
+
+    pos += entrySize;
+  }
+
+  if (entry == nullptr)
+  {
+    esyslog("Zip: Archive is empty");
+    return false;
+  }
+
+  const uint16_t flags = Read16(entry + 8);
+  const uint16_t method = Read16(entry + 10);
+  const uint32_t crc = Read32(entry + 16);
+  const size_t compressedSize = Read32(entry + 20);
+  const size_t uncompressedSize = Read32(entry + 24);
+  const size_t localOffset = Read32(entry + 42);
+  const std::string name(reinterpret_cast<const char*>(entry + ZIP_CENTRAL_HEADER_SIZE), Read16(entry + 28));
+
+  if (fileCount > 1)
+    dsyslog("Zip: Archive contains %u files, extracting the largest: %s", fileCount, name.c_str());
+
+  if (flags & ZIP_FLAG_ENCRYPTED)
+  {
+    esyslog("Zip: %s is encrypted", name.c_str());
+    return false;
+  }
+
+  if (uncompressedSize > maxSize)
+  {
+    dsyslog("Zip: %s is larger than the memory limit", name.c_str());
+    return false;
+  }
+
+  // The local header repeats the name and has its own extra field
+  if (localOffset > size || size - localOffset < ZIP_LOCAL_HEADER_SIZE || Read32(data + localOffset) != ZIP_LOCAL_HEADER_SIGNATURE)
+  {
+    esyslog("Zip: Corrupt local header for %s", name.c_str());
+    return false;
+  }
+
+  const size_t dataOffset = localOffset + ZIP_LOCAL_HEADER_SIZE + Read16(data + localOffset + 26) + Read16(data + localOffset + 28);
+  if (dataOffset > size || compressedSize > size - dataOffset)
+  {
+    esyslog("Zip: Truncated archive");
+    return false;
+  }
+
+  const uint8_t* const compressed = data + dataOffset;
+
+  switch (method)
+  {
+  case ZIP_METHOD_STORE:
+  {
+    if (compressedSize != uncompressedSize)
+    {
+      esyslog("Zip: Corrupt stored file %s", name.c_str());
+      return false;
+    }
+    content.assign(compressed, compressed + compressedSize);
+    break;
+  }
+  case ZIP_METHOD_DEFLATE:
+  {
+    size_t consumed;
+    if (!Inflate(compressed, compressedSize, -MAX_WBITS, uncompressedSize, maxSize, content, consumed) || content.size() != uncompressedSize)
+    {
+      esyslog("Zip: Failed to inflate %s", name.c_str());
+      return false;
+    }
+    break;
+  }
+  default:
+    esyslog("Zip: Unsupported compression method %u for %s", method, name.c_str());
+    return false;
+  }
+
+  if (crc32(0, content.data(), static_cast<uInt>(content.size())) != crc)
+  {
+    esyslog("Zip: Checksum mismatch for %s", name.c_str());
+    return false;
+  }
+
+  return true;
+}
+
+bool ArchiveUtils::ExtractGzip(const uint8_t* data, size_t size, size_t maxSize, std::vector<uint8_t>& content)
+{
+  // The trailer holds the uncompressed size modulo 2^32, which is a good hint
+  const size_t sizeHint = std::min<size_t>(Read32(data + size - 4), maxSize);
+
+  // A gzip file may consist of several members, which are concatenated
+  size_t pos = 0;
+  while (pos < size)
+  {
+    size_t consumed = 0;
+    if (!Inflate(data + pos, size - pos, MAX_WBITS + 16, sizeHint, maxSize, content, consumed))
+    {
+      esyslog("Gzip: Failed to inflate archive");
+      return false;
+    }
+
+    pos += consumed;
+
+    // Trailing garbage or padding isn't another member
+    if (size - pos < 18 || data[pos] != 0x1f || data[pos + 1] != 0x8b)
+      break;
+  }
+
+  // zlib verifies the CRC-32 of each member
+  return true;
+}
@@ -0,0 +1,65 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace LIBRETRO
+{
+  enum ARCHIVE_FORMAT
+  {
+    ARCHIVE_FORMAT_NONE,
+    ARCHIVE_FORMAT_ZIP,
+    ARCHIVE_FORMAT_GZIP,
+  };
+
+  /*!
+   * \brief Extraction of single-file archives in memory
+   *
+   * Zip archives may use the store or deflate methods. If a zip archive holds
+   * more than one file, the largest is extracted.
+   */
+  class ArchiveUtils
+  {
+  public:
+    /*!
+     * \brief Identify an archive by its magic bytes
+     */
+    static ARCHIVE_FORMAT GetFormat(const uint8_t* data, size_t size);
+
+    /*!
+     * \brief Decompress an archive
+     *
+     * \param data     The archive
+     * \param size     The size of the archive
+     * \param maxSize  Fail if the content is larger than this
+     * \param content  The decompressed content (overwritten)
+     *
+     * \return True if the content was extracted and its checksum matches
+     */
+    static bool Extract(const uint8_t* data, size_t size, size_t maxSize, std::vector<uint8_t>& content);
+
+  private:
+    static bool ExtractZip(const uint8_t* data, size_t size, size_t maxSize, std::vector<uint8_t>& content);
+    static bool ExtractGzip(const uint8_t* data, size_t size, size_t maxSize, std::vector<uint8_t>& content);
+  };
+}
@@ -0,0 +1,454 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "ContentCache.h"
+#include "log/Log.h"
+
+#ifdef _WIN32
+  #include <direct.h>
+#else
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <errno.h>
+#include <fstream>
+#include <sstream>
+#include <stdio.h>
+
+using namespace LIBRETRO;
+using namespace P8PLATFORM;
+
+#define CACHE_INDEX_FILE_NAME  "index.txt"
+#define CACHE_FILE_EXTENSION   ".bin"
+
+CContentCache::CContentCache(void) :
+  m_maxBytes(0),
+  m_totalBytes(0),
+  m_useCounter(0),
+  m_reservedBytes(0),
+  m_tempCounter(0),
+  m_bIndexDirty(false)
+{
+}
+
+CContentCache& CContentCache::Get(void)
+{
+  static CContentCache _instance;
+  return _instance;
+}
+
+CContentCache& CContentCache::GetStaging(void)
+{
+  static CContentCache _instance;
+  return _instance;
+}
+
+namespace
+{
+  bool MakeEntryDirectory(const std::string& path)
+  {
+#ifdef _WIN32
+    return _mkdir(path.c_str()) == 0 || errno == EEXIST;
+#else
+    return mkdir(path.c_str(), 0755) == 0 || errno == EEXIST;
+#endif
+  }
+
+  void RemoveEntryDirectory(const std::string& path)
+  {
+#ifdef _WIN32
+    _rmdir(path.c_str());
+#else
+    rmdir(path.c_str());
+#endif
+  }
+
+  bool WriteContentFile(const std::string& path, uint64_t size, const CContentCache::WriteCallback& write)
+  {
+    std::ofstream file(path.c_str(), std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+      esyslog("Content cache: Failed to create %s", path.c_str());
+      return false;
+    }
+
+    bool bWritten = write(file) && static_cast<uint64_t>(file.tellp()) == size;
+    file.close();
+    bWritten &= !file.fail();
+    if (!bWritten)
+      esyslog("Content cache: Failed to write %s", path.c_str());
+
+    return bWritten;
+  }
+}
+
+void CContentCache::Initialize(const std::string& directory, uint64_t maxBytes)
+{
+  CLockObject lock(m_mutex);
+
+  m_maxBytes = maxBytes;
+
+  if (directory != m_directory)
+  {
+    if (m_bIndexDirty)
+      SaveIndex();
+
+    m_directory = directory;
+    LoadIndex();
+  }
+
+  if (IsEnabled() && m_totalBytes > m_maxBytes)
+  {
+    Evict(0);
+    SaveIndex();
+  }
+}
+
+void CContentCache::Flush(void)
+{
+  CLockObject lock(m_mutex);
+
+  if (m_bIndexDirty)
+    SaveIndex();
+}
+
+std::string CContentCache::GetKey(const std::string& path, int64_t modifiedTime, int64_t size)
+{
+  // 64-bit FNV-1a
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  auto mix = [&hash](const void* data, size_t length)
+    {
+      const uint8_t* bytes = static_cast<const uint8_t*>(data);
+      for (size_t i = 0; i < length; i++)
+      {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ULL;
+      }
+    };
+
+  mix(path.c_str(), path.size() + 1);
+  mix(&modifiedTime, sizeof(modifiedTime));
+  mix(&size, sizeof(size));
+
+  char key[17];
+  snprintf(key, sizeof(key), "%016llx", static_cast<unsigned long long>(hash));
+
+  return key;
+}
+
+std::string CContentCache::Lookup(const std::string& key)
+{
+  CLockObject lock(m_mutex);
+
+  if (!IsEnabled())
+    return "";
+
+  auto it = m_entries.find(key);
+  if (it == m_entries.end())
+    return "";
+
+  // Only the use order changed, which can wait until the next write
+  it->second.lastUsed = ++m_useCounter;
+  it->second.pins++;
+  m_bIndexDirty = true;
+
+  return GetPath(key, it->second.name);
+}
+
+void CContentCache::Insert(const std::string& key, const std::vector<uint8_t>& content)
+{
+  const std::string path = Insert(key, "", content.size(), [&content](std::ostream& stream)
+    {
+      stream.write(reinterpret_cast<const char*>(content.data()), content.size());
+      return stream.good();
+    });
+
+  // The content is already in memory, the file isn't used
+  if (!path.empty())
+    Release(key);
+}
+
+std::string CContentCache::Insert(const std::string& key, const std::string& name, uint64_t size, const WriteCallback& write)
+{
+  std::string tempPath;
+
+  {
+    CLockObject lock(m_mutex);
+
+    if (!IsEnabled() || size > m_maxBytes)
+      return "";
+
+    // Stored by another insert since the caller's lookup
+    auto it = m_entries.find(key);
+    if (it != m_entries.end())
+    {
+      it->second.lastUsed = ++m_useCounter;
+      it->second.pins++;
+      m_bIndexDirty = true;
+      return GetPath(key, it->second.name);
+    }
+
+    // Make room now, and keep it reserved while the content is written
+    if (!Evict(size))
+    {
+      esyslog("Content cache: No room for %s (%llu KB), the cache is in use", key.c_str(),
+              static_cast<unsigned long long>(size / 1024));
+      return "";
+    }
+    m_reservedBytes += size;
+
+    // Unique, so that concurrent inserts of the same key don't collide
+    std::ostringstream tempName;
+    tempName << m_directory << "/" << key << "." << ++m_tempCounter << ".tmp";
+    tempPath = tempName.str();
+  }
+
+  // Write to a temporary file so that a partial entry is never visible. The
+  // cache isn't locked, so other entries can be written at the same time.
+  bool bWritten = WriteContentFile(tempPath, size, write);
+
+  CLockObject lock(m_mutex);
+
+  m_reservedBytes -= size;
+
+  // Another insert of the same key may have finished first. Its file may
+  // already be in use, so keep it.
+  auto it = m_entries.find(key);
+  if (it != m_entries.end())
+  {
+    remove(tempPath.c_str());
+    it->second.lastUsed = ++m_useCounter;
+    it->second.pins++;
+    m_bIndexDirty = true;
+    return GetPath(key, it->second.name);
+  }
+
+  const std::string path = GetPath(key, name);
+
+  if (bWritten && !name.empty() && !MakeEntryDirectory(m_directory + "/" + key))
+  {
+    esyslog("Content cache: Failed to create directory for %s", key.c_str());
+    bWritten = false;
+  }
+
+  if (bWritten)
+  {
+    remove(path.c_str());
+    bWritten = (rename(tempPath.c_str(), path.c_str()) == 0);
+    if (!bWritten)
+      esyslog("Content cache: Failed to rename %s", tempPath.c_str());
+  }
+
+  if (!bWritten)
+  {
+    remove(tempPath.c_str());
+    if (!name.empty())
+      RemoveEntryDirectory(m_directory + "/" + key);
+    return "";
+  }
+
+  Entry entry = { size, ++m_useCounter, name, 1 };
+  m_entries[key] = entry;
+  m_totalBytes += size;
+
+  SaveIndex();
+
+  dsyslog("Content cache: Stored %s (%llu KB, %llu KB used)", key.c_str(),
+          static_cast<unsigned long long>(size / 1024),
+          static_cast<unsigned long long>(m_totalBytes / 1024));
+
+  return path;
+}
+
+std::string CContentCache::WriteTemporary(const std::string& name, uint64_t size, const WriteCallback& write)
+{
+  std::string path;
+
+  {
+    CLockObject lock(m_mutex);
+
+    if (m_directory.empty())
+      return "";
+
+    std::ostringstream tempName;
+    tempName << m_directory << "/temp." << ++m_tempCounter << "." << name;
+    path = tempName.str();
+  }
+
+  if (!WriteContentFile(path, size, write))
+  {
+    remove(path.c_str());
+    return "";
+  }
+
+  dsyslog("Content cache: Stored temporary file %s (%llu KB)", path.c_str(),
+          static_cast<unsigned long long>(size / 1024));
+
+  return path;
+}
+
+void CContentCache::Release(const std::string& key)
+{
+  CLockObject lock(m_mutex);
+
+  auto it = m_entries.find(key);
+  if (it != m_entries.end() && it->second.pins > 0)
+    it->second.pins--;
+}
+
+void CContentCache::Remove(const std::string& key)
+{
+  CLockObject lock(m_mutex);
+
+  auto it = m_entries.find(key);
+  if (it != m_entries.end() && it->second.pins == 0 && RemoveEntry(it))
+    SaveIndex();
+}
+
+std::string CContentCache::GetPath(const std::string& key, const std::string& name) const
+{
+  // Named entries get a directory of their own so that names can't collide
+  if (!name.empty())
+    return m_directory + "/" + key + "/" + name;
+
+  return m_directory + "/" + key + CACHE_FILE_EXTENSION;
+}
+
+void CContentCache::LoadIndex(void)
+{
+  m_bIndexDirty = false;
+  m_entries.clear();
+  m_totalBytes = 0;
+  m_useCounter = 0;
+
+  std::ifstream file((m_directory + "/" CACHE_INDEX_FILE_NAME).c_str());
+
+  // Each line is "<key> <size> <last used>", followed by " <name>" for named
+  // entries. Names may contain spaces, so they take the rest of the line.
+  std::string line;
+  while (std::getline(file, line))
+  {
+    std::istringstream stream(line);
+
+    std::string key;
+    Entry entry = { };
+    if (!(stream >> key >> entry.size >> entry.lastUsed))
+      continue;
+
+    if (stream.get() == ' ')
+      std::getline(stream, entry.name);
+
+    // Drop entries whose file is missing or incomplete
+    const std::string path = GetPath(key, entry.name);
+    std::ifstream cached(path.c_str(), std::ios::binary | std::ios::ate);
+    if (!cached.is_open() || static_cast<uint64_t>(cached.tellg()) != entry.size)
+    {
+      remove(path.c_str());
+      if (!entry.name.empty())
+        RemoveEntryDirectory(m_directory + "/" + key);
+      continue;
+    }
+
+    m_entries[key] = entry;
+    m_totalBytes += entry.size;
+    if (entry.lastUsed > m_useCounter)
+      m_useCounter = entry.lastUsed;
+  }
+}
+
+void CContentCache::SaveIndex(void)
+{
+  m_bIndexDirty = false;
+
+  const std::string path = m_directory + "/" CACHE_INDEX_FILE_NAME;
+
+  std::ofstream file(path.c_str(), std::ios::trunc);
+  if (!file.is_open())
+  {
+    esyslog("Content cache: Failed to write %s", path.c_str());
+    return;
+  }
+
+  for (const auto& entry : m_entries)
+  {
+    file << entry.first << " " << entry.second.size << " " << entry.second.lastUsed;
+    if (!entry.second.name.empty())
+      file << " " << entry.second.name;
+    file << std::endl;
+  }
+}
+
+bool CContentCache::Evict(uint64_t requiredBytes)
+{
+  auto hasRoom = [this, requiredBytes]()
+    {
+      return m_totalBytes + m_reservedBytes + requiredBytes <= m_maxBytes;
+    };
+
+  if (hasRoom())
+    return true;
+
+  // Oldest first, skipping the entries in use
+  std::vector<std::map<std::string, Entry>::iterator> candidates;
+  for (auto it = m_entries.begin(); it != m_entries.end(); ++it)
+  {
+    if (it->second.pins == 0)
+      candidates.push_back(it);
+  }
+
+  std::sort(candidates.begin(), candidates.end(),
+    [](const std::map<std::string, Entry>::iterator& lhs, const std::map<std::string, Entry>::iterator& rhs)
+    {
+      return lhs->second.lastUsed < rhs->second.lastUsed;
+    });
+
+  for (auto it : candidates)
+  {
+    if (hasRoom())
+      break;
+
+    dsyslog("Content cache: Evicting %s", it->first.c_str());
+    RemoveEntry(it);
+  }
+
+  return hasRoom();
+}
+
+bool CContentCache::RemoveEntry(std::map<std::string, Entry>::iterator it)
+{
+  // A file that is open can't be deleted on Windows. Its entry is kept so
+  // that the space stays accounted for.
+  const std::string path = GetPath(it->first, it->second.name);
+  if (remove(path.c_str()) != 0 && errno != ENOENT)
+  {
+    esyslog("Content cache: Failed to delete %s", path.c_str());
+    return false;
+  }
+
+  if (!it->second.name.empty())
+    RemoveEntryDirectory(m_directory + "/" + it->first);
+  m_totalBytes -= it->second.size;
+  m_entries.erase(it);
+  m_bIndexDirty = true;
+
+  return true;
+}
@@ -0,0 +1,176 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include "p8-platform/threads/mutex.h"
+
+#include <functional>
+#include <map>
+#include <ostream>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace LIBRETRO
+{
+  /*!
+   * \brief On-disk cache of content
+   *
+   * Entries are keyed by the source path, modification time and size, so
+   * content that changes is cached again. When the cache exceeds its size
+   * budget, the least recently used entries are deleted. The entries and their
+   * use order are kept in an index file next to them. The index is written
+   * when entries are added or removed, and on Flush() if only the use order
+   * changed.
+   *
+   * Entries returned by Lookup() and Insert() are pinned until Release() is
+   * called, so that a file in use is never evicted or replaced. The budget
+   * may be exceeded while pinned entries leave no room for a new one, in
+   * which case the insert fails.
+   *
+   * Two caches exist: one for extracted archives, and one for content staged
+   * from the VFS to local storage for cores that can only load by path.
+   */
+  class CContentCache
+  {
+  private:
+    CContentCache(void);
+
+  public:
+    /*!
+     * \brief The cache of extracted archives
+     */
+    static CContentCache& Get(void);
+
+    /*!
+     * \brief The cache of VFS content copied to local storage
+     */
+    static CContentCache& GetStaging(void);
+
+    /*!
+     * \brief Writes the content of a new entry, returns false on error
+     */
+    typedef std::function<bool(std::ostream& stream)> WriteCallback;
+
+    /*!
+     * \brief Set the cache directory and size budget
+     *
+     * \param directory  An existing local directory
+     * \param maxBytes   The size budget, or 0 to disable the cache
+     */
+    void Initialize(const std::string& directory, uint64_t maxBytes);
+
+    bool IsEnabled(void) const { return m_maxBytes > 0; }
+
+    /*!
+     * \brief Write the index if entries have been used since it was written
+     */
+    void Flush(void);
+
+    /*!
+     * \brief Build the key of a source file
+     */
+    static std::string GetKey(const std::string& path, int64_t modifiedTime, int64_t size);
+
+    /*!
+     * \brief Look up an entry, mark it as recently used and pin it
+     *
+     * \return The path of the cached content, or empty if not cached
+     */
+    std::string Lookup(const std::string& key);
+
+    /*!
+     * \brief Store content, evicting old entries to stay within budget
+     *
+     * The entry isn't pinned.
+     */
+    void Insert(const std::string& key, const std::vector<uint8_t>& content);
+
+    /*!
+     * \brief Store content produced by a callback
+     *
+     * Room for the content is made before it's written, so the callback can
+     * stream content that doesn't fit in memory. The cache isn't locked while
+     * it runs, so several entries can be written at once. If another insert
+     * of the same key finishes first, its entry is kept.
+     *
+     * \param key    The key of the entry
+     * \param name   The file name of the entry, e.g. to keep the extension
+     *               seen by the core, or empty for an anonymous entry
+     * \param size   The size of the content
+     * \param write  Writes exactly size bytes to the stream
+     *
+     * \return The path of the cached content, pinned, or empty on failure
+     */
+    std::string Insert(const std::string& key, const std::string& name, uint64_t size, const WriteCallback& write);
+
+    /*!
+     * \brief Write content to a file in the cache directory that isn't an
+     *        entry, for content the cache can't hold
+     *
+     * The file doesn't count against the budget and is never evicted. The
+     * caller deletes it when done.
+     *
+     * \param name   The file name, e.g. to keep the extension seen by the core
+     * \param size   The size of the content
+     * \param write  Writes exactly size bytes to the stream
+     *
+     * \return The path of the file, or empty on failure
+     */
+    std::string WriteTemporary(const std::string& name, uint64_t size, const WriteCallback& write);
+
+    /*!
+     * \brief Unpin an entry returned by Lookup() or Insert()
+     */
+    void Release(const std::string& key);
+
+    /*!
+     * \brief Drop an entry, e.g. if its file couldn't be read
+     *
+     * The entry is kept if it's pinned.
+     */
+    void Remove(const std::string& key);
+
+  private:
+    struct Entry
+    {
+      uint64_t     size;
+      uint64_t     lastUsed; // Use counter, higher is more recent
+      std::string  name;     // File name, or empty for <key>.bin
+      unsigned int pins;     // Number of users of the file, not saved
+    };
+
+    std::string GetPath(const std::string& key, const std::string& name) const;
+    void LoadIndex(void);
+    void SaveIndex(void);
+    bool Evict(uint64_t requiredBytes);
+    bool RemoveEntry(std::map<std::string, Entry>::iterator it);
+
+    std::string                  m_directory;
+    uint64_t                     m_maxBytes;
+    std::map<std::string, Entry> m_entries;
+    uint64_t                     m_totalBytes;
+    uint64_t                     m_useCounter;
+    uint64_t                     m_reservedBytes; // Size of entries being written
+    unsigned int                 m_tempCounter;
+    bool                         m_bIndexDirty;
+    P8PLATFORM::CMutex           m_mutex;
+  };
+}
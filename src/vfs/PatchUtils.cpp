@@ -0,0 +1,587 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "PatchUtils.h"
+#include "log/Log.h"
+#include "utils/CRC32.h"
+
+#include <algorithm>
+#include <limits>
+#include <string.h>
+
+using namespace LIBRETRO;
+
+#define IPS_MAGIC          "PATCH"
+#define IPS_MAGIC_SIZE     5
+#define IPS_EOF            0x454f46 // "EOF"
+#define UPS_MAGIC          "UPS1"
+#define BPS_MAGIC          "BPS1"
+#define BEAT_MAGIC_SIZE    4
+#define BEAT_FOOTER_SIZE   12 // Source CRC, target CRC, patch CRC
+
+/*!
+ * \brief Content being patched, either a vector or a fixed buffer
+ *
+ * A fixed buffer can shrink and grow back up to its original size. Bytes
+ * past the previous end read as zero, as they do in a resized vector.
+ */
+class PatchUtils::CContent
+{
+public:
+  explicit CContent(std::vector<uint8_t>& buffer) :
+    m_buffer(&buffer),
+    m_data(buffer.data()),
+    m_size(buffer.size()),
+    m_capacity(std::numeric_limits<size_t>::max())
+  {
+  }
+
+  CContent(uint8_t* data, size_t size) :
+    m_buffer(nullptr),
+    m_data(data),
+    m_size(size),
+    m_capacity(size)
+  {
+  }
+
+  uint8_t* Data(void) const { return m_data; }
+  size_t Size(void) const { return m_size; }
+  size_t Capacity(void) const { return m_capacity; }
+
+  uint8_t& operator[](size_t offset) { return m_data[offset]; }
+
+  /*!
+   * \brief Change the size, which must not exceed the capacity
+   */
+  void Resize(size_t size)
+  {
+    if (m_buffer != nullptr)
+    {
+      m_buffer->resize(size);
+      m_data = m_buffer->data();
+    }
+    else if (size > m_size)
+    {
+      memset(m_data + m_size, 0, size - m_size);
+    }
+    m_size = size;
+  }
+
+  /*!
+   * \brief Replace the content, which must not exceed the capacity
+   */
+  void Assign(std::vector<uint8_t>& content)
+  {
+    if (m_buffer != nullptr)
+    {
+      m_buffer->swap(content);
+      m_data = m_buffer->data();
+    }
+    else
+    {
+      memcpy(m_data, content.data(), content.size());
+    }
+    m_size = content.size();
+  }
+
+private:
+  std::vector<uint8_t>* const m_buffer; // Null for a fixed buffer
+  uint8_t*                    m_data;
+  size_t                      m_size;
+  const size_t                m_capacity;
+};
+
+namespace
+{
+  inline uint32_t LoadLE32(const uint8_t* data)
+  {
+    return static_cast<uint32_t>(data[0]) |
+           (static_cast<uint32_t>(data[1]) << 8) |
+           (static_cast<uint32_t>(data[2]) << 16) |
+           (static_cast<uint32_t>(data[3]) << 24);
+  }
+
+  /*!
+   * \brief Variable-length integer shared by UPS and BPS
+   *
+   * Seven bits per byte, least significant first, with the high bit marking
+   * the last byte. Each continuation also adds one, so every value has a
+   * single encoding.
+   */
+  inline bool ReadNumber(const uint8_t*& data, const uint8_t* end, uint64_t& value)
+  {
+    value = 0;
+    uint64_t shift = 1;
+    while (data < end)
+    {
+      const uint8_t byte = *data++;
+      value += (byte & 0x7f) * shift;
+      if (byte & 0x80)
+        return true;
+      if (shift > (1ULL << 48))
+        return false; // Overflow
+      shift <<= 7;
+      value += shift;
+    }
+    return false;
+  }
+
+  /*!
+   * \brief Check the CRCs in the footer of a UPS or BPS patch
+   */
+  bool CheckFooter(const char* format, const uint8_t* patch, size_t size,
+                   const uint8_t* source, size_t sourceSize, uint32_t& targetCRC)
+  {
+    const uint8_t* footer = patch + size - BEAT_FOOTER_SIZE;
+
+    const uint32_t patchCRC = LoadLE32(footer + 8);
+    if (CRC32::Update(0, patch, size - 4) != patchCRC)
+    {
+      esyslog("%s patch is corrupt (CRC mismatch)", format);
+      return false;
+    }
+
+    const uint32_t sourceCRC = LoadLE32(footer);
+    if (CRC32::Update(0, source, sourceSize) != sourceCRC)
+    {
+      esyslog("%s patch was made for different content (source CRC %08x)", format, sourceCRC);
+      return false;
+    }
+
+    targetCRC = LoadLE32(footer + 4);
+
+    return true;
+  }
+
+  /*!
+   * \brief Validate the records of an IPS patch
+   *
+   * Records are applied before the truncation, so they may reach past the
+   * final size.
+   *
+   * \param extent         The end of the last byte written, at least the size
+   *                       of the content
+   * \param bTruncate      True if the patch truncates the content
+   * \param truncatedSize  The size after truncation
+   *
+   * \return False if the patch is malformed
+   */
+  bool ScanIPS(const uint8_t* patch, size_t size, size_t contentSize,
+               size_t& extent, bool& bTruncate, size_t& truncatedSize)
+  {
+    const uint8_t* data = patch + IPS_MAGIC_SIZE;
+    const uint8_t* const end = patch + size;
+
+    extent = contentSize;
+    while (true)
+    {
+      if (end - data < 3)
+        return false;
+
+      const size_t offset = (data[0] << 16) | (data[1] << 8) | data[2];
+      data += 3;
+
+      if (offset == IPS_EOF)
+        break;
+
+      if (end - data < 2)
+        return false;
+
+      size_t length = (data[0] << 8) | data[1];
+      data += 2;
+
+      if (length == 0)
+      {
+        // Run-length record
+        if (end - data < 3)
+          return false;
+        length = (data[0] << 8) | data[1];
+        data += 3;
+      }
+      else
+      {
+        if (static_cast<size_t>(end - data) < length)
+          return false;
+        data += length;
+      }
+
+      if (offset + length > extent)
+        extent = offset + length;
+    }
+
+    // Optional truncation
+    bTruncate = false;
+    truncatedSize = 0;
+    if (end - data == 3)
+    {
+      truncatedSize = (data[0] << 16) | (data[1] << 8) | data[2];
+      bTruncate = true;
+    }
+
+    return true;
+  }
+
+  /*!
+   * \brief Read the source and target sizes of a UPS or BPS patch
+   */
+  bool ReadBeatSizes(const uint8_t* patch, size_t size, uint64_t& sourceSize, uint64_t& targetSize)
+  {
+    const uint8_t* data = patch + BEAT_MAGIC_SIZE;
+    const uint8_t* const end = patch + size - BEAT_FOOTER_SIZE;
+
+    return ReadNumber(data, end, sourceSize) && ReadNumber(data, end, targetSize);
+  }
+
+  /*!
+   * \brief XOR the hunks of a UPS patch into the content
+   *
+   * \return False if the hunks are malformed. The hunks before the error have
+   *         been applied.
+   */
+  template<typename CONTENT>
+  bool XorHunks(const uint8_t* data, const uint8_t* end, CONTENT& content)
+  {
+    size_t offset = 0;
+    while (data < end)
+    {
+      uint64_t skip;
+      if (!ReadNumber(data, end, skip) || offset > content.Size() || skip > content.Size() - offset)
+        return false;
+      offset += static_cast<size_t>(skip);
+
+      // XOR until and including a zero byte. The terminator may fall past
+      // the end of the content.
+      while (data < end)
+      {
+        const uint8_t xorByte = *data++;
+        if (offset < content.Size())
+          content[offset] ^= xorByte;
+        offset++;
+        if (xorByte == 0)
+          break;
+      }
+    }
+    return true;
+  }
+}
+
+PATCH_FORMAT PatchUtils::GetFormat(const uint8_t* patch, size_t size)
+{
+  if (size >= IPS_MAGIC_SIZE && memcmp(patch, IPS_MAGIC, IPS_MAGIC_SIZE) == 0)
+    return PATCH_FORMAT_IPS;
+
+  if (size >= BEAT_MAGIC_SIZE + BEAT_FOOTER_SIZE)
+  {
+    if (memcmp(patch, UPS_MAGIC, BEAT_MAGIC_SIZE) == 0)
+      return PATCH_FORMAT_UPS;
+    if (memcmp(patch, BPS_MAGIC, BEAT_MAGIC_SIZE) == 0)
+      return PATCH_FORMAT_BPS;
+  }
+
+  return PATCH_FORMAT_NONE;
+}
+
+bool PatchUtils::Apply(const uint8_t* patch, size_t size, size_t maxSize, std::vector<uint8_t>& content)
+{
+  CContent buffer(content);
+  return Apply(patch, size, maxSize, buffer);
+}
+
+bool PatchUtils::Apply(const uint8_t* patch, size_t size, uint8_t* content, size_t& contentSize)
+{
+  CContent buffer(content, contentSize);
+  if (!Apply(patch, size, contentSize, buffer))
+    return false;
+
+  contentSize = buffer.Size();
+  return true;
+}
+
+size_t PatchUtils::GetRequiredSize(const uint8_t* patch, size_t size, size_t contentSize)
+{
+  switch (GetFormat(patch, size))
+  {
+  case PATCH_FORMAT_IPS:
+  {
+    size_t extent;
+    bool bTruncate;
+    size_t truncatedSize;
+    if (!ScanIPS(patch, size, contentSize, extent, bTruncate, truncatedSize))
+      break;
+    return std::max(extent, truncatedSize);
+  }
+  case PATCH_FORMAT_UPS:
+  case PATCH_FORMAT_BPS:
+  {
+    uint64_t sourceSize;
+    uint64_t targetSize;
+    if (!ReadBeatSizes(patch, size, sourceSize, targetSize) || targetSize > std::numeric_limits<size_t>::max())
+      break;
+    return std::max(contentSize, static_cast<size_t>(targetSize));
+  }
+  default:
+    break;
+  }
+
+  return 0;
+}
+
+bool PatchUtils::Apply(const uint8_t* patch, size_t size, size_t maxSize, CContent& content)
+{
+  maxSize = std::min(maxSize, content.Capacity());
+
+  switch (GetFormat(patch, size))
+  {
+  case PATCH_FORMAT_IPS:
+    return ApplyIPS(patch, size, maxSize, content);
+  case PATCH_FORMAT_UPS:
+    return ApplyUPS(patch, size, maxSize, content);
+  case PATCH_FORMAT_BPS:
+    return ApplyBPS(patch, size, maxSize, content);
+  default:
+    break;
+  }
+
+  return false;
+}
+
+bool PatchUtils::ApplyIPS(const uint8_t* patch, size_t size, size_t maxSize, CContent& content)
+{
+  // Validate the records before touching the content so that a truncated
+  // patch leaves it intact
+  size_t extent;
+  bool bTruncate;
+  size_t truncatedSize;
+  if (!ScanIPS(patch, size, content.Size(), extent, bTruncate, truncatedSize))
+    return false;
+
+  if (std::max(extent, truncatedSize) > maxSize)
+  {
+    esyslog("IPS patch would grow the content past the memory limit");
+    return false;
+  }
+
+  if (extent > content.Size())
+    content.Resize(extent);
+
+  const uint8_t* data = patch + IPS_MAGIC_SIZE;
+  while (true)
+  {
+    const size_t offset = (data[0] << 16) | (data[1] << 8) | data[2];
+    data += 3;
+
+    if (offset == IPS_EOF)
+      break;
+
+    size_t length = (data[0] << 8) | data[1];
+    data += 2;
+
+    if (length == 0)
+    {
+      length = (data[0] << 8) | data[1];
+      memset(content.Data() + offset, data[2], length);
+      data += 3;
+    }
+    else
+    {
+      memcpy(content.Data() + offset, data, length);
+      data += length;
+    }
+  }
+
+  if (bTruncate)
+    content.Resize(truncatedSize);
+
+  return true;
+}
+
+bool PatchUtils::ApplyUPS(const uint8_t* patch, size_t size, size_t maxSize, CContent& content)
+{
+  const uint8_t* data = patch + BEAT_MAGIC_SIZE;
+  const uint8_t* const end = patch + size - BEAT_FOOTER_SIZE;
+
+  uint64_t sourceSize;
+  uint64_t targetSize;
+  if (!ReadNumber(data, end, sourceSize) || !ReadNumber(data, end, targetSize))
+    return false;
+
+  if (sourceSize != content.Size())
+  {
+    esyslog("UPS patch was made for different content (source size %llu)", static_cast<unsigned long long>(sourceSize));
+    return false;
+  }
+
+  if (targetSize > maxSize)
+  {
+    esyslog("UPS patch would grow the content past the memory limit");
+    return false;
+  }
+
+  uint32_t targetCRC;
+  if (!CheckFooter("UPS", patch, size, content.Data(), content.Size(), targetCRC))
+    return false;
+
+  // Hunks are XOR'd into the content, and bytes past the end of the source
+  // read as zero. XOR is its own inverse, so a failed patch is undone by
+  // applying the same hunks again.
+  content.Resize(static_cast<size_t>(std::max(sourceSize, targetSize)));
+
+  bool bSuccess = XorHunks(data, end, content);
+
+  if (bSuccess && CRC32::Update(0, content.Data(), static_cast<size_t>(targetSize)) != targetCRC)
+  {
+    esyslog("UPS patch produced the wrong content (CRC mismatch)");
+    bSuccess = false;
+  }
+
+  if (!bSuccess)
+  {
+    XorHunks(data, end, content);
+    targetSize = sourceSize;
+  }
+
+  content.Resize(static_cast<size_t>(targetSize));
+
+  return bSuccess;
+}
+
+bool PatchUtils::ApplyBPS(const uint8_t* patch, size_t size, size_t maxSize, CContent& content)
+{
+  enum BPS_ACTION
+  {
+    BPS_SOURCE_READ,
+    BPS_TARGET_READ,
+    BPS_SOURCE_COPY,
+    BPS_TARGET_COPY,
+  };
+
+  const uint8_t* data = patch + BEAT_MAGIC_SIZE;
+  const uint8_t* const end = patch + size - BEAT_FOOTER_SIZE;
+
+  uint64_t sourceSize;
+  uint64_t targetSize;
+  uint64_t metadataSize;
+  if (!ReadNumber(data, end, sourceSize) ||
+      !ReadNumber(data, end, targetSize) ||
+      !ReadNumber(data, end, metadataSize))
+  {
+    return false;
+  }
+
+  if (sourceSize != content.Size())
+  {
+    esyslog("BPS patch was made for different content (source size %llu)", static_cast<unsigned long long>(sourceSize));
+    return false;
+  }
+
+  if (targetSize > maxSize)
+  {
+    esyslog("BPS patch would grow the content past the memory limit");
+    return false;
+  }
+
+  if (metadataSize > static_cast<uint64_t>(end - data))
+    return false;
+  data += metadataSize;
+
+  uint32_t targetCRC;
+  if (!CheckFooter("BPS", patch, size, content.Data(), content.Size(), targetCRC))
+    return false;
+
+  const uint8_t* const source = content.Data();
+  std::vector<uint8_t> target(static_cast<size_t>(targetSize));
+
+  size_t outputOffset = 0;
+  int64_t sourceRelativeOffset = 0;
+  int64_t targetRelativeOffset = 0;
+
+  while (data < end)
+  {
+    uint64_t action;
+    if (!ReadNumber(data, end, action))
+      return false;
+
+    const uint64_t length = (action >> 2) + 1;
+    if (length > target.size() - outputOffset)
+      return false;
+
+    switch (action & 3)
+    {
+    case BPS_SOURCE_READ:
+    {
+      if (outputOffset + length > sourceSize)
+        return false;
+      memcpy(target.data() + outputOffset, source + outputOffset, static_cast<size_t>(length));
+      break;
+    }
+    case BPS_TARGET_READ:
+    {
+      if (length > static_cast<uint64_t>(end - data))
+        return false;
+      memcpy(target.data() + outputOffset, data, static_cast<size_t>(length));
+      data += length;
+      break;
+    }
+    case BPS_SOURCE_COPY:
+    case BPS_TARGET_COPY:
+    {
+      uint64_t encoded;
+      if (!ReadNumber(data, end, encoded))
+        return false;
+
+      const int64_t delta = (encoded & 1) ? -static_cast<int64_t>(encoded >> 1) : static_cast<int64_t>(encoded >> 1);
+
+      if ((action & 3) == BPS_SOURCE_COPY)
+      {
+        sourceRelativeOffset += delta;
+        if (sourceRelativeOffset < 0 || static_cast<uint64_t>(sourceRelativeOffset) + length > sourceSize)
+          return false;
+        memcpy(target.data() + outputOffset, source + sourceRelativeOffset, static_cast<size_t>(length));
+        sourceRelativeOffset += length;
+      }
+      else
+      {
+        targetRelativeOffset += delta;
+        if (targetRelativeOffset < 0 || static_cast<uint64_t>(targetRelativeOffset) >= outputOffset)
+          return false;
+        // The copy may overlap the output to repeat a pattern, so go bytewise
+        for (uint64_t i = 0; i < length; i++)
+          target[outputOffset + i] = target[static_cast<size_t>(targetRelativeOffset++)];
+      }
+      break;
+    }
+    }
+
+    outputOffset += static_cast<size_t>(length);
+  }
+
+  if (outputOffset != target.size())
+    return false;
+
+  if (CRC32::Update(0, target.data(), target.size()) != targetCRC)
+  {
+    esyslog("BPS patch produced the wrong content (CRC mismatch)");
+    return false;
+  }
+
+  content.Assign(target);
+
+  return true;
+}
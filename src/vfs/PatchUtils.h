@@ -0,0 +1,103 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace LIBRETRO
+{
+  enum PATCH_FORMAT
+  {
+    PATCH_FORMAT_NONE,
+    PATCH_FORMAT_IPS,
+    PATCH_FORMAT_UPS,
+    PATCH_FORMAT_BPS,
+  };
+
+  /*!
+   * \brief Soft-patching of content in memory
+   *
+   * IPS and UPS patches are applied in place, growing the content if the
+   * patch writes past its end. BPS patches copy from arbitrary offsets of the
+   * source, so the patched content is built in a second buffer. The CRCs
+   * stored in UPS and BPS patches are checked, and the content is left
+   * untouched if the patch doesn't apply.
+   *
+   * Content that can't be reallocated, such as a private mapping, is patched
+   * in place if it doesn't grow, see GetRequiredSize().
+   */
+  class PatchUtils
+  {
+  public:
+    /*!
+     * \brief Identify a patch by its magic bytes
+     */
+    static PATCH_FORMAT GetFormat(const uint8_t* patch, size_t size);
+
+    /*!
+     * \brief Apply a patch to the content
+     *
+     * \param patch    The patch
+     * \param size     The size of the patch
+     * \param maxSize  Fail if the patched content is larger than this
+     * \param content  The content to patch
+     *
+     * \return True if the patch was applied, false if the patch is malformed
+     *         or was made for different content
+     */
+    static bool Apply(const uint8_t* patch, size_t size, size_t maxSize, std::vector<uint8_t>& content);
+
+    /*!
+     * \brief Apply a patch to content that can't grow
+     *
+     * \param patch        The patch
+     * \param size         The size of the patch
+     * \param content      The content to patch
+     * \param contentSize  The size of the content, set to the size after
+     *                     patching
+     *
+     * \return True if the patch was applied, false if the patch is malformed,
+     *         was made for different content or needs more room
+     */
+    static bool Apply(const uint8_t* patch, size_t size, uint8_t* content, size_t& contentSize);
+
+    /*!
+     * \brief Get the room needed to apply a patch
+     *
+     * \param patch        The patch
+     * \param size         The size of the patch
+     * \param contentSize  The size of the content before patching
+     *
+     * \return The largest size the content reaches while it's patched, or 0
+     *         if the patch is malformed
+     */
+    static size_t GetRequiredSize(const uint8_t* patch, size_t size, size_t contentSize);
+
+  private:
+    class CContent;
+
+    static bool Apply(const uint8_t* patch, size_t size, size_t maxSize, CContent& content);
+    static bool ApplyIPS(const uint8_t* patch, size_t size, size_t maxSize, CContent& content);
+    static bool ApplyUPS(const uint8_t* patch, size_t size, size_t maxSize, CContent& content);
+    static bool ApplyBPS(const uint8_t* patch, size_t size, size_t maxSize, CContent& content);
+  };
+}
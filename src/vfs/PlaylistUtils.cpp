@@ -0,0 +1,121 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "PlaylistUtils.h"
+#include "log/Log.h"
+#include "utils/PathUtils.h"
+
+#include "libXBMC_addon.h"
+
+#include <ctype.h>
+
+using namespace ADDON;
+using namespace LIBRETRO;
+
+#define PLAYLIST_EXTENSION  ".m3u"
+#define MAX_PLAYLIST_SIZE   (64 * 1024)
+
+bool PlaylistUtils::IsPlaylist(const std::string& path)
+{
+  const size_t extensionLength = sizeof(PLAYLIST_EXTENSION) - 1;
+  if (path.size() < extensionLength)
+    return false;
+
+  const std::string extension = path.substr(path.size() - extensionLength);
+  for (size_t i = 0; i < extensionLength; i++)
+  {
+    if (tolower(static_cast<unsigned char>(extension[i])) != PLAYLIST_EXTENSION[i])
+      return false;
+  }
+
+  return true;
+}
+
+bool PlaylistUtils::Load(CHelper_libXBMC_addon* xbmc, const std::string& path, std::vector<std::string>& images)
+{
+  images.clear();
+
+  void* file = xbmc->OpenFile(path.c_str(), 0);
+  if (!file)
+  {
+    esyslog("Failed to open playlist: %s", path.c_str());
+    return false;
+  }
+
+  std::string text;
+  char buffer[4096];
+  ssize_t bytesRead;
+  while ((bytesRead = xbmc->ReadFile(file, buffer, sizeof(buffer))) > 0 && text.size() < MAX_PLAYLIST_SIZE)
+    text.append(buffer, bytesRead);
+
+  xbmc->CloseFile(file);
+
+  Parse(path, text, images);
+
+  if (images.empty())
+  {
+    esyslog("Playlist is empty: %s", path.c_str());
+    return false;
+  }
+
+  dsyslog("Playlist has %u image(s): %s", static_cast<unsigned int>(images.size()), path.c_str());
+
+  return true;
+}
+
+void PlaylistUtils::Parse(const std::string& path, const std::string& text, std::vector<std::string>& images)
+{
+  images.clear();
+
+  // Keep the trailing separator
+  const size_t slash = path.find_last_of("/\\");
+  const std::string directory = (slash != std::string::npos ? path.substr(0, slash + 1) : "");
+
+  size_t pos = 0;
+  while (pos < text.size())
+  {
+    size_t end = text.find_first_of("\r\n", pos);
+    if (end == std::string::npos)
+      end = text.size();
+
+    const bool bFirstLine = (pos == 0);
+
+    std::string line = text.substr(pos, end - pos);
+    pos = end + 1;
+
+    // Trim whitespace, and the byte order mark of UTF-8 playlists
+    if (bFirstLine && line.compare(0, 3, "\xEF\xBB\xBF") == 0)
+      line.erase(0, 3);
+    while (!line.empty() && isspace(static_cast<unsigned char>(line.back())))
+      line.pop_back();
+    size_t start = 0;
+    while (start < line.size() && isspace(static_cast<unsigned char>(line[start])))
+      start++;
+    line.erase(0, start);
+
+    if (line.empty() || line[0] == '#')
+      continue;
+
+    if (PathUtils::IsLocalPath(line) || line.find("://") != std::string::npos)
+      images.push_back(line);
+    else
+      images.push_back(directory + line);
+  }
+}
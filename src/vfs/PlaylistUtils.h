@@ -0,0 +1,59 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace ADDON { class CHelper_libXBMC_addon; }
+
+namespace LIBRETRO
+{
+  /*!
+   * \brief M3U playlists listing the discs of a multi-disc game
+   *
+   * Each line that isn't blank or a # comment is a disc image. Relative
+   * entries are resolved against the playlist's directory.
+   */
+  class PlaylistUtils
+  {
+  public:
+    /*!
+     * \brief Check if a path has the .m3u extension
+     */
+    static bool IsPlaylist(const std::string& path);
+
+    /*!
+     * \brief Read a playlist through the VFS
+     *
+     * \return True if the playlist lists at least one image
+     */
+    static bool Load(ADDON::CHelper_libXBMC_addon* xbmc, const std::string& path, std::vector<std::string>& images);
+
+    /*!
+     * \brief Parse the text of a playlist
+     *
+     * \param path    The playlist's path, used to resolve relative entries
+     * \param text    The content of the playlist
+     * \param images  The listed images (overwritten)
+     */
+    static void Parse(const std::string& path, const std::string& text, std::vector<std::string>& images);
+  };
+}
@@ -0,0 +1,191 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "VFSReader.h"
+#include "log/Log.h"
+
+#include "libXBMC_addon.h"
+
+#include <algorithm>
+
+using namespace ADDON;
+using namespace LIBRETRO;
+using namespace P8PLATFORM;
+
+#define READ_BLOCK_SIZE   (1024 * 1024) // Bytes requested from VFS per read
+#define READ_BLOCK_COUNT  4             // Blocks in flight
+
+CVFSReader::CVFSReader(CHelper_libXBMC_addon* xbmc, void* file) :
+  m_xbmc(xbmc),
+  m_file(file),
+  m_size(0),
+  m_blocks(READ_BLOCK_COUNT)
+{
+}
+
+CVFSReader::~CVFSReader(void)
+{
+  Stop();
+}
+
+bool CVFSReader::ReadAll(std::vector<uint8_t>& buffer, uint64_t size, uint64_t maxSize, const ProgressCallback& progress)
+{
+  buffer.clear();
+
+  if (size > maxSize)
+    return false;
+
+  if (size > 0)
+    buffer.reserve(static_cast<size_t>(size));
+
+  return ReadBlocks(size, [&buffer, size, maxSize, &progress](const uint8_t* data, size_t blockSize)
+    {
+      if (buffer.size() + blockSize > maxSize)
+      {
+        dsyslog("File exceeds memory limit (%u MB)", static_cast<unsigned int>(maxSize / (1024 * 1024)));
+        return false;
+      }
+
+      // Grow geometrically in case the size was unknown or wrong, but never
+      // past the limit
+      const size_t required = buffer.size() + blockSize;
+      if (required > buffer.capacity())
+        buffer.reserve(static_cast<size_t>(std::min<uint64_t>(std::max(required, buffer.capacity() * 2), maxSize)));
+
+      buffer.insert(buffer.end(), data, data + blockSize);
+
+      if (progress)
+        progress(buffer.size(), size);
+
+      return true;
+    });
+}
+
+bool CVFSReader::ReadBlocks(uint64_t size, const BlockCallback& callback)
+{
+  m_size = size;
+  m_blocks.Clear();
+
+  if (!CreateThread(false))
+  {
+    esyslog("Failed to create VFS read thread");
+    return false;
+  }
+
+  bool bSuccess = false;
+
+  while (true)
+  {
+    Block* block = m_blocks.BeginRead();
+    if (block == nullptr)
+    {
+      m_dataEvent.Wait();
+      continue;
+    }
+
+    const bool bEnd = block->bEnd;
+    const bool bError = block->bError;
+
+    const bool bAccepted = callback(block->data.data(), block->size);
+
+    m_blocks.EndRead();
+    m_spaceEvent.Signal();
+
+    if (!bAccepted)
+      break;
+
+    if (bEnd)
+    {
+      bSuccess = !bError;
+      break;
+    }
+  }
+
+  Stop();
+
+  return bSuccess;
+}
+
+void CVFSReader::Stop(void)
+{
+  StopThread(-1);
+  m_spaceEvent.Signal();
+  StopThread();
+}
+
+void* CVFSReader::Process(void)
+{
+  uint64_t totalRead = 0;
+
+  while (!IsStopped())
+  {
+    Block* block = m_blocks.BeginWrite();
+    if (block == nullptr)
+    {
+      m_spaceEvent.Wait();
+      continue;
+    }
+
+    block->data.resize(READ_BLOCK_SIZE);
+    block->size = 0;
+    block->bEnd = false;
+    block->bError = false;
+
+    // Fill the block. Reads may return less than requested before the end of
+    // the file is reached.
+    while (block->size < READ_BLOCK_SIZE && !IsStopped())
+    {
+      size_t request = READ_BLOCK_SIZE - block->size;
+      if (m_size > 0)
+        request = static_cast<size_t>(std::min<uint64_t>(request, m_size - totalRead));
+
+      const ssize_t bytesRead = m_xbmc->ReadFile(m_file, block->data.data() + block->size, request);
+      if (bytesRead < 0)
+      {
+        esyslog("Failed to read file");
+        block->bError = true;
+        break;
+      }
+      else if (bytesRead == 0)
+      {
+        break;
+      }
+
+      block->size += bytesRead;
+      totalRead += bytesRead;
+
+      // Don't wait on another round trip to find the end of the file
+      if (m_size > 0 && totalRead == m_size)
+        break;
+    }
+
+    block->bEnd = block->bError || block->size < READ_BLOCK_SIZE || (m_size > 0 && totalRead == m_size);
+
+    const bool bEnd = block->bEnd;
+
+    m_blocks.EndWrite();
+    m_dataEvent.Signal();
+
+    if (bEnd)
+      break;
+  }
+
+  return nullptr;
+}
@@ -0,0 +1,117 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include "utils/SpscRing.h"
+
+#include "p8-platform/threads/mutex.h"
+#include "p8-platform/threads/threads.h"
+
+#include <functional>
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace ADDON { class CHelper_libXBMC_addon; }
+
+namespace LIBRETRO
+{
+  /*!
+   * \brief Reads a VFS file into memory with read-ahead on a worker thread
+   *
+   * Network protocols pay a round trip for every read. The worker issues
+   * large reads into a small ring of blocks while the calling thread appends
+   * the completed blocks to the output, so the next read is already in
+   * flight while the previous block is being copied.
+   */
+  class CVFSReader : public P8PLATFORM::CThread
+  {
+  public:
+    /*!
+     * \brief Called after each block with the number of bytes read so far and
+     *        the expected size, or 0 if the size is unknown
+     */
+    typedef std::function<void(uint64_t bytesRead, uint64_t totalBytes)> ProgressCallback;
+
+    /*!
+     * \brief Called with each block in file order. Returning false stops the
+     *        read with an error.
+     */
+    typedef std::function<bool(const uint8_t* data, size_t size)> BlockCallback;
+
+    /*!
+     * \param xbmc  The add-on helper used for VFS access
+     * \param file  A file opened with OpenFile(), owned by the caller
+     */
+    CVFSReader(ADDON::CHelper_libXBMC_addon* xbmc, void* file);
+
+    virtual ~CVFSReader(void);
+
+    /*!
+     * \brief Read the remainder of the file
+     *
+     * \param buffer    The buffer that receives the data (overwritten)
+     * \param size      The size of the file, or 0 if unknown. Used to size the
+     *                  buffer up front and to avoid reading past the end.
+     * \param maxSize   Stop with an error if the file grows beyond this
+     * \param progress  Optional progress callback
+     *
+     * \return True if the end of the file was reached without error
+     */
+    bool ReadAll(std::vector<uint8_t>& buffer, uint64_t size, uint64_t maxSize, const ProgressCallback& progress = ProgressCallback());
+
+    /*!
+     * \brief Stream the remainder of the file without holding it in memory
+     *
+     * \param size      The size of the file, or 0 if unknown
+     * \param callback  Receives the blocks while the next ones are being read
+     *
+     * \return True if the end of the file was reached without error
+     */
+    bool ReadBlocks(uint64_t size, const BlockCallback& callback);
+
+  protected:
+    // implementation of CThread
+    virtual void* Process(void) override;
+
+  private:
+    struct Block
+    {
+      std::vector<uint8_t> data;
+      size_t               size;
+      bool                 bEnd;   // Last block of the file
+      bool                 bError; // Read failed
+    };
+
+    void Stop(void);
+
+    // Construction parameters
+    ADDON::CHelper_libXBMC_addon* const m_xbmc;
+    void* const                         m_file;
+
+    // Set before the worker starts
+    uint64_t m_size;
+
+    // Blocks read by the worker
+    CSpscRing<Block>   m_blocks;
+    P8PLATFORM::CEvent m_dataEvent;  // Signaled when a block was read
+    P8PLATFORM::CEvent m_spaceEvent; // Signaled when a block was released
+  };
+}
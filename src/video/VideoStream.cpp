@@ -25,8 +25,13 @@
 
 using namespace LIBRETRO;
 
+#define VIDEO_QUEUE_SIZE  4 // Frames
+
 CVideoStream::CVideoStream() :
   m_frontend(nullptr),
+  m_bMuted(false),
+  m_bQueued(false),
+  m_queue(VIDEO_QUEUE_SIZE),
   m_bVideoOpen(false),
   m_format(GAME_PIXEL_FORMAT_UNKNOWN),
   m_width(0),
@@ -37,6 +42,7 @@ CVideoStream::CVideoStream() :
 void CVideoStream::Initialize(CHelper_libKODI_game* frontend)
 {
   m_frontend = frontend;
+  m_bMuted = false;
   m_bVideoOpen = false;
   m_format = GAME_PIXEL_FORMAT_UNKNOWN;
   m_width = 0;
@@ -50,9 +56,59 @@ void CVideoStream::Deinitialize()
 
   m_frontend = nullptr;
   m_bVideoOpen = false;
+  m_bQueued = false;
+  m_queue.Clear();
+}
+
+void CVideoStream::SetQueued(bool bQueued)
+{
+  m_bQueued = bQueued;
+  m_queue.Clear();
 }
 
 void CVideoStream::AddFrame(const uint8_t* data, unsigned int size, unsigned int width, unsigned int height, GAME_PIXEL_FORMAT format, GAME_VIDEO_ROTATION rotation)
+{
+  if (m_bMuted)
+    return;
+
+  if (m_bQueued)
+  {
+    VideoFrame* frame = m_queue.BeginWrite();
+    if (frame == nullptr)
+      return; // Frontend is falling behind, drop the frame
+
+    frame->data.assign(data, data + size);
+    frame->width = width;
+    frame->height = height;
+    frame->format = format;
+    frame->rotation = rotation;
+    m_queue.EndWrite();
+  }
+  else
+  {
+    SendFrame(data, size, width, height, format, rotation);
+  }
+}
+
+void CVideoStream::Flush()
+{
+  size_t count = m_queue.Size();
+  if (count == 0)
+    return;
+
+  // Only the newest frame is presented
+  for (; count > 1; count--)
+  {
+    m_queue.BeginRead();
+    m_queue.EndRead();
+  }
+
+  const VideoFrame* frame = m_queue.BeginRead();
+  SendFrame(frame->data.data(), frame->data.size(), frame->width, frame->height, frame->format, frame->rotation);
+  m_queue.EndRead();
+}
+
+void CVideoStream::SendFrame(const uint8_t* data, unsigned int size, unsigned int width, unsigned int height, GAME_PIXEL_FORMAT format, GAME_VIDEO_ROTATION rotation)
 {
   if (m_frontend)
   {
@@ -19,8 +19,13 @@
  */
 #pragma once
 
+#include "utils/SpscRing.h"
+
 #include "kodi_game_types.h"
 
+#include <stdint.h>
+#include <vector>
+
 class CHelper_libKODI_game;
 
 namespace LIBRETRO
@@ -33,11 +38,49 @@ namespace LIBRETRO
     void Initialize(CHelper_libKODI_game* frontend);
     void Deinitialize();
 
+    /*!
+     * \brief Drop frames instead of sending them to the frontend
+     *
+     * Used for frames that are emulated but never presented, e.g. when
+     * running ahead.
+     */
+    void SetMuted(bool bMuted) { m_bMuted = bMuted; }
+    bool IsMuted() const { return m_bMuted; }
+
+    /*!
+     * \brief Queue frames instead of sending them to the frontend
+     *
+     * Used when the core runs on its own thread. Queued frames are sent by
+     * Flush() on the frontend's thread. Must not be called while frames are
+     * being added.
+     */
+    void SetQueued(bool bQueued);
+
     void AddFrame(const uint8_t* data, unsigned int size, unsigned int width, unsigned int height, GAME_PIXEL_FORMAT format, GAME_VIDEO_ROTATION rotation);
 
+    /*!
+     * \brief Send the newest queued frame to the frontend and drop the rest
+     */
+    void Flush();
+
   private:
+    struct VideoFrame
+    {
+      std::vector<uint8_t> data;
+      unsigned int         width;
+      unsigned int         height;
+      GAME_PIXEL_FORMAT    format;
+      GAME_VIDEO_ROTATION  rotation;
+    };
+
+    void SendFrame(const uint8_t* data, unsigned int size, unsigned int width, unsigned int height, GAME_PIXEL_FORMAT format, GAME_VIDEO_ROTATION rotation);
+
     CHelper_libKODI_game* m_frontend;
 
+    bool                  m_bMuted;
+    bool                  m_bQueued;
+    CSpscRing<VideoFrame> m_queue;
+
     bool              m_bVideoOpen;
     GAME_PIXEL_FORMAT m_format;
     unsigned int      m_width;
@@ -0,0 +1,428 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*!
+ * \brief Tests for soft-patching of content
+ *
+ * Each case builds a patch in memory, applies it and checks the result. The
+ * process exits with a non-zero status if any case fails.
+ */
+
+#include "utils/CRC32.h"
+#include "vfs/PatchUtils.h"
+
+#include <algorithm>
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+
+using namespace LIBRETRO;
+
+namespace
+{
+  unsigned int failures = 0;
+
+  void Check(bool bCondition, const char* description)
+  {
+    if (!bCondition)
+    {
+      fprintf(stderr, "FAILED: %s\n", description);
+      failures++;
+    }
+  }
+
+  void AppendIPSRecord(std::vector<uint8_t>& patch, size_t offset, const std::vector<uint8_t>& data)
+  {
+    patch.push_back(static_cast<uint8_t>(offset >> 16));
+    patch.push_back(static_cast<uint8_t>(offset >> 8));
+    patch.push_back(static_cast<uint8_t>(offset));
+    patch.push_back(static_cast<uint8_t>(data.size() >> 8));
+    patch.push_back(static_cast<uint8_t>(data.size()));
+    patch.insert(patch.end(), data.begin(), data.end());
+  }
+
+  std::vector<uint8_t> MakeIPS(size_t offset, const std::vector<uint8_t>& data)
+  {
+    std::vector<uint8_t> patch = { 'P', 'A', 'T', 'C', 'H' };
+    AppendIPSRecord(patch, offset, data);
+    patch.insert(patch.end(), { 'E', 'O', 'F' });
+    return patch;
+  }
+
+  void AppendIPSTruncation(std::vector<uint8_t>& patch, size_t size)
+  {
+    patch.push_back(static_cast<uint8_t>(size >> 16));
+    patch.push_back(static_cast<uint8_t>(size >> 8));
+    patch.push_back(static_cast<uint8_t>(size));
+  }
+
+  uint32_t GetCRC(const std::vector<uint8_t>& data)
+  {
+    return CRC32::Update(0, data.data(), data.size());
+  }
+
+  void AppendLE32(std::vector<uint8_t>& patch, uint32_t value)
+  {
+    for (unsigned int i = 0; i < 4; i++)
+      patch.push_back(static_cast<uint8_t>(value >> (8 * i)));
+  }
+
+  void AppendNumber(std::vector<uint8_t>& patch, uint64_t value)
+  {
+    while (true)
+    {
+      const uint8_t byte = value & 0x7f;
+      value >>= 7;
+      if (value == 0)
+      {
+        patch.push_back(0x80 | byte);
+        break;
+      }
+      patch.push_back(byte);
+      value--;
+    }
+  }
+
+  /*!
+   * \brief Append the CRCs of the source, target and patch
+   */
+  void AppendBeatFooter(std::vector<uint8_t>& patch, uint32_t sourceCRC, uint32_t targetCRC)
+  {
+    AppendLE32(patch, sourceCRC);
+    AppendLE32(patch, targetCRC);
+    AppendLE32(patch, GetCRC(patch));
+  }
+
+  /*!
+   * \brief Build a UPS patch from the differences between two buffers
+   */
+  std::vector<uint8_t> MakeUPS(const std::vector<uint8_t>& source, const std::vector<uint8_t>& target, uint32_t targetCRC)
+  {
+    std::vector<uint8_t> patch = { 'U', 'P', 'S', '1' };
+    AppendNumber(patch, source.size());
+    AppendNumber(patch, target.size());
+
+    const size_t size = std::max(source.size(), target.size());
+    size_t offset = 0;
+    size_t hunkEnd = 0;
+    while (offset < size)
+    {
+      auto xorByte = [&](size_t i) -> uint8_t
+        {
+          return (i < source.size() ? source[i] : 0) ^ (i < target.size() ? target[i] : 0);
+        };
+
+      if (xorByte(offset) == 0)
+      {
+        offset++;
+        continue;
+      }
+
+      AppendNumber(patch, offset - hunkEnd);
+      while (offset < size && xorByte(offset) != 0)
+        patch.push_back(xorByte(offset++));
+      patch.push_back(0);
+      hunkEnd = ++offset;
+    }
+
+    AppendBeatFooter(patch, GetCRC(source), targetCRC);
+    return patch;
+  }
+
+  enum BPS_ACTION
+  {
+    BPS_SOURCE_READ,
+    BPS_TARGET_READ,
+    BPS_SOURCE_COPY,
+    BPS_TARGET_COPY,
+  };
+
+  void AppendBPSAction(std::vector<uint8_t>& patch, BPS_ACTION action, uint64_t length)
+  {
+    AppendNumber(patch, ((length - 1) << 2) | action);
+  }
+
+  void AppendBPSOffset(std::vector<uint8_t>& patch, int64_t delta)
+  {
+    AppendNumber(patch, delta < 0 ? (static_cast<uint64_t>(-delta) << 1) | 1 : static_cast<uint64_t>(delta) << 1);
+  }
+
+  std::vector<uint8_t> MakeBPSHeader(size_t sourceSize, size_t targetSize)
+  {
+    std::vector<uint8_t> patch = { 'B', 'P', 'S', '1' };
+    AppendNumber(patch, sourceSize);
+    AppendNumber(patch, targetSize);
+    AppendNumber(patch, 0); // Metadata
+    return patch;
+  }
+
+  const std::vector<uint8_t> BPS_SOURCE = { '0', '1', '2', '3', '4', '5', '6', '7', '8', '9' };
+
+  /*!
+   * \brief "0123ABABABAB89", with a target copy that overlaps its output
+   */
+  std::vector<uint8_t> MakeBPS(const std::vector<uint8_t>& target, uint32_t sourceCRC, uint32_t targetCRC)
+  {
+    std::vector<uint8_t> patch = MakeBPSHeader(BPS_SOURCE.size(), target.size());
+    AppendBPSAction(patch, BPS_SOURCE_READ, 4);
+    AppendBPSAction(patch, BPS_TARGET_READ, 2);
+    patch.insert(patch.end(), { 'A', 'B' });
+    AppendBPSAction(patch, BPS_TARGET_COPY, 6);
+    AppendBPSOffset(patch, 4);
+    AppendBPSAction(patch, BPS_SOURCE_COPY, 2);
+    AppendBPSOffset(patch, 8);
+    AppendBeatFooter(patch, sourceCRC, targetCRC);
+    return patch;
+  }
+
+  const std::vector<uint8_t> BPS_TARGET = { '0', '1', '2', '3', 'A', 'B', 'A', 'B', 'A', 'B', 'A', 'B', '8', '9' };
+
+  void TestIPSRecord(void)
+  {
+    std::vector<uint8_t> content(100, 0x11);
+    const std::vector<uint8_t> patch = MakeIPS(10, std::vector<uint8_t>(4, 0xaa));
+
+    Check(PatchUtils::GetFormat(patch.data(), patch.size()) == PATCH_FORMAT_IPS, "IPS: format is detected");
+    Check(PatchUtils::Apply(patch.data(), patch.size(), 1024, content), "IPS: record applies");
+    Check(content.size() == 100, "IPS: size is unchanged");
+    Check(content[9] == 0x11 && content[10] == 0xaa && content[13] == 0xaa && content[14] == 0x11, "IPS: record is written");
+  }
+
+  void TestIPSGrow(void)
+  {
+    std::vector<uint8_t> content(100, 0x11);
+    const std::vector<uint8_t> patch = MakeIPS(0x100, std::vector<uint8_t>(16, 0xaa));
+
+    Check(PatchUtils::Apply(patch.data(), patch.size(), 1024, content), "IPS grow: record applies");
+    Check(content.size() == 0x110, "IPS grow: content grows to the end of the record");
+    Check(content[0x10f] == 0xaa, "IPS grow: record is written");
+  }
+
+  void TestIPSTruncateBelowRecord(void)
+  {
+    // A record past the truncation size is written before the content is cut
+    std::vector<uint8_t> content(100, 0x11);
+    std::vector<uint8_t> patch = MakeIPS(0x100, std::vector<uint8_t>(16, 0xaa));
+    AppendIPSTruncation(patch, 0x32);
+
+    Check(PatchUtils::Apply(patch.data(), patch.size(), 1024, content), "IPS truncate: patch applies");
+    Check(content.size() == 0x32, "IPS truncate: content is truncated");
+    Check(content[0x31] == 0x11, "IPS truncate: content before the truncation is kept");
+  }
+
+  void TestIPSMemoryLimit(void)
+  {
+    std::vector<uint8_t> content(100, 0x11);
+    std::vector<uint8_t> patch = MakeIPS(0x100, std::vector<uint8_t>(16, 0xaa));
+    AppendIPSTruncation(patch, 0x32);
+
+    Check(!PatchUtils::Apply(patch.data(), patch.size(), 0x80, content), "IPS limit: records past the limit are rejected");
+    Check(content.size() == 100 && content[0] == 0x11, "IPS limit: content is untouched");
+  }
+
+  void TestIPSTruncatedPatch(void)
+  {
+    std::vector<uint8_t> content(100, 0x11);
+    std::vector<uint8_t> patch = MakeIPS(10, std::vector<uint8_t>(4, 0xaa));
+    patch.resize(patch.size() - 5);
+
+    Check(!PatchUtils::Apply(patch.data(), patch.size(), 1024, content), "IPS malformed: truncated patch is rejected");
+    Check(content[10] == 0x11, "IPS malformed: content is untouched");
+  }
+
+  void TestIPSInPlace(void)
+  {
+    std::vector<uint8_t> buffer(100, 0x11);
+    std::vector<uint8_t> patch = MakeIPS(10, std::vector<uint8_t>(4, 0xaa));
+    AppendIPSTruncation(patch, 0x32);
+
+    size_t size = buffer.size();
+    Check(PatchUtils::GetRequiredSize(patch.data(), patch.size(), size) == 100, "IPS in place: fits the content");
+    Check(PatchUtils::Apply(patch.data(), patch.size(), buffer.data(), size), "IPS in place: patch applies");
+    Check(size == 0x32, "IPS in place: content is truncated");
+    Check(buffer[10] == 0xaa && buffer[14] == 0x11, "IPS in place: record is written");
+  }
+
+  void TestIPSInPlaceGrow(void)
+  {
+    std::vector<uint8_t> buffer(100, 0x11);
+    const std::vector<uint8_t> patch = MakeIPS(0x100, std::vector<uint8_t>(16, 0xaa));
+
+    size_t size = buffer.size();
+    Check(PatchUtils::GetRequiredSize(patch.data(), patch.size(), size) == 0x110, "IPS in place grow: room is reported");
+    Check(!PatchUtils::Apply(patch.data(), patch.size(), buffer.data(), size), "IPS in place grow: patch is rejected");
+    Check(size == 100 && buffer[0] == 0x11, "IPS in place grow: content is untouched");
+  }
+
+  void TestUPS(void)
+  {
+    const std::vector<uint8_t> source = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    const std::vector<uint8_t> target = { 1, 9, 9, 4, 5, 6, 7, 8, 0, 0, 7 };
+    const std::vector<uint8_t> patch = MakeUPS(source, target, GetCRC(target));
+
+    std::vector<uint8_t> content = source;
+    Check(PatchUtils::GetFormat(patch.data(), patch.size()) == PATCH_FORMAT_UPS, "UPS: format is detected");
+    Check(PatchUtils::Apply(patch.data(), patch.size(), 1024, content), "UPS: patch applies");
+    Check(content == target, "UPS: content grows to the target");
+  }
+
+  void TestUPSShrinkInPlace(void)
+  {
+    const std::vector<uint8_t> source = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    const std::vector<uint8_t> target = { 1, 2, 9, 4, 5 };
+    const std::vector<uint8_t> patch = MakeUPS(source, target, GetCRC(target));
+
+    std::vector<uint8_t> buffer = source;
+    size_t size = buffer.size();
+    Check(PatchUtils::GetRequiredSize(patch.data(), patch.size(), size) == source.size(), "UPS in place: fits the content");
+    Check(PatchUtils::Apply(patch.data(), patch.size(), buffer.data(), size), "UPS in place: patch applies");
+    Check(size == target.size() && std::equal(target.begin(), target.end(), buffer.begin()), "UPS in place: content is patched");
+  }
+
+  void TestUPSTargetCRC(void)
+  {
+    // The hunks are applied before the target CRC is known to be wrong
+    const std::vector<uint8_t> source = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    const std::vector<uint8_t> target = { 1, 9, 9, 4, 5, 6, 7, 8, 0, 0, 7 };
+    const std::vector<uint8_t> patch = MakeUPS(source, target, GetCRC(target) ^ 1);
+
+    std::vector<uint8_t> content = source;
+    Check(!PatchUtils::Apply(patch.data(), patch.size(), 1024, content), "UPS target CRC: patch is rejected");
+    Check(content == source, "UPS target CRC: hunks are rolled back");
+  }
+
+  void TestUPSSourceCRC(void)
+  {
+    const std::vector<uint8_t> source = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    const std::vector<uint8_t> target = { 1, 9, 9, 4, 5, 6, 7, 8 };
+    const std::vector<uint8_t> patch = MakeUPS(source, target, GetCRC(target));
+
+    const std::vector<uint8_t> other = { 8, 7, 6, 5, 4, 3, 2, 1 };
+    std::vector<uint8_t> content = other;
+    Check(!PatchUtils::Apply(patch.data(), patch.size(), 1024, content), "UPS source CRC: other content is rejected");
+    Check(content == other, "UPS source CRC: content is untouched");
+  }
+
+  void TestNumberOverflow(void)
+  {
+    // Continuation bytes without an end would overflow 64 bits
+    std::vector<uint8_t> patch = { 'U', 'P', 'S', '1' };
+    patch.insert(patch.end(), 12, 0x7f);
+    patch.push_back(0x80);
+    AppendNumber(patch, 8);
+    AppendBeatFooter(patch, 0, 0);
+
+    std::vector<uint8_t> content(8, 0x11);
+    Check(PatchUtils::GetRequiredSize(patch.data(), patch.size(), content.size()) == 0, "Number overflow: patch is malformed");
+    Check(!PatchUtils::Apply(patch.data(), patch.size(), 1024, content), "Number overflow: patch is rejected");
+    Check(content.size() == 8 && content[0] == 0x11, "Number overflow: content is untouched");
+  }
+
+  void TestBPS(void)
+  {
+    const std::vector<uint8_t> patch = MakeBPS(BPS_TARGET, GetCRC(BPS_SOURCE), GetCRC(BPS_TARGET));
+
+    std::vector<uint8_t> content = BPS_SOURCE;
+    Check(PatchUtils::GetFormat(patch.data(), patch.size()) == PATCH_FORMAT_BPS, "BPS: format is detected");
+    Check(PatchUtils::Apply(patch.data(), patch.size(), 1024, content), "BPS: patch applies");
+    Check(content == BPS_TARGET, "BPS: overlapping target copy repeats the pattern");
+  }
+
+  void TestBPSShrinkInPlace(void)
+  {
+    const std::vector<uint8_t> target = { '6', '7', '8', '9' };
+
+    std::vector<uint8_t> patch = MakeBPSHeader(BPS_SOURCE.size(), target.size());
+    AppendBPSAction(patch, BPS_SOURCE_COPY, 4);
+    AppendBPSOffset(patch, 6);
+    AppendBeatFooter(patch, GetCRC(BPS_SOURCE), GetCRC(target));
+
+    std::vector<uint8_t> buffer = BPS_SOURCE;
+    size_t size = buffer.size();
+    Check(PatchUtils::GetRequiredSize(patch.data(), patch.size(), size) == BPS_SOURCE.size(), "BPS in place: fits the content");
+    Check(PatchUtils::Apply(patch.data(), patch.size(), buffer.data(), size), "BPS in place: patch applies");
+    Check(size == target.size() && std::equal(target.begin(), target.end(), buffer.begin()), "BPS in place: content is patched");
+  }
+
+  void TestBPSSourceCRC(void)
+  {
+    const std::vector<uint8_t> patch = MakeBPS(BPS_TARGET, GetCRC(BPS_SOURCE) ^ 1, GetCRC(BPS_TARGET));
+
+    std::vector<uint8_t> content = BPS_SOURCE;
+    Check(!PatchUtils::Apply(patch.data(), patch.size(), 1024, content), "BPS source CRC: patch is rejected");
+    Check(content == BPS_SOURCE, "BPS source CRC: content is untouched");
+  }
+
+  void TestBPSTargetCRC(void)
+  {
+    const std::vector<uint8_t> patch = MakeBPS(BPS_TARGET, GetCRC(BPS_SOURCE), GetCRC(BPS_TARGET) ^ 1);
+
+    std::vector<uint8_t> content = BPS_SOURCE;
+    Check(!PatchUtils::Apply(patch.data(), patch.size(), 1024, content), "BPS target CRC: patch is rejected");
+    Check(content == BPS_SOURCE, "BPS target CRC: content is untouched");
+  }
+
+  void TestBPSTargetCopyPastOutput(void)
+  {
+    // A target copy can only read bytes that have already been written
+    const std::vector<uint8_t> target(4, 'A');
+
+    std::vector<uint8_t> patch = MakeBPSHeader(BPS_SOURCE.size(), target.size());
+    AppendBPSAction(patch, BPS_TARGET_READ, 1);
+    patch.push_back('A');
+    AppendBPSAction(patch, BPS_TARGET_COPY, 3);
+    AppendBPSOffset(patch, 1);
+    AppendBeatFooter(patch, GetCRC(BPS_SOURCE), GetCRC(target));
+
+    std::vector<uint8_t> content = BPS_SOURCE;
+    Check(!PatchUtils::Apply(patch.data(), patch.size(), 1024, content), "BPS target copy: unwritten offset is rejected");
+    Check(content == BPS_SOURCE, "BPS target copy: content is untouched");
+  }
+}
+
+int main(void)
+{
+  TestIPSRecord();
+  TestIPSGrow();
+  TestIPSTruncateBelowRecord();
+  TestIPSMemoryLimit();
+  TestIPSTruncatedPatch();
+  TestIPSInPlace();
+  TestIPSInPlaceGrow();
+  TestUPS();
+  TestUPSShrinkInPlace();
+  TestUPSTargetCRC();
+  TestUPSSourceCRC();
+  TestNumberOverflow();
+  TestBPS();
+  TestBPSShrinkInPlace();
+  TestBPSSourceCRC();
+  TestBPSTargetCRC();
+  TestBPSTargetCopyPastOutput();
+
+  if (failures > 0)
+  {
+    fprintf(stderr, "%u check(s) failed\n", failures);
+    return 1;
+  }
+
+  printf("All checks passed\n");
+  return 0;
+}